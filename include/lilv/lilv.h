@@ -69,15 +69,18 @@ struct LilvInstanceImpl;
    @{
 */
 
-typedef struct LilvPluginImpl      LilvPlugin;      /**< LV2 Plugin. */
-typedef struct LilvPluginClassImpl LilvPluginClass; /**< Plugin Class. */
-typedef struct LilvPortImpl        LilvPort;        /**< Port. */
-typedef struct LilvScalePointImpl  LilvScalePoint;  /**< Scale Point. */
-typedef struct LilvUIImpl          LilvUI;          /**< Plugin UI. */
-typedef struct LilvNodeImpl        LilvNode;        /**< Typed Value. */
-typedef struct LilvWorldImpl       LilvWorld;       /**< Lilv World. */
-typedef struct LilvInstanceImpl    LilvInstance;    /**< Plugin instance. */
-typedef struct LilvStateImpl       LilvState;       /**< Plugin state. */
+typedef struct LilvPluginImpl        LilvPlugin;        /**< LV2 Plugin. */
+typedef struct LilvPluginClassImpl   LilvPluginClass;   /**< Plugin Class. */
+typedef struct LilvPortImpl          LilvPort;          /**< Port. */
+typedef struct LilvScalePointImpl    LilvScalePoint;    /**< Scale Point. */
+typedef struct LilvUIImpl            LilvUI;            /**< Plugin UI. */
+typedef struct LilvNodeImpl          LilvNode;          /**< Typed Value. */
+typedef struct LilvWorldImpl         LilvWorld;         /**< Lilv World. */
+typedef struct LilvInstanceImpl      LilvInstance;      /**< Plugin instance. */
+typedef struct LilvStateImpl         LilvState;         /**< Plugin state. */
+typedef struct LilvWatcherImpl       LilvWatcher;       /**< Bundle watcher. */
+typedef struct LilvQueryImpl         LilvQuery;         /**< Graph query. */
+typedef struct LilvPreparedQueryImpl LilvPreparedQuery; /**< Prepared query. */
 
 typedef void LilvIter;          /**< Collection iterator */
 typedef void LilvPluginClasses; /**< A set of #LilvPluginClass. */
@@ -355,8 +358,7 @@ lilv_node_as_bool(const LilvNode* value);
    @defgroup lilv_collections Collections
 
    Lilv has several collection types for holding various types of value.
-   Each collection type supports a similar basic API, except #LilvPlugins which
-   is internal and thus lacks a free function:
+   Each collection type supports a similar basic API:
 
    - void PREFIX_free (coll)
    - unsigned PREFIX_size (coll)
@@ -370,6 +372,10 @@ lilv_node_as_bool(const LilvNode* value);
    - LilvNodes, with function prefix `lilv_nodes_`.
    - LilvUIs, with function prefix `lilv_uis_`.
 
+   Iterators are invalidated when their collection changes, which for
+   collections owned by the world may happen when bundles are loaded or
+   unloaded.
+
    @{
 */
 
@@ -539,6 +545,16 @@ lilv_nodes_merge(const LilvNodes* a, const LilvNodes* b);
 
 /* Plugins */
 
+/**
+   Free a collection of plugins.
+
+   This is only for collections returned by lilv_plugin_class_get_plugins(),
+   the collection from lilv_world_get_all_plugins() is owned by the world.
+*/
+LILV_API
+void
+lilv_plugins_free(LilvPlugins* collection);
+
 LILV_API
 unsigned
 lilv_plugins_size(const LilvPlugins* collection);
@@ -580,6 +596,15 @@ lilv_plugins_get_by_uri(const LilvPlugins* plugins, const LilvNode* uri);
    Normal hosts which just need to load plugins by URI should simply use
    lilv_world_load_all() to discover/load the system's LV2 resources.
 
+   A world, and everything that came from it, may be used by several threads
+   at once.  Calls are serialized by a lock in the world, and callbacks are
+   called with it held, so they must not wait for other threads that use the
+   world.  Const objects returned by the world, like plugins and the nodes
+   they own, are only valid until the world is changed by another thread, so
+   hosts that query from several threads should call lilv_world_freeze() once
+   everything is loaded, and enable #LILV_OPTION_COMPACT first to avoid
+   serializing queries.
+
    @{
 */
 
@@ -618,6 +643,74 @@ lilv_world_new(void);
 */
 #define LILV_OPTION_LV2_PATH "http://drobilla.net/ns/lilv#lv2-path"
 
+/**
+   Set the number of threads used to parse manifests during discovery.
+
+   If this is an integer greater than 1, then lilv_world_load_all() parses the
+   manifests of the bundles in each directory in parallel, using up to this
+   many threads including the calling thread.  The loaded world is the same
+   as with serial loading.  Discovery is serial by default.
+*/
+#define LILV_OPTION_DISCOVERY_THREADS \
+  "http://drobilla.net/ns/lilv#discovery-threads"
+
+/**
+   Set the path of a persistent discovery cache file.
+
+   If set, the contents of bundle manifests are stored in this file after they
+   are parsed, and replayed from it by lilv_world_load_bundle() instead of
+   parsing the manifest again.  An entry is only used if the manifest and any
+   local files it refers to with rdfs:seeAlso have the same modification time
+   and size as when it was stored, otherwise the manifest is parsed as usual.
+
+   The cache is written by lilv_world_load_all() and lilv_world_free(), and is
+   disabled by default.
+*/
+#define LILV_OPTION_CACHE_PATH "http://drobilla.net/ns/lilv#cache-path"
+
+/**
+   Enable/disable lazy loading of specification data.
+
+   If this option is true, lilv_world_load_all() does not parse the data files
+   of every specification up front.  Instead, the data of a specification is
+   loaded the first time lilv_world_find_nodes(), lilv_world_get(), or
+   lilv_world_ask() is called with a subject or object URI within it, and
+   plugin classes are loaded when they are first accessed.  This can make
+   loading much faster, and the model much smaller, for hosts that rarely
+   query specification data.  Lazy loading is disabled by default.
+*/
+#define LILV_OPTION_LAZY_SPECS "http://drobilla.net/ns/lilv#lazy-specs"
+
+/**
+   Enable/disable caching of query results.
+
+   If this option is true, the results of lilv_world_find_nodes(),
+   lilv_world_get(), and lilv_world_ask() are remembered by their (subject,
+   predicate, object) pattern, so repeating a query returns a copy of the
+   previous result without searching the model.  All remembered results are
+   dropped whenever data is loaded or unloaded, or the language changes.  The
+   cache is disabled by default, see lilv_world_get_query_cache_stats().
+
+   The value may also be an integer, which is the maximum number of results to
+   remember, where true means 4096 and zero disables the cache.  When the cache
+   is full, all remembered results are dropped before another is added, so
+   memory use stays bounded for hosts that query many different subjects.
+*/
+#define LILV_OPTION_QUERY_CACHE "http://drobilla.net/ns/lilv#query-cache"
+
+/**
+   Enable/disable compacting the world when it is frozen.
+
+   If this option is true, lilv_world_freeze() replaces the loaded data with a
+   compact read-only copy, where statements are stored as rows of node IDs in
+   sorted arrays.  This uses much less memory than the mutable model, and makes
+   queries faster, but plugin descriptions written by
+   lilv_plugin_write_description() will label blank nodes rather than writing
+   them inline.  Compaction is disabled by default, and setting this option
+   after the world is frozen has no effect.
+*/
+#define LILV_OPTION_COMPACT "http://drobilla.net/ns/lilv#compact"
+
 /**
    Set an option for `world`.
 
@@ -626,6 +719,11 @@ lilv_world_new(void);
    - #LILV_OPTION_FILTER_LANG
    - #LILV_OPTION_DYN_MANIFEST
    - #LILV_OPTION_LV2_PATH
+   - #LILV_OPTION_DISCOVERY_THREADS
+   - #LILV_OPTION_CACHE_PATH
+   - #LILV_OPTION_LAZY_SPECS
+   - #LILV_OPTION_QUERY_CACHE
+   - #LILV_OPTION_COMPACT
 */
 LILV_API
 void
@@ -709,6 +807,42 @@ LILV_API
 int
 lilv_world_unload_bundle(LilvWorld* world, const LilvNode* bundle_uri);
 
+/**
+   Update the world to reflect bundles that have changed on disk.
+
+   This finds bundles in the same directories as lilv_world_load_all(), and
+   compares them with the bundles that have been loaded.  New bundles are
+   loaded, bundles whose directory has disappeared are unloaded, and bundles
+   where the directory, manifest, or any data file or binary listed in the
+   manifest has changed since it was loaded are unloaded and loaded again.
+   Everything else is left untouched, so the cost depends on the size of the
+   change rather than the number of installed bundles.
+
+   Plugins from unchanged bundles remain valid, as do plugins from changed or
+   removed bundles, although the latter will no longer be in the list returned
+   by lilv_world_get_all_plugins().
+
+   @param world The world.
+
+   @param added If not null, set to the URIs of newly loaded bundles, or null
+   if there are none.
+
+   @param removed If not null, set to the URIs of unloaded bundles, or null if
+   there are none.
+
+   @param changed If not null, set to the URIs of reloaded bundles, or null if
+   there are none.
+
+   @return The number of bundles that were added, removed, or changed.  Any
+   returned collections must be freed by the caller with lilv_nodes_free().
+*/
+LILV_API
+int
+lilv_world_rescan(LilvWorld*  world,
+                  LilvNodes** added,
+                  LilvNodes** removed,
+                  LilvNodes** changed);
+
 /**
    Load all the data associated with the given `resource`.
 
@@ -736,6 +870,64 @@ LILV_API
 int
 lilv_world_unload_resource(LilvWorld* world, const LilvNode* resource);
 
+/**
+   Load everything that is otherwise loaded on demand, and prevent changes.
+
+   This loads the data of every plugin, and everything else that queries would
+   load lazily, so queries no longer change what is loaded.  Afterwards, any
+   function that would change what is loaded, like lilv_world_load_bundle(),
+   lilv_world_rescan(), or lilv_world_unload_resource(), fails with an error
+   instead.  Objects returned by the world then remain valid until it is freed,
+   so it can safely be queried from several threads at once.
+
+   If #LILV_OPTION_COMPACT is enabled, then the data is also compacted, and
+   since it can no longer change, calls no longer take the world lock and can
+   run in parallel.  Only making and freeing nodes is briefly serialized.
+   Otherwise, calls on a frozen world are still serialized by the lock.
+
+   This must not be called while any other thread is using the world, since
+   it changes whether calls take the lock.  Threads that query the world in
+   parallel must be started after this returns.  If another thread is in a call
+   that holds the world lock, then an error is logged and the world is left
+   unchanged.
+*/
+LILV_API
+void
+lilv_world_freeze(LilvWorld* world);
+
+/**
+   Save an image of everything loaded in a world to a file.
+
+   Any plugin data that would otherwise be loaded on demand is loaded first,
+   but the world is not frozen, and can still be changed afterwards.  The image
+   contains every statement, plugin, and plugin class in a compact binary form,
+   which lilv_world_new_from_image() can use in place without parsing any data.
+   An image only depends on the installed bundles that were loaded, but is not
+   updated when they change, and can only be read by the same version of lilv
+   on a machine with the same byte order.  The file is replaced atomically, so
+   processes that are using a previous image are not affected.
+
+   @return Zero on success, or non-zero on error.
+*/
+LILV_API
+int
+lilv_world_save_image(LilvWorld* world, const char* path);
+
+/**
+   Create a new world from an image written by lilv_world_save_image().
+
+   Where possible, the image is mapped into memory read-only, so starting is
+   fast, and every process that uses the same image shares most of its memory.
+   The new world is frozen and compact (see #LILV_OPTION_COMPACT), and
+   otherwise works like the world the image was saved from.  The image file
+   must not be modified in place while it is in use.
+
+   @return A new world, or NULL if the image could not be read or is invalid.
+*/
+LILV_API
+LilvWorld*
+lilv_world_new_from_image(const char* path);
+
 /**
    Get the parent of all other plugin classes, lv2:Plugin.
 */
@@ -768,6 +960,22 @@ LILV_API
 const LilvPlugins*
 lilv_world_get_all_plugins(const LilvWorld* world);
 
+/**
+   Return the URI of the plugin that replaces another.
+
+   A plugin is replaced if a known plugin is described with `dc:replaces
+   <plugin_uri>` in its manifest.  The replaced plugin itself need not be
+   installed, so this can be used to migrate sessions that refer to plugins
+   which have since been removed.  The returned plugin may itself be replaced.
+
+   @return The URI of the replacing plugin, or NULL if `plugin_uri` is not
+   replaced by any known plugin.  The returned value is owned by `world` and
+   must not be freed by the caller.
+*/
+LILV_API
+const LilvNode*
+lilv_world_get_replacement(const LilvWorld* world, const LilvNode* plugin_uri);
+
 /**
    Find nodes matching a triple pattern.
 
@@ -782,6 +990,41 @@ lilv_world_find_nodes(LilvWorld*      world,
                       const LilvNode* predicate,
                       const LilvNode* object);
 
+/**
+   Function called for each statement that matches a pattern.
+
+   The nodes are borrowed and only valid during the call, so they must not be
+   freed, but may be kept with lilv_node_duplicate().
+
+   @return Zero to continue, or non-zero to stop.
+*/
+typedef int (*LilvMatchFunc)(void*           data,
+                             const LilvNode* subject,
+                             const LilvNode* predicate,
+                             const LilvNode* object);
+
+/**
+   Call a function for every statement matching a triple pattern.
+
+   This is a streaming alternative to lilv_world_find_nodes() that does not
+   build a collection, and does not allocate nodes that are not already in
+   use.  Any of `subject`, `predicate`, and `object` may be NULL (a wildcard).
+
+   If #LILV_OPTION_FILTER_LANG is enabled and only `object` is a wildcard,
+   then only objects in the best language are visited, like with
+   lilv_world_find_nodes().
+
+   @return The number of times `func` was called.
+*/
+LILV_API
+unsigned
+lilv_world_foreach_match(LilvWorld*      world,
+                         const LilvNode* subject,
+                         const LilvNode* predicate,
+                         const LilvNode* object,
+                         LilvMatchFunc   func,
+                         void*           data);
+
 /**
    Find a single node that matches a pattern.
 
@@ -817,6 +1060,23 @@ lilv_world_ask(LilvWorld*      world,
                const LilvNode* predicate,
                const LilvNode* object);
 
+/**
+   Get statistics about the query cache.
+
+   This counts the queries answered from the cache, and those that had to
+   search the model, since the world was created.  Both are zero unless
+   #LILV_OPTION_QUERY_CACHE is enabled.
+
+   @param world The world.
+   @param[out] hits Set to the number of queries answered from the cache.
+   @param[out] misses Set to the number of queries that searched the model.
+*/
+LILV_API
+void
+lilv_world_get_query_cache_stats(const LilvWorld* world,
+                                 uint64_t*        hits,
+                                 uint64_t*        misses);
+
 /**
    Get an LV2 symbol for some subject.
 
@@ -829,6 +1089,266 @@ LILV_API
 LilvNode*
 lilv_world_get_symbol(LilvWorld* world, const LilvNode* subject);
 
+/**
+   @}
+   @defgroup lilv_query Queries
+
+   A query is a set of statement patterns that share variables, like a basic
+   graph pattern in SPARQL.  Every combination of variable values that matches
+   all patterns at once is a result.  This can answer questions like "the
+   symbol of every latency port of every plugin" with a single query, instead
+   of nested loops of calls like lilv_world_find_nodes().
+
+   A query matches all data currently loaded in the world.  The data of a
+   plugin is only loaded when a plugin function first needs it, so until then
+   it is invisible to queries, unless the world has been frozen with
+   lilv_world_freeze(), or the data was loaded by calling a function like
+   lilv_plugin_get_name() first.
+
+   Running a query is safe while other threads use the world, since it locks
+   the world like other functions (see lilv_world_freeze() for when it does
+   not need to).  The `sink` is called with the lock held, so it must not wait
+   for other threads that use the world.  A query object itself, like a
+   #LilvPreparedQuery which holds the values of its last run, must only be used
+   by one thread at a time.
+
+   @{
+*/
+
+/**
+   The maximum number of variables in a query.
+*/
+#define LILV_MAX_QUERY_VARIABLES 256U
+
+/**
+   A term in a query pattern.
+
+   A term is either a node that must match exactly, or, if `node` is null, the
+   variable with index `var`.  Variables are numbered from zero, and the index
+   must be less than #LILV_MAX_QUERY_VARIABLES.
+*/
+typedef struct {
+  const LilvNode* node; ///< Node to match, or null for a variable
+  uint32_t        var;  ///< Index of variable if `node` is null
+} LilvQueryTerm;
+
+/**
+   Function called for every result of a query.
+
+   @param handle The handle passed to lilv_query_run().
+   @param row The value of every variable in order, where unused variables are
+   null.  The row and the nodes in it are borrowed and only valid during the
+   call, so they must not be freed, but may be kept with lilv_node_duplicate().
+   @return Zero to continue, or non-zero to stop the query.
+*/
+typedef int (*LilvQuerySink)(void* handle, const LilvNode* const* row);
+
+/**
+   Create a new empty query.
+
+   The query must be freed before the world.
+*/
+LILV_API
+LilvQuery*
+lilv_query_new(LilvWorld* world);
+
+/**
+   Free a query.
+*/
+LILV_API
+void
+lilv_query_free(LilvQuery* query);
+
+/**
+   Add a statement pattern to a query.
+
+   The nodes in the terms are copied, so they do not need to outlive the call.
+
+   @return Zero on success, or non-zero if a term is invalid, for example a
+   predicate that is neither a URI nor a variable, or a variable with an index
+   that is not less than #LILV_MAX_QUERY_VARIABLES.
+*/
+LILV_API
+int
+lilv_query_add_pattern(LilvQuery*    query,
+                       LilvQueryTerm subject,
+                       LilvQueryTerm predicate,
+                       LilvQueryTerm object);
+
+/**
+   Return the number of variables in a query, which is the length of a row.
+
+   This is one more than the highest variable index in any pattern.
+*/
+LILV_API
+uint32_t
+lilv_query_get_n_variables(const LilvQuery* query);
+
+/**
+   Run a query and call `sink` for every result.
+
+   Patterns are matched in an order chosen to use the indices of the model,
+   with patterns that have a known subject or object first, so the order they
+   were added in does not matter.  A statement that is in several graphs
+   matches once for each.
+
+   @return The number of results passed to `sink`.
+*/
+LILV_API
+unsigned
+lilv_query_run(LilvQuery* query, LilvQuerySink sink, void* handle);
+
+/**
+   Prepare a query for a property of many subjects.
+
+   This is like lilv_world_find_nodes() with a subject, but the predicate and
+   object are checked and resolved once, so running the query for each subject
+   does much less work.  This is useful for repeatedly querying the same
+   property of many ports or plugins, for example.
+
+   @param world The world.
+   @param predicate The property to query, which must be a URI.
+   @param object The value to match, or NULL to get every value.
+   @return A new prepared query, or NULL on error.
+*/
+LILV_API
+LilvPreparedQuery*
+lilv_prepared_query_new(LilvWorld*      world,
+                        const LilvNode* predicate,
+                        const LilvNode* object);
+
+/**
+   Free a prepared query.
+*/
+LILV_API
+void
+lilv_prepared_query_free(LilvPreparedQuery* query);
+
+/**
+   Run a prepared query for a subject.
+
+   If the query has no object, then the values of the property are written to
+   `values`, filtered by language like lilv_world_find_nodes().  The values are
+   borrowed from the query, like the nodes passed to a #LilvMatchFunc, and are
+   only valid until the query is run again or freed, or the world is changed.
+   They may be kept with lilv_node_duplicate().  Nothing is allocated, except
+   the first time the query is run with a larger `n_values`.  If the query has
+   an object, then nothing is written to `values`, and the result is only
+   whether the statement exists.
+
+   @param query The prepared query.
+   @param subject The subject to query, which must not be NULL.
+   @param values Array to store up to `n_values` values in.
+   @param n_values The number of elements in `values`.
+   @return The number of matching values, which may be greater than
+   `n_values`, in which case only the first `n_values` are written.  If the
+   query has an object, then 1 if the statement exists, and 0 otherwise.  If
+   `subject` is NULL, then 0.
+*/
+LILV_API
+uint32_t
+lilv_prepared_query_run(LilvPreparedQuery* query,
+                        const LilvNode*    subject,
+                        const LilvNode**   values,
+                        uint32_t           n_values);
+
+/**
+   @}
+   @defgroup lilv_watcher Bundle Watcher
+
+   A watcher notices bundles that are added to, removed from, or changed in
+   the LV2 path, so a host can update the world without polling.  This is only
+   supported on Linux, using inotify.
+
+   The watcher only reports changes, which the host applies with
+   lilv_world_load_bundle() and lilv_world_unload_bundle().  A watcher only
+   reads the world while holding its lock, so other threads may use the world
+   at the same time, but the watcher itself must only be used by one thread at
+   a time.
+
+   @{
+*/
+
+/** A change to a bundle reported by a #LilvWatcher. */
+typedef enum {
+  LILV_BUNDLE_ADDED,   ///< New bundle that is not loaded
+  LILV_BUNDLE_REMOVED, ///< Loaded bundle that no longer exists
+  LILV_BUNDLE_CHANGED, ///< Loaded bundle that has been modified
+} LilvBundleChange;
+
+/**
+   Create a new watcher for bundles in the LV2 path.
+
+   This watches every directory in the same LV2 path used by
+   lilv_world_load_all(), and the bundles within them, including any
+   directories inside bundles.  Directories in the LV2 path that do not exist
+   yet, like a new user directory, are watched once they are created, and any
+   bundles already inside them are reported as added.
+
+   Events are only reported once a bundle has been quiet for `debounce_ms`
+   milliseconds, so the many writes made while installing a bundle result in
+   a single event.
+
+   The watcher must be freed before the world.
+
+   @return A new watcher, or null if watching is not supported.
+*/
+LILV_API
+LilvWatcher*
+lilv_watcher_new(LilvWorld* world, unsigned debounce_ms);
+
+/**
+   Free a watcher.
+*/
+LILV_API
+void
+lilv_watcher_free(LilvWatcher* watcher);
+
+/**
+   Return a file descriptor that becomes readable when a change is noticed.
+
+   This can be polled in the host's event loop, with the timeout from
+   lilv_watcher_get_timeout().  When either expires,
+   lilv_watcher_process() should be called.
+*/
+LILV_API
+int
+lilv_watcher_get_fd(const LilvWatcher* watcher);
+
+/**
+   Return the number of milliseconds until lilv_watcher_process() should be
+   called to report settled bundles, or -1 if there are none.
+*/
+LILV_API
+int
+lilv_watcher_get_timeout(const LilvWatcher* watcher);
+
+/**
+   Process notifications and queue events for bundles that have settled.
+
+   This never blocks.
+
+   @return The number of queued events.
+*/
+LILV_API
+unsigned
+lilv_watcher_process(LilvWatcher* watcher);
+
+/**
+   Take the next queued event.
+
+   @param watcher The watcher.
+   @param change Set to the kind of change.
+   @param bundle_uri Set to the URI of the bundle, which must be freed by the
+   caller with lilv_node_free().
+   @return True if an event was returned, false if the queue is empty.
+*/
+LILV_API
+bool
+lilv_watcher_next_event(LilvWatcher*      watcher,
+                        LilvBundleChange* change,
+                        LilvNode**        bundle_uri);
+
 /**
    @}
    @defgroup lilv_plugin Plugins
@@ -953,6 +1473,21 @@ LILV_API
 LilvNodes*
 lilv_plugin_get_value(const LilvPlugin* plugin, const LilvNode* predicate);
 
+/**
+   Call a function for every value of a plugin property.
+
+   This is a streaming alternative to lilv_plugin_get_value(), see
+   lilv_world_foreach_match().
+
+   @return The number of times `func` was called.
+*/
+LILV_API
+unsigned
+lilv_plugin_foreach_value(const LilvPlugin* plugin,
+                          const LilvNode*   predicate,
+                          LilvMatchFunc     func,
+                          void*             data);
+
 /**
    Return whether a feature is supported by a plugin.
 
@@ -1045,7 +1580,8 @@ lilv_plugin_get_num_ports(const LilvPlugin* plugin);
 
    This is a convenience method for the common case of getting the range of
    all float ports on a plugin, and may be significantly faster than
-   repeated calls to lilv_port_get_range().
+   repeated calls to lilv_port_get_range().  See lilv_plugin_get_port_ranges()
+   for a more complete variant.
 */
 LILV_API
 void
@@ -1112,14 +1648,111 @@ lilv_plugin_get_port_by_index(const LilvPlugin* plugin, uint32_t index);
 /**
    Get a port on `plugin` by `symbol`.
 
-   Note this function is slower than lilv_plugin_get_port_by_index(),
-   especially on plugins with a very large number of ports.
+   Ports are indexed by symbol when they are loaded, so this is nearly as fast
+   as lilv_plugin_get_port_by_index().
 */
 LILV_API
 const LilvPort*
 lilv_plugin_get_port_by_symbol(const LilvPlugin* plugin,
                                const LilvNode*   symbol);
 
+/**
+   Well-known port classes and properties.
+
+   These are used as flags in LilvPortInfo, and also make lilv_port_is_a() and
+   lilv_port_has_property() fast for these classes and properties.
+*/
+typedef enum {
+  LILV_PORT_INPUT               = 1U << 0U,  ///< lv2:InputPort
+  LILV_PORT_OUTPUT              = 1U << 1U,  ///< lv2:OutputPort
+  LILV_PORT_AUDIO               = 1U << 2U,  ///< lv2:AudioPort
+  LILV_PORT_CONTROL             = 1U << 3U,  ///< lv2:ControlPort
+  LILV_PORT_CV                  = 1U << 4U,  ///< lv2:CVPort
+  LILV_PORT_ATOM                = 1U << 5U,  ///< atom:AtomPort
+  LILV_PORT_EVENT               = 1U << 6U,  ///< ev:EventPort
+  LILV_PORT_CONNECTION_OPTIONAL = 1U << 7U,  ///< lv2:connectionOptional
+  LILV_PORT_ENUMERATION         = 1U << 8U,  ///< lv2:enumeration
+  LILV_PORT_INTEGER             = 1U << 9U,  ///< lv2:integer
+  LILV_PORT_REPORTS_LATENCY     = 1U << 10U, ///< lv2:reportsLatency
+  LILV_PORT_SAMPLE_RATE         = 1U << 11U, ///< lv2:sampleRate
+  LILV_PORT_TOGGLED             = 1U << 12U, ///< lv2:toggled
+} LilvPortFlag;
+
+/**
+   A summary of a port, with everything most hosts need to set it up.
+*/
+typedef struct {
+  const LilvPort* port;        ///< Port
+  uint32_t        index;       ///< Port index
+  uint32_t        flags;       ///< Classes and properties (#LilvPortFlag)
+  const char*     symbol;      ///< Port symbol
+  const LilvNode* designation; ///< First port designation, or NULL
+  float           min;         ///< Minimum value, or NaN
+  float           max;         ///< Maximum value, or NaN
+  float           def;         ///< Default value, or NaN
+} LilvPortInfo;
+
+/**
+   Get a summary of every port on `plugin`.
+
+   This returns an array of lilv_plugin_get_num_ports() elements, indexed by
+   port index, which can be used to set up a plugin without querying the data
+   of each port.  The array is built the first time this is called, and is
+   owned by the plugin.
+
+   @return The port array, or NULL if the plugin has no valid ports.
+*/
+LILV_API
+const LilvPortInfo*
+lilv_plugin_get_port_infos(const LilvPlugin* plugin);
+
+/**
+   A scale point of a port, as plain values.
+*/
+typedef struct {
+  float       value; ///< Value
+  const char* label; ///< Label in the best available language
+} LilvPortScalePoint;
+
+/**
+   The range, properties, and scale points of a port, as plain values.
+*/
+typedef struct {
+  float    min;            ///< Minimum value, or NaN
+  float    max;            ///< Maximum value, or NaN
+  float    def;            ///< Default value, or NaN
+  uint32_t flags;          ///< Classes and properties (#LilvPortFlag)
+  uint32_t scale_points;   ///< Index of the first scale point
+  uint32_t n_scale_points; ///< Number of scale points
+} LilvPortRange;
+
+/**
+   Get the ranges, properties, and scale points of every port on `plugin`.
+
+   `ranges` must point to an array of N elements, where N is the value
+   returned by lilv_plugin_get_num_ports(), which will be set to the range of
+   each port, with array index corresponding to port index.  The scale points
+   of all ports are written to `points` in order, so the scale points of a
+   port are the `n_scale_points` elements starting at index `scale_points`.
+   Scale points that do not fit in `n_points` elements are counted but not
+   written, so `points` may be NULL to only count them.  Like
+   lilv_port_get_scale_points(), scale points without both a value and a label
+   are ignored.
+
+   Unlike lilv_port_get_range() and lilv_port_get_scale_points(), this reads
+   the description of each port only once, and doesn't allocate any nodes.
+   Scale point labels are owned by the world, and are valid until the bundle
+   of the plugin is unloaded.
+
+   @return The total number of scale points, which may exceed `n_points`.
+*/
+LILV_API
+uint32_t
+lilv_plugin_get_port_ranges(const LilvPlugin*   plugin,
+                            LilvPortRange*      ranges,
+                            LilvPortScalePoint* points,
+                            uint32_t            n_points);
+
 /**
    Get a port on `plugin` by its lv2:designation.
 
@@ -1136,6 +1769,31 @@ lilv_plugin_get_port_by_designation(const LilvPlugin* plugin,
                                     const LilvNode*   port_class,
                                     const LilvNode*   designation);
 
+/**
+   A port with a designation.
+*/
+typedef struct {
+  const LilvPort* port;        ///< Port
+  const LilvNode* designation; ///< Designation, like lv2:control or lv2:enabled
+} LilvDesignatedPort;
+
+/**
+   Get every designated port on `plugin`.
+
+   This returns all designations of all ports at once, so hosts can find the
+   ports they care about, like lv2:control, lv2:enabled, or lv2:freeWheeling,
+   in a single pass.  The designations are found when the ports are loaded, in
+   port index order, and a port with several designations has an element for
+   each.  The returned array is owned by the plugin.
+
+   @param plugin The plugin.
+   @param n_ports Set to the number of elements in the returned array.
+   @return The designated ports, or NULL if there are none.
+*/
+LILV_API
+const LilvDesignatedPort*
+lilv_plugin_get_designated_ports(const LilvPlugin* plugin, uint32_t* n_ports);
+
 /**
    Get the project the plugin is a part of.
 
@@ -1256,6 +1914,17 @@ lilv_port_get_value(const LilvPlugin* plugin,
                     const LilvPort*   port,
                     const LilvNode*   predicate);
 
+/**
+   Port analog of lilv_plugin_foreach_value().
+*/
+LILV_API
+unsigned
+lilv_port_foreach_value(const LilvPlugin* plugin,
+                        const LilvPort*   port,
+                        const LilvNode*   predicate,
+                        LilvMatchFunc     func,
+                        void*             data);
+
 /**
    Get a single property value of a port.
 
@@ -1828,6 +2497,29 @@ LILV_API
 LilvPluginClasses*
 lilv_plugin_class_get_children(const LilvPluginClass* plugin_class);
 
+/**
+   Get all subclasses of this plugin class, recursively.
+
+   This returns the children of this class, their children, and so on.
+
+   Returned value must be freed by caller with lilv_plugin_classes_free().
+*/
+LILV_API
+LilvPluginClasses*
+lilv_plugin_class_get_descendants(const LilvPluginClass* plugin_class);
+
+/**
+   Get all plugins in this plugin class or any of its subclasses.
+
+   Note that this needs the class of every plugin, which loads the data of any
+   plugins that haven't been loaded yet.
+
+   Returned value must be freed by caller with lilv_plugins_free().
+*/
+LILV_API
+LilvPlugins*
+lilv_plugin_class_get_plugins(const LilvPluginClass* plugin_class);
+
 /**
    @}
    @defgroup lilv_instance Plugin Instances
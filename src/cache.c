@@ -0,0 +1,898 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "lilv_internal.h"
+
+#include "lilv/lilv.h"
+#include "serd/serd.h"
+#include "sord/sord.h"
+#include "zix/tree.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define USTR(s) ((const uint8_t*)(s))
+
+/*
+  The cache file is a flat sequence of native-endian integers and
+  length-prefixed strings:
+
+  - Header: magic, format version, byte order mark, number of entries
+  - Entry: bundle URI, files, nodes, and triples
+  - File: path, modification time, size
+  - Node: type, datatype index plus one (or zero), string, language
+  - Triple: subject, predicate, and object node indices
+
+  Blank nodes are stored with labels that are only unique within an entry,
+  and are given a fresh prefix when the entry is replayed into a world.
+*/
+
+#define LILV_CACHE_MAGIC "LILVCACH"
+#define LILV_CACHE_VERSION 1U
+#define LILV_CACHE_BOM 0x01020304U
+
+typedef struct {
+  char*         path;  ///< Local file path
+  LilvFileStamp stamp; ///< Stamp of file when entry was written
+} LilvCacheFile;
+
+typedef struct {
+  uint32_t type;     ///< SordNodeType
+  uint32_t datatype; ///< Index of datatype node plus one, or zero
+  char*    str;      ///< Node string
+  char*    lang;     ///< Literal language, or NULL
+} LilvCacheNode;
+
+struct LilvCacheEntryImpl {
+  char*          bundle;    ///< Bundle URI
+  LilvCacheFile* files;     ///< Manifest and rdfs:seeAlso files
+  LilvCacheNode* nodes;     ///< Node table
+  uint32_t*      triples;   ///< Subject, predicate, object node indices
+  uint32_t       n_files;   ///< Number of files
+  uint32_t       n_nodes;   ///< Number of nodes
+  uint32_t       n_triples; ///< Number of triples
+  bool           used;      ///< True if entry was used since opening
+};
+
+struct LilvCacheImpl {
+  char*    path;    ///< Path of cache file
+  ZixTree* entries; ///< LilvCacheEntry sorted by bundle
+  bool     dirty;   ///< True if entries have changed since last save
+};
+
+typedef struct {
+  const uint8_t* ptr;
+  const uint8_t* end;
+  bool           error;
+} Reader;
+
+typedef struct {
+  const SordNode* node;
+  uint32_t        index;
+} NodeIndex;
+
+static int
+entry_cmp(const void* a, const void* b, const void* user_data)
+{
+  (void)user_data;
+
+  return strcmp(((const LilvCacheEntry*)a)->bundle,
+                ((const LilvCacheEntry*)b)->bundle);
+}
+
+static int
+node_index_cmp(const void* a, const void* b, const void* user_data)
+{
+  (void)user_data;
+
+  const SordNode* const na = ((const NodeIndex*)a)->node;
+  const SordNode* const nb = ((const NodeIndex*)b)->node;
+
+  return (na < nb) ? -1 : (nb < na) ? 1 : 0;
+}
+
+static void
+entry_free(void* ptr, const void* user_data)
+{
+  (void)user_data;
+
+  LilvCacheEntry* const entry = (LilvCacheEntry*)ptr;
+  if (entry) {
+    for (uint32_t i = 0U; i < entry->n_files; ++i) {
+      free(entry->files[i].path);
+    }
+
+    for (uint32_t i = 0U; i < entry->n_nodes; ++i) {
+      free(entry->nodes[i].str);
+      free(entry->nodes[i].lang);
+    }
+
+    free(entry->triples);
+    free(entry->nodes);
+    free(entry->files);
+    free(entry->bundle);
+    free(entry);
+  }
+}
+
+static void
+node_index_free(void* ptr, const void* user_data)
+{
+  (void)user_data;
+  free(ptr);
+}
+
+/*
+ * Reading
+ */
+
+static bool
+read_bytes(Reader* reader, void* buf, size_t size)
+{
+  if (reader->error || (size_t)(reader->end - reader->ptr) < size) {
+    reader->error = true;
+    return false;
+  }
+
+  memcpy(buf, reader->ptr, size);
+  reader->ptr += size;
+  return true;
+}
+
+static uint32_t
+read_u32(Reader* reader)
+{
+  uint32_t value = 0U;
+  read_bytes(reader, &value, sizeof(value));
+  return value;
+}
+
+static int64_t
+read_i64(Reader* reader)
+{
+  int64_t value = 0;
+  read_bytes(reader, &value, sizeof(value));
+  return value;
+}
+
+static char*
+read_string(Reader* reader)
+{
+  const uint32_t len = read_u32(reader);
+  if (reader->error || (size_t)(reader->end - reader->ptr) < len) {
+    reader->error = true;
+    return NULL;
+  }
+
+  char* const str = (char*)malloc(len + 1U);
+  memcpy(str, reader->ptr, len);
+  str[len] = '\0';
+  reader->ptr += len;
+  return str;
+}
+
+static LilvCacheEntry*
+read_entry(Reader* reader)
+{
+  LilvCacheEntry* const entry =
+    (LilvCacheEntry*)calloc(1, sizeof(LilvCacheEntry));
+
+  entry->bundle = read_string(reader);
+
+  const uint32_t n_files = read_u32(reader);
+  if (reader->error ||
+      (size_t)(reader->end - reader->ptr) / (3U * sizeof(uint32_t)) <
+        n_files) {
+    goto fail;
+  }
+
+  entry->files = (LilvCacheFile*)calloc(n_files, sizeof(LilvCacheFile));
+  for (uint32_t i = 0U; i < n_files && !reader->error; ++i) {
+    entry->files[i].path       = read_string(reader);
+    entry->files[i].stamp.time = read_i64(reader);
+    entry->files[i].stamp.size = read_i64(reader);
+    entry->n_files             = i + 1U;
+  }
+
+  const uint32_t n_nodes = read_u32(reader);
+  if (reader->error ||
+      (size_t)(reader->end - reader->ptr) / (4U * sizeof(uint32_t)) <
+        n_nodes) {
+    goto fail;
+  }
+
+  entry->nodes = (LilvCacheNode*)calloc(n_nodes, sizeof(LilvCacheNode));
+  for (uint32_t i = 0U; i < n_nodes && !reader->error; ++i) {
+    LilvCacheNode* const node = &entry->nodes[i];
+
+    node->type     = read_u32(reader);
+    node->datatype = read_u32(reader);
+    node->str      = read_string(reader);
+    node->lang     = read_string(reader);
+    entry->n_nodes = i + 1U;
+
+    if (!node->lang || !node->lang[0]) {
+      free(node->lang);
+      node->lang = NULL;
+    }
+
+    if ((node->type != SORD_URI && node->type != SORD_BLANK &&
+         node->type != SORD_LITERAL) ||
+        node->datatype > i ||
+        (node->datatype && (node->type != SORD_LITERAL ||
+                            entry->nodes[node->datatype - 1U].type !=
+                              SORD_URI))) {
+      goto fail;
+    }
+  }
+
+  const uint32_t n_triples = read_u32(reader);
+  if (reader->error ||
+      (size_t)(reader->end - reader->ptr) / (3U * sizeof(uint32_t)) <
+        n_triples) {
+    goto fail;
+  }
+
+  entry->triples = (uint32_t*)calloc(3U * (size_t)n_triples, sizeof(uint32_t));
+  entry->n_triples = n_triples;
+  for (size_t i = 0U; i < 3U * (size_t)n_triples; ++i) {
+    entry->triples[i] = read_u32(reader);
+    if (entry->triples[i] >= n_nodes) {
+      goto fail;
+    }
+  }
+
+  if (!reader->error) {
+    return entry;
+  }
+
+fail:
+  reader->error = true;
+  entry_free(entry, NULL);
+  return NULL;
+}
+
+static void
+lilv_cache_read(LilvCache* cache)
+{
+  FILE* const fd = fopen(cache->path, "rb");
+  if (!fd) {
+    return; // No cache yet
+  }
+
+  fseek(fd, 0, SEEK_END);
+  const long size = ftell(fd);
+  fseek(fd, 0, SEEK_SET);
+  if (size <= 0) {
+    fclose(fd);
+    return;
+  }
+
+  uint8_t* const buf = (uint8_t*)malloc((size_t)size);
+  if (fread(buf, 1, (size_t)size, fd) != (size_t)size) {
+    LILV_ERRORF("Failed to read cache file `%s'\n", cache->path);
+    fclose(fd);
+    free(buf);
+    return;
+  }
+
+  fclose(fd);
+
+  Reader  reader   = {buf, buf + size, false};
+  uint8_t magic[8] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
+  read_bytes(&reader, magic, sizeof(magic));
+
+  const uint32_t version   = read_u32(&reader);
+  const uint32_t bom       = read_u32(&reader);
+  const uint32_t n_entries = read_u32(&reader);
+  if (reader.error || memcmp(magic, LILV_CACHE_MAGIC, sizeof(magic)) ||
+      version != LILV_CACHE_VERSION || bom != LILV_CACHE_BOM) {
+    LILV_WARNF("Ignoring incompatible cache file `%s'\n", cache->path);
+    free(buf);
+    return;
+  }
+
+  for (uint32_t i = 0U; i < n_entries; ++i) {
+    LilvCacheEntry* const entry = read_entry(&reader);
+    if (!entry) {
+      LILV_WARNF("Ignoring corrupt cache file `%s'\n", cache->path);
+      zix_tree_free(cache->entries);
+      cache->entries =
+        zix_tree_new(NULL, false, entry_cmp, NULL, entry_free, NULL);
+      break;
+    }
+
+    if (zix_tree_insert(cache->entries, entry, NULL)) {
+      entry_free(entry, NULL);
+    }
+  }
+
+  free(buf);
+}
+
+/*
+ * Writing
+ */
+
+static bool
+write_u32(FILE* fd, const uint32_t value)
+{
+  return fwrite(&value, sizeof(value), 1, fd) == 1;
+}
+
+static bool
+write_i64(FILE* fd, const int64_t value)
+{
+  return fwrite(&value, sizeof(value), 1, fd) == 1;
+}
+
+static bool
+write_string(FILE* fd, const char* str)
+{
+  const size_t len = str ? strlen(str) : 0U;
+
+  return write_u32(fd, (uint32_t)len) && fwrite(str, 1, len, fd) == len;
+}
+
+static bool
+write_entry(FILE* fd, const LilvCacheEntry* entry)
+{
+  bool ok = write_string(fd, entry->bundle) && write_u32(fd, entry->n_files);
+  for (uint32_t i = 0U; ok && i < entry->n_files; ++i) {
+    const LilvCacheFile* const file = &entry->files[i];
+
+    ok = write_string(fd, file->path) && write_i64(fd, file->stamp.time) &&
+         write_i64(fd, file->stamp.size);
+  }
+
+  ok = ok && write_u32(fd, entry->n_nodes);
+  for (uint32_t i = 0U; ok && i < entry->n_nodes; ++i) {
+    const LilvCacheNode* const node = &entry->nodes[i];
+
+    ok = write_u32(fd, node->type) && write_u32(fd, node->datatype) &&
+         write_string(fd, node->str) && write_string(fd, node->lang);
+  }
+
+  const size_t n_indices = 3U * (size_t)entry->n_triples;
+
+  return ok && write_u32(fd, entry->n_triples) &&
+         fwrite(entry->triples, sizeof(uint32_t), n_indices, fd) == n_indices;
+}
+
+int
+lilv_cache_save(LilvCache* cache, const bool prune)
+{
+  uint32_t n_entries = 0U;
+  for (ZixTreeIter* i = zix_tree_begin(cache->entries);
+       !zix_tree_iter_is_end(i);
+       i = zix_tree_iter_next(i)) {
+    const LilvCacheEntry* const entry =
+      (const LilvCacheEntry*)zix_tree_get(i);
+
+    n_entries += (!prune || entry->used) ? 1U : 0U;
+  }
+
+  if (!cache->path ||
+      (!cache->dirty && n_entries == zix_tree_size(cache->entries))) {
+    return 0; // Not persistent, or nothing has changed
+  }
+
+  // Write to a temporary file, then atomically replace the cache with it
+  char* const tmp_path = lilv_strjoin(cache->path, ".tmp", NULL);
+  FILE* const fd       = fopen(tmp_path, "wb");
+  if (!fd) {
+    LILV_ERRORF("Failed to open cache file `%s'\n", tmp_path);
+    free(tmp_path);
+    return 1;
+  }
+
+  bool ok = fwrite(LILV_CACHE_MAGIC, 1, 8, fd) == 8 &&
+            write_u32(fd, LILV_CACHE_VERSION) &&
+            write_u32(fd, LILV_CACHE_BOM) && write_u32(fd, n_entries);
+
+  for (ZixTreeIter* i = zix_tree_begin(cache->entries);
+       ok && !zix_tree_iter_is_end(i);
+       i = zix_tree_iter_next(i)) {
+    const LilvCacheEntry* const entry =
+      (const LilvCacheEntry*)zix_tree_get(i);
+
+    if (!prune || entry->used) {
+      ok = write_entry(fd, entry);
+    }
+  }
+
+  ok = !fclose(fd) && ok;
+#ifdef _WIN32
+  if (ok) {
+    remove(cache->path); // rename() does not replace existing files
+  }
+#endif
+  ok = ok && !rename(tmp_path, cache->path);
+  if (!ok) {
+    LILV_ERRORF("Failed to write cache file `%s'\n", cache->path);
+    remove(tmp_path);
+  } else {
+    cache->dirty = false;
+  }
+
+  free(tmp_path);
+  return ok ? 0 : 1;
+}
+
+/*
+ * Cache
+ */
+
+LilvCache*
+lilv_cache_new(const char* path)
+{
+  LilvCache* const cache = (LilvCache*)calloc(1, sizeof(LilvCache));
+
+  cache->path    = path ? lilv_strdup(path) : NULL;
+  cache->entries = zix_tree_new(NULL, false, entry_cmp, NULL, entry_free, NULL);
+
+  if (path) {
+    lilv_cache_read(cache);
+  }
+
+  return cache;
+}
+
+void
+lilv_cache_free(LilvCache* cache)
+{
+  if (cache) {
+    zix_tree_free(cache->entries);
+    free(cache->path);
+    free(cache);
+  }
+}
+
+/** Return the entry for `bundle` if it exists and is up to date. */
+static LilvCacheEntry*
+lilv_cache_find_fresh(const LilvCache* cache, const char* bundle)
+{
+  LilvCacheEntry key;
+  memset(&key, 0, sizeof(key));
+  key.bundle = (char*)bundle;
+
+  ZixTreeIter* iter = NULL;
+  if (zix_tree_find(cache->entries, &key, &iter)) {
+    return NULL; // Not cached
+  }
+
+  LilvCacheEntry* const entry = (LilvCacheEntry*)zix_tree_get(iter);
+  for (uint32_t i = 0U; i < entry->n_files; ++i) {
+    const LilvCacheFile* const file  = &entry->files[i];
+    const LilvFileStamp        stamp = lilv_file_stamp(file->path);
+    if (stamp.time != file->stamp.time || stamp.size != file->stamp.size) {
+      return NULL; // Stale
+    }
+  }
+
+  return entry;
+}
+
+bool
+lilv_cache_is_fresh(const LilvCache* cache, const char* bundle_uri)
+{
+  return lilv_cache_find_fresh(cache, bundle_uri) != NULL;
+}
+
+int
+lilv_cache_replay(LilvCache* cache, LilvWorld* world, SordNode* bundle)
+{
+  LilvCacheEntry* const entry =
+    lilv_cache_find_fresh(cache, (const char*)sord_node_get_string(bundle));
+  if (!entry) {
+    return 1;
+  }
+
+  // Create nodes, giving blank nodes a fresh prefix like the reader would
+  const char* const prefix = (const char*)lilv_world_blank_node_prefix(world);
+
+  SordNode** const nodes =
+    (SordNode**)calloc(entry->n_nodes, sizeof(SordNode*));
+
+  for (uint32_t i = 0U; i < entry->n_nodes; ++i) {
+    const LilvCacheNode* const node = &entry->nodes[i];
+    const uint8_t* const       str  = (const uint8_t*)node->str;
+
+    if (node->type == SORD_URI) {
+      nodes[i] = sord_new_uri(world->world, str);
+    } else if (node->type == SORD_BLANK) {
+      char* const label = lilv_strjoin(prefix, node->str, NULL);
+      nodes[i]          = sord_new_blank(world->world, (const uint8_t*)label);
+      free(label);
+    } else {
+      nodes[i] = sord_new_literal(
+        world->world,
+        node->datatype ? nodes[node->datatype - 1U] : NULL,
+        str,
+        node->lang);
+    }
+  }
+
+  for (uint32_t i = 0U; i < entry->n_triples; ++i) {
+    const uint32_t* const t = entry->triples + (3U * (size_t)i);
+
+    const SordQuad quad = {nodes[t[0]], nodes[t[1]], nodes[t[2]], bundle};
+    sord_add(world->model, quad);
+  }
+  ++world->epoch;
+
+  for (uint32_t i = 0U; i < entry->n_nodes; ++i) {
+    sord_node_free(world->world, nodes[i]);
+  }
+
+  free(nodes);
+  entry->used = true;
+  return 0;
+}
+
+static uint32_t
+add_node(LilvCacheEntry* const entry,
+         const SordNodeType    type,
+         const uint32_t        datatype,
+         const char* const     str,
+         const char* const     lang)
+{
+  const uint32_t n = entry->n_nodes++;
+  entry->nodes     = (LilvCacheNode*)realloc(
+    entry->nodes, entry->n_nodes * sizeof(LilvCacheNode));
+
+  LilvCacheNode* const node = &entry->nodes[n];
+
+  node->type     = (uint32_t)type;
+  node->datatype = datatype;
+  node->lang     = (lang && lang[0]) ? lilv_strdup(lang) : NULL;
+  if (type == SORD_BLANK) {
+    // Replace the label with one that is only unique within this entry
+    char label[16];
+    snprintf(label, sizeof(label), "b%u", n);
+    node->str = lilv_strdup(label);
+  } else {
+    node->str = lilv_strdup(str);
+  }
+
+  return n;
+}
+
+static void
+add_triple(LilvCacheEntry* const entry,
+           const uint32_t        s,
+           const uint32_t        p,
+           const uint32_t        o)
+{
+  entry->triples = (uint32_t*)realloc(
+    entry->triples, 3U * (entry->n_triples + 1U) * sizeof(uint32_t));
+
+  uint32_t* const t = entry->triples + (3U * (size_t)entry->n_triples++);
+  t[0]              = s;
+  t[1]              = p;
+  t[2]              = o;
+}
+
+static void
+add_file(LilvCacheEntry* entry, const char* path, const LilvFileStamp stamp)
+{
+  for (uint32_t i = 0U; i < entry->n_files; ++i) {
+    if (!strcmp(entry->files[i].path, path)) {
+      return;
+    }
+  }
+
+  entry->files = (LilvCacheFile*)realloc(
+    entry->files, (entry->n_files + 1U) * sizeof(LilvCacheFile));
+
+  entry->files[entry->n_files].path  = lilv_strdup(path);
+  entry->files[entry->n_files].stamp = stamp;
+  ++entry->n_files;
+}
+
+/** Add local rdfs:seeAlso files to the entry key, so changes invalidate it. */
+static void
+add_data_files(LilvCacheEntry* entry)
+{
+  for (uint32_t i = 0U; i < entry->n_triples; ++i) {
+    const uint32_t* const      t    = entry->triples + (3U * (size_t)i);
+    const LilvCacheNode* const pred = &entry->nodes[t[1]];
+    const LilvCacheNode* const obj  = &entry->nodes[t[2]];
+
+    if (pred->type == SORD_URI && obj->type == SORD_URI &&
+        !strcmp(pred->str, LILV_NS_RDFS "seeAlso") &&
+        !strncmp(obj->str, "file:", 5)) {
+      char* const path = lilv_file_uri_parse(obj->str, NULL);
+      if (path) {
+        add_file(entry, path, lilv_file_stamp(path));
+        lilv_free(path);
+      }
+    }
+  }
+}
+
+static uint32_t
+intern_node(LilvCacheEntry* entry, ZixTree* index, const SordNode* node)
+{
+  NodeIndex    key  = {node, 0U};
+  ZixTreeIter* iter = NULL;
+  if (!zix_tree_find(index, &key, &iter)) {
+    return ((const NodeIndex*)zix_tree_get(iter))->index;
+  }
+
+  uint32_t datatype = 0U;
+  if (sord_node_get_type(node) == SORD_LITERAL) {
+    const SordNode* const dt = sord_node_get_datatype(node);
+    datatype                 = dt ? intern_node(entry, index, dt) + 1U : 0U;
+  }
+
+  NodeIndex* const record = (NodeIndex*)malloc(sizeof(NodeIndex));
+  record->node            = node;
+  record->index           = add_node(entry,
+                           sord_node_get_type(node),
+                           datatype,
+                           (const char*)sord_node_get_string(node),
+                           sord_node_get_language(node));
+
+  zix_tree_insert(index, record, NULL);
+  return record->index;
+}
+
+void
+lilv_cache_update(LilvCache*          cache,
+                  LilvWorld*          world,
+                  const SordNode*     bundle,
+                  const char*         manifest_path,
+                  const LilvFileStamp manifest_stamp)
+{
+  if (!cache->path) {
+    return; // Entries in a temporary cache are only replayed, never saved
+  }
+
+  LilvCacheEntry* const entry =
+    (LilvCacheEntry*)calloc(1, sizeof(LilvCacheEntry));
+
+  entry->bundle = lilv_strdup((const char*)sord_node_get_string(bundle));
+  add_file(entry, manifest_path, manifest_stamp);
+
+  ZixTree* const index =
+    zix_tree_new(NULL, false, node_index_cmp, NULL, node_index_free, NULL);
+
+  SordIter* i = sord_search(world->model, NULL, NULL, NULL, bundle);
+  for (; !sord_iter_end(i); sord_iter_next(i)) {
+    SordQuad quad;
+    sord_iter_get(i, quad);
+
+    const uint32_t s = intern_node(entry, index, quad[SORD_SUBJECT]);
+    const uint32_t p = intern_node(entry, index, quad[SORD_PREDICATE]);
+    const uint32_t o = intern_node(entry, index, quad[SORD_OBJECT]);
+
+    add_triple(entry, s, p, o);
+  }
+  sord_iter_free(i);
+  zix_tree_free(index);
+
+  add_data_files(entry);
+  lilv_cache_insert(cache, entry);
+}
+
+void
+lilv_cache_insert(LilvCache* cache, LilvCacheEntry* entry)
+{
+  ZixTreeIter* iter = NULL;
+  if (!zix_tree_find(cache->entries, entry, &iter)) {
+    zix_tree_remove(cache->entries, iter);
+  }
+
+  entry->used = true;
+  zix_tree_insert(cache->entries, entry, NULL);
+  cache->dirty = true;
+}
+
+/*
+ * Parsing
+ */
+
+typedef struct {
+  uint32_t type;     ///< SordNodeType
+  uint32_t datatype; ///< Index of datatype node plus one, or zero
+  char*    str;      ///< Node string (original label for blank nodes)
+  char*    lang;     ///< Literal language, or NULL
+  uint32_t index;    ///< Index of node in entry
+} ParsedNode;
+
+typedef struct {
+  LilvCacheEntry* entry; ///< Entry being built
+  SerdEnv*        env;   ///< Environment for expanding URIs
+  ZixTree*        index; ///< ParsedNode sorted by value
+} Parser;
+
+static int
+parsed_node_cmp(const void* a, const void* b, const void* user_data)
+{
+  (void)user_data;
+
+  const ParsedNode* const na = (const ParsedNode*)a;
+  const ParsedNode* const nb = (const ParsedNode*)b;
+  if (na->type != nb->type) {
+    return na->type < nb->type ? -1 : 1;
+  }
+
+  if (na->datatype != nb->datatype) {
+    return na->datatype < nb->datatype ? -1 : 1;
+  }
+
+  const int cmp = strcmp(na->str, nb->str);
+  if (cmp || (!na->lang && !nb->lang)) {
+    return cmp;
+  }
+
+  return strcmp(na->lang ? na->lang : "", nb->lang ? nb->lang : "");
+}
+
+static void
+parsed_node_free(void* ptr, const void* user_data)
+{
+  (void)user_data;
+
+  ParsedNode* const node = (ParsedNode*)ptr;
+  free(node->str);
+  free(node->lang);
+  free(node);
+}
+
+static uint32_t
+parse_intern(Parser*            parser,
+             const SordNodeType type,
+             const uint32_t     datatype,
+             const char*        str,
+             const char*        lang)
+{
+  ParsedNode key = {(uint32_t)type,
+                    datatype,
+                    (char*)str,
+                    (lang && lang[0]) ? (char*)lang : NULL,
+                    0U};
+
+  ZixTreeIter* iter = NULL;
+  if (!zix_tree_find(parser->index, &key, &iter)) {
+    return ((const ParsedNode*)zix_tree_get(iter))->index;
+  }
+
+  ParsedNode* const record = (ParsedNode*)malloc(sizeof(ParsedNode));
+  *record                  = key;
+  record->str              = lilv_strdup(str);
+  record->lang             = key.lang ? lilv_strdup(key.lang) : NULL;
+  record->index = add_node(parser->entry, type, datatype, str, key.lang);
+
+  zix_tree_insert(parser->index, record, NULL);
+  return record->index;
+}
+
+/** Intern a node from the reader, or return UINT32_MAX on error. */
+static uint32_t
+parse_node(Parser*         parser,
+           const SerdNode* node,
+           const SerdNode* datatype,
+           const SerdNode* lang)
+{
+  uint32_t index = UINT32_MAX;
+  if (node->type == SERD_BLANK) {
+    index = parse_intern(parser, SORD_BLANK, 0U, (const char*)node->buf, NULL);
+  } else if (node->type == SERD_URI || node->type == SERD_CURIE) {
+    SerdNode uri = serd_env_expand_node(parser->env, node);
+    if (uri.buf) {
+      index = parse_intern(parser, SORD_URI, 0U, (const char*)uri.buf, NULL);
+    }
+    serd_node_free(&uri);
+  } else if (node->type == SERD_LITERAL) {
+    uint32_t datatype_index = 0U;
+    if (datatype && datatype->buf) {
+      datatype_index = parse_node(parser, datatype, NULL, NULL);
+      if (datatype_index == UINT32_MAX) {
+        return UINT32_MAX;
+      }
+      ++datatype_index;
+    }
+
+    index = parse_intern(parser,
+                         SORD_LITERAL,
+                         datatype_index,
+                         (const char*)node->buf,
+                         (lang && lang->buf) ? (const char*)lang->buf : NULL);
+  }
+
+  return index;
+}
+
+static SerdStatus
+on_base(void* handle, const SerdNode* uri)
+{
+  return serd_env_set_base_uri(((Parser*)handle)->env, uri);
+}
+
+static SerdStatus
+on_prefix(void* handle, const SerdNode* name, const SerdNode* uri)
+{
+  return serd_env_set_prefix(((Parser*)handle)->env, name, uri);
+}
+
+static SerdStatus
+on_statement(void*              handle,
+             SerdStatementFlags flags,
+             const SerdNode*    graph,
+             const SerdNode*    subject,
+             const SerdNode*    predicate,
+             const SerdNode*    object,
+             const SerdNode*    object_datatype,
+             const SerdNode*    object_lang)
+{
+  (void)flags;
+  (void)graph;
+
+  Parser* const  parser = (Parser*)handle;
+  const uint32_t s      = parse_node(parser, subject, NULL, NULL);
+  const uint32_t p      = parse_node(parser, predicate, NULL, NULL);
+  const uint32_t o = parse_node(parser, object, object_datatype, object_lang);
+
+  if (s == UINT32_MAX || p == UINT32_MAX || o == UINT32_MAX) {
+    return SERD_ERR_BAD_ARG;
+  }
+
+  add_triple(parser->entry, s, p, o);
+  return SERD_SUCCESS;
+}
+
+static SerdStatus
+on_error(void* handle, const SerdError* error)
+{
+  (void)handle;
+  (void)error;
+  return SERD_SUCCESS; // Errors are reported if the manifest is parsed again
+}
+
+LilvCacheEntry*
+lilv_cache_parse(const char* bundle_uri,
+                 const char* manifest_uri,
+                 const char* manifest_path)
+{
+  // Stamp before parsing so that concurrent changes invalidate the entry
+  const LilvFileStamp stamp = lilv_file_stamp(manifest_path);
+  if (stamp.time < 0) {
+    return NULL;
+  }
+
+  LilvCacheEntry* const entry =
+    (LilvCacheEntry*)calloc(1, sizeof(LilvCacheEntry));
+
+  entry->bundle = lilv_strdup(bundle_uri);
+  add_file(entry, manifest_path, stamp);
+
+  const SerdNode base = serd_node_from_string(SERD_URI, USTR(manifest_uri));
+
+  Parser parser = {entry, serd_env_new(&base), NULL};
+  parser.index =
+    zix_tree_new(NULL, false, parsed_node_cmp, NULL, parsed_node_free, NULL);
+
+  SerdReader* const reader = serd_reader_new(
+    SERD_TURTLE, &parser, NULL, on_base, on_prefix, on_statement, NULL);
+
+  serd_reader_set_error_sink(reader, on_error, NULL);
+
+  const SerdStatus st = lilv_reader_read_file(reader, USTR(manifest_uri));
+
+  serd_reader_free(reader);
+  zix_tree_free(parser.index);
+  serd_env_free(parser.env);
+
+  if (st) {
+    entry_free(entry, NULL);
+    return NULL;
+  }
+
+  add_data_files(entry);
+  return entry;
+}
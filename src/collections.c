@@ -5,12 +5,11 @@
 
 #include "lilv/lilv.h"
 #include "sord/sord.h"
-#include "zix/tree.h"
 
 #include <stdbool.h>
 #include <stddef.h>
-
-typedef void (*LilvFreeFunc)(void* ptr);
+#include <stdlib.h>
+#include <string.h>
 
 int
 lilv_ptr_cmp(const void* a, const void* b, const void* user_data)
@@ -31,48 +30,201 @@ lilv_resource_node_cmp(const void* a, const void* b, const void* user_data)
   return an < bn ? -1 : bn < an ? 1 : 0;
 }
 
-/* Generic collection functions */
-
-static void
-destroy(void* const ptr, const void* const user_data)
+int
+lilv_node_key_cmp(const void* a, const void* b, const void* user_data)
 {
-  if (user_data) {
-    ((LilvFreeFunc)user_data)(ptr);
-  }
+  (void)user_data;
+
+  const SordNode* ak = ((const LilvNode*)a)->key;
+  const SordNode* bk = ((const LilvNode*)b)->key;
+
+  return ak < bk ? -1 : bk < ak ? 1 : 0;
 }
 
-static inline LilvCollection*
-lilv_collection_new(ZixTreeCompareFunc cmp, LilvFreeFunc free_func)
+/* Generic collection functions */
+
+LilvCollection*
+lilv_collection_new(LilvCompareFunc cmp, LilvFreeFunc free_func)
 {
-  return zix_tree_new(NULL, false, cmp, NULL, destroy, (const void*)free_func);
+  LilvCollection* const collection =
+    (LilvCollection*)calloc(1, sizeof(LilvCollection));
+
+  collection->cmp       = cmp;
+  collection->free_func = free_func;
+  return collection;
 }
 
 void
 lilv_collection_free(LilvCollection* collection)
 {
   if (collection) {
-    zix_tree_free((ZixTree*)collection);
+    if (collection->free_func) {
+      for (size_t i = 0U; i < collection->size; ++i) {
+        collection->free_func(collection->elems[i]);
+      }
+    }
+
+    free(collection->elems);
+    free(collection);
   }
 }
 
 unsigned
 lilv_collection_size(const LilvCollection* collection)
 {
-  return (collection ? zix_tree_size((const ZixTree*)collection) : 0);
+  return (collection ? (unsigned)collection->size : 0);
 }
 
 LilvIter*
 lilv_collection_begin(const LilvCollection* collection)
 {
-  return collection ? (LilvIter*)zix_tree_begin((ZixTree*)collection) : NULL;
+  return (collection && collection->size) ? (LilvIter*)collection->elems
+                                          : NULL;
+}
+
+static bool
+lilv_collection_is_end(const LilvCollection* collection, const LilvIter* i)
+{
+  return !collection || !i ||
+         (void* const*)i >= collection->elems + collection->size;
+}
+
+static LilvIter*
+lilv_collection_next(const LilvCollection* collection, LilvIter* i)
+{
+  return lilv_collection_is_end(collection, i) ? NULL : (void**)i + 1;
 }
 
 void*
 lilv_collection_get(const LilvCollection* collection, const LilvIter* i)
 {
-  (void)collection;
+  return lilv_collection_is_end(collection, i) ? NULL : *(void* const*)i;
+}
+
+/** Ensure there is space for at least `capacity` elements. */
+static void
+lilv_collection_reserve(LilvCollection* collection, const size_t capacity)
+{
+  if (capacity > collection->capacity) {
+    collection->elems =
+      (void**)realloc(collection->elems, capacity * sizeof(void*));
+    collection->capacity = capacity;
+  }
+}
+
+/** Return the index of the first element that is not less than `key`. */
+static size_t
+lilv_collection_lower_bound(const LilvCollection* collection, const void* key)
+{
+  size_t lo = 0U;
+  size_t hi = collection->size;
+  while (lo < hi) {
+    const size_t mid = lo + ((hi - lo) / 2U);
+    if (collection->cmp(collection->elems[mid], key, NULL) < 0) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+LilvIter*
+lilv_collection_find(const LilvCollection* collection, const void* key)
+{
+  if (!collection) {
+    return NULL;
+  }
+
+  if (!collection->cmp) {
+    for (size_t i = 0U; i < collection->size; ++i) {
+      if (collection->elems[i] == key) {
+        return (LilvIter*)&collection->elems[i];
+      }
+    }
+
+    return NULL;
+  }
+
+  const size_t i = lilv_collection_lower_bound(collection, key);
+  if (i == collection->size ||
+      collection->cmp(collection->elems[i], key, NULL)) {
+    return NULL;
+  }
 
-  return zix_tree_get((const ZixTreeIter*)i);
+  return (LilvIter*)&collection->elems[i];
+}
+
+/**
+   Insert an element into a collection.
+
+   Returns zero on success, or non-zero if an equal element is already in a
+   sorted collection, in which case ownership of `elem` is not taken.
+*/
+int
+lilv_collection_insert(LilvCollection* collection, void* elem)
+{
+  size_t i = collection->size;
+  if (collection->cmp && i &&
+      collection->cmp(collection->elems[i - 1U], elem, NULL) >= 0) {
+    i = lilv_collection_lower_bound(collection, elem);
+    if (!collection->cmp(collection->elems[i], elem, NULL)) {
+      return 1;
+    }
+  }
+
+  if (collection->size == collection->capacity) {
+    lilv_collection_reserve(collection,
+                            collection->capacity ? collection->capacity * 2U
+                                                 : 4U);
+  }
+
+  memmove(collection->elems + i + 1U,
+          collection->elems + i,
+          (collection->size - i) * sizeof(void*));
+
+  collection->elems[i] = elem;
+  ++collection->size;
+  return 0;
+}
+
+/** Remove and destroy the element at `i`. */
+void
+lilv_collection_remove(LilvCollection* collection, LilvIter* i)
+{
+  void** const slot  = (void**)i;
+  const size_t index = (size_t)(slot - collection->elems);
+  void* const  elem  = *slot;
+
+  memmove(slot, slot + 1U, (collection->size - index - 1U) * sizeof(void*));
+  --collection->size;
+
+  if (collection->free_func) {
+    collection->free_func(elem);
+  }
+}
+
+/** Return an iterator to the element with the given URI, or NULL. */
+LilvIter*
+lilv_collection_find_by_uri(const LilvCollection* collection,
+                            const LilvNode*       uri)
+{
+  if (!lilv_node_is_uri(uri)) {
+    return NULL;
+  }
+
+  struct LilvHeader key = {NULL, (LilvNode*)uri};
+  return lilv_collection_find(collection, &key);
+}
+
+/** Get an element of a collection of any object with an LilvHeader by URI. */
+struct LilvHeader*
+lilv_collection_get_by_uri(const LilvCollection* collection,
+                           const LilvNode*       uri)
+{
+  return (struct LilvHeader*)lilv_collection_get(
+    collection, lilv_collection_find_by_uri(collection, uri));
 }
 
 /* Constructors */
@@ -80,13 +232,14 @@ lilv_collection_get(const LilvCollection* collection, const LilvIter* i)
 LilvScalePoints*
 lilv_scale_points_new(void)
 {
-  return lilv_collection_new(lilv_ptr_cmp, (LilvFreeFunc)lilv_scale_point_free);
+  return lilv_collection_new(NULL, (LilvFreeFunc)lilv_scale_point_free);
 }
 
 LilvNodes*
 lilv_nodes_new(void)
 {
-  return lilv_collection_new(lilv_ptr_cmp, (LilvFreeFunc)lilv_node_free);
+  // Equal nodes are shared, so the same node may be added several times
+  return lilv_collection_new(NULL, (LilvFreeFunc)lilv_node_free);
 }
 
 LilvUIs*
@@ -109,14 +262,13 @@ const LilvPluginClass*
 lilv_plugin_classes_get_by_uri(const LilvPluginClasses* classes,
                                const LilvNode*          uri)
 {
-  return (LilvPluginClass*)lilv_collection_get_by_uri((const ZixTree*)classes,
-                                                      uri);
+  return (LilvPluginClass*)lilv_collection_get_by_uri(classes, uri);
 }
 
 const LilvUI*
 lilv_uis_get_by_uri(const LilvUIs* uis, const LilvNode* uri)
 {
-  return (LilvUI*)lilv_collection_get_by_uri((const ZixTree*)uis, uri);
+  return (LilvUI*)lilv_collection_get_by_uri(uis, uri);
 }
 
 /* Plugins */
@@ -130,7 +282,7 @@ lilv_plugins_new(void)
 const LilvPlugin*
 lilv_plugins_get_by_uri(const LilvPlugins* plugins, const LilvNode* uri)
 {
-  return (LilvPlugin*)lilv_collection_get_by_uri((const ZixTree*)plugins, uri);
+  return (LilvPlugin*)lilv_collection_get_by_uri(plugins, uri);
 }
 
 /* Nodes */
@@ -138,8 +290,10 @@ lilv_plugins_get_by_uri(const LilvPlugins* plugins, const LilvNode* uri)
 bool
 lilv_nodes_contains(const LilvNodes* nodes, const LilvNode* value)
 {
-  LILV_FOREACH (nodes, i, nodes) {
-    if (lilv_node_equals(lilv_nodes_get(nodes, i), value)) {
+  const LilvCollection* const collection = (const LilvCollection*)nodes;
+
+  for (size_t i = 0U; i < lilv_collection_size(collection); ++i) {
+    if (lilv_node_equals((const LilvNode*)collection->elems[i], value)) {
       return true;
     }
   }
@@ -147,21 +301,25 @@ lilv_nodes_contains(const LilvNodes* nodes, const LilvNode* value)
   return false;
 }
 
+static void
+lilv_nodes_append_all(LilvCollection* result, const LilvCollection* nodes)
+{
+  for (size_t i = 0U; i < lilv_collection_size(nodes); ++i) {
+    lilv_collection_insert(result, lilv_node_duplicate(nodes->elems[i]));
+  }
+}
+
 LilvNodes*
 lilv_nodes_merge(const LilvNodes* a, const LilvNodes* b)
 {
-  LilvNodes* result = lilv_nodes_new();
+  LilvCollection* const result = lilv_nodes_new();
 
-  LILV_FOREACH (nodes, i, a) {
-    zix_tree_insert(
-      (ZixTree*)result, lilv_node_duplicate(lilv_nodes_get(a, i)), NULL);
-  }
-
-  LILV_FOREACH (nodes, i, b) {
-    zix_tree_insert(
-      (ZixTree*)result, lilv_node_duplicate(lilv_nodes_get(b, i)), NULL);
-  }
+  lilv_collection_reserve(result,
+                          (size_t)lilv_collection_size(a) +
+                            lilv_collection_size(b));
 
+  lilv_nodes_append_all(result, a);
+  lilv_nodes_append_all(result, b);
   return result;
 }
 
@@ -186,14 +344,12 @@ lilv_nodes_merge(const LilvNodes* a, const LilvNodes* b)
                                                              \
   LilvIter* prefix##_next(const CT* collection, LilvIter* i) \
   {                                                          \
-    (void)collection;                                        \
-    return zix_tree_iter_next((ZixTreeIter*)i);              \
+    return lilv_collection_next(collection, i);              \
   }                                                          \
                                                              \
   bool prefix##_is_end(const CT* collection, LilvIter* i)    \
   {                                                          \
-    (void)collection;                                        \
-    return zix_tree_iter_is_end((ZixTreeIter*)i);            \
+    return lilv_collection_is_end(collection, i);            \
   }
 
 LILV_COLLECTION_IMPL(lilv_plugin_classes, LilvPluginClasses, LilvPluginClass)
@@ -226,6 +382,12 @@ lilv_nodes_free(LilvNodes* collection)
   lilv_collection_free(collection);
 }
 
+void
+lilv_plugins_free(LilvPlugins* collection)
+{
+  lilv_collection_free(collection);
+}
+
 LilvNode*
 lilv_nodes_get_first(const LilvNodes* collection)
 {
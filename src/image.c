@@ -0,0 +1,734 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "lilv_config.h" // IWYU pragma: keep
+#include "lilv_internal.h"
+
+#include "lilv/lilv.h"
+#include "sord/sord.h"
+#include "zix/tree.h"
+
+#if USE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  An image is a flat file of native-endian 32-bit integers, followed by
+  strings, which can be used in place wherever it is mapped into memory:
+
+  - Header: magic, format version, byte order mark, and section sizes
+  - Nodes: type, datatype ID (or zero), string offset, language offset plus
+    one (or zero)
+  - Store: SPO rows, OPS rows, subject offsets, and object offsets, exactly
+    as in a store (see store.c)
+  - Plugins: URI, bundle URI, first data URI, number of data URIs, flags
+  - Data URIs: node IDs of plugin data files
+  - Classes: URI, parent URI (or zero), label string offset
+  - Strings: null-terminated strings, referred to by offset
+
+  Node IDs are those of the store, and any other nodes that plugins or classes
+  refer to are appended to the node table after the nodes of the store.
+*/
+
+#define LILV_IMAGE_MAGIC "LILVIMAG"
+#define LILV_IMAGE_VERSION 1U
+#define LILV_IMAGE_BOM 0x01020304U
+
+#define LILV_IMAGE_NODE 4U
+#define LILV_IMAGE_ROW 4U
+#define LILV_IMAGE_PLUGIN 5U
+#define LILV_IMAGE_CLASS 3U
+
+#define LILV_IMAGE_PARSE_ERRORS 1U ///< Plugin flag for data with errors
+
+typedef struct {
+  char     magic[8];      ///< LILV_IMAGE_MAGIC, without a terminator
+  uint32_t version;       ///< LILV_IMAGE_VERSION
+  uint32_t bom;           ///< LILV_IMAGE_BOM, in native byte order
+  uint32_t n_nodes;       ///< Number of nodes, including NULL
+  uint32_t n_store_nodes; ///< Number of nodes in the store, including NULL
+  uint32_t n_quads;       ///< Number of statements
+  uint32_t n_plugins;     ///< Number of plugins
+  uint32_t n_data_uris;   ///< Number of plugin data URIs
+  uint32_t n_classes;     ///< Number of plugin classes
+  uint32_t n_strings;     ///< Size of strings in bytes
+} LilvImageHeader;
+
+struct LilvImageImpl {
+  void*                  data;      ///< File contents
+  size_t                 size;      ///< Size of file contents
+  bool                   mapped;    ///< True if data is mapped, not allocated
+  const LilvImageHeader* header;    ///< Header at the start of data
+  const uint32_t*        nodes;     ///< Node records
+  LilvStoreTables        store;     ///< Store tables, without nodes
+  const uint32_t*        plugins;   ///< Plugin records
+  const uint32_t*        data_uris; ///< Plugin data URI node IDs
+  const uint32_t*        classes;   ///< Plugin class records
+  const char*            strings;   ///< String data
+};
+
+/*
+ * Writing
+ */
+
+/** A node that isn't in the store, and its ID. */
+typedef struct {
+  const SordNode* node;
+  uint32_t        id;
+} ExtraNode;
+
+typedef struct {
+  const LilvStore* store;     ///< Store with the statements to write
+  LilvStoreTables  tables;    ///< Tables of store
+  ZixTree*         index;     ///< Extra node IDs, by address
+  const SordNode** extras;    ///< Extra nodes, in ID order
+  uint32_t         n_extras;  ///< Number of extra nodes
+  char*            strings;   ///< String data
+  size_t           n_strings; ///< Size of string data
+  bool             error;     ///< True if allocation failed
+} Writer;
+
+static int
+extra_node_cmp(const void* a, const void* b, const void* user_data)
+{
+  (void)user_data;
+
+  const SordNode* const na = ((const ExtraNode*)a)->node;
+  const SordNode* const nb = ((const ExtraNode*)b)->node;
+
+  return (na < nb) ? -1 : (nb < na) ? 1 : 0;
+}
+
+static void
+extra_node_free(void* ptr, const void* user_data)
+{
+  (void)user_data;
+  free(ptr);
+}
+
+static const SordNode*
+writer_node(const Writer* writer, const uint32_t id)
+{
+  return id < writer->tables.n_nodes
+           ? writer->tables.nodes[id]
+           : writer->extras[id - writer->tables.n_nodes];
+}
+
+/** Return the ID of `node`, appending it to the node table if necessary. */
+static uint32_t
+writer_node_id(Writer* writer, const SordNode* node)
+{
+  if (!node) {
+    return 0U;
+  }
+
+  const uint32_t id = lilv_store_find_id(writer->store, node);
+  if (id) {
+    return id;
+  }
+
+  ExtraNode    key  = {node, 0U};
+  ZixTreeIter* iter = NULL;
+  if (!zix_tree_find(writer->index, &key, &iter)) {
+    return ((const ExtraNode*)zix_tree_get(iter))->id;
+  }
+
+  const SordNode** const extras = (const SordNode**)realloc(
+    writer->extras, (writer->n_extras + 1U) * sizeof(const SordNode*));
+  ExtraNode* const record = (ExtraNode*)malloc(sizeof(ExtraNode));
+  if (!extras || !record) {
+    writer->extras = extras ? extras : writer->extras;
+    writer->error  = true;
+    free(record);
+    return 0U;
+  }
+
+  record->node = node;
+  record->id   = writer->tables.n_nodes + writer->n_extras;
+
+  writer->extras                     = extras;
+  writer->extras[writer->n_extras++] = node;
+  zix_tree_insert(writer->index, record, NULL);
+  return record->id;
+}
+
+/** Append `str` to the string data and return its offset. */
+static uint32_t
+writer_string(Writer* writer, const char* str)
+{
+  const size_t len    = strlen(str) + 1U;
+  const size_t offset = writer->n_strings;
+  if (offset + len >= UINT32_MAX) {
+    writer->error = true;
+    return 0U;
+  }
+
+  char* const strings = (char*)realloc(writer->strings, offset + len);
+  if (!strings) {
+    writer->error = true;
+    return 0U;
+  }
+
+  memcpy(strings + offset, str, len);
+  writer->strings   = strings;
+  writer->n_strings = offset + len;
+  return (uint32_t)offset;
+}
+
+static bool
+write_u32s(FILE* fd, const uint32_t* values, const size_t n)
+{
+  return fwrite(values, sizeof(uint32_t), n, fd) == n;
+}
+
+/** Add the record of every plugin and its data URIs. */
+static void
+writer_add_plugins(Writer*    writer,
+                   LilvWorld* world,
+                   uint32_t** records,
+                   uint32_t** data_uris,
+                   uint32_t*  n_data_uris)
+{
+  const LilvPlugins* const plugins   = world->plugins;
+  const size_t             n_plugins = lilv_plugins_size(plugins);
+
+  *records = (uint32_t*)calloc(n_plugins + 1U,
+                               LILV_IMAGE_PLUGIN * sizeof(uint32_t));
+
+  size_t n_uris = 0U;
+  LILV_FOREACH (plugins, i, plugins) {
+    n_uris += lilv_nodes_size(lilv_plugins_get(plugins, i)->data_uris);
+  }
+
+  *data_uris   = (uint32_t*)calloc(n_uris + 1U, sizeof(uint32_t));
+  *n_data_uris = 0U;
+  if (!*records || !*data_uris) {
+    writer->error = true;
+    return;
+  }
+
+  uint32_t* record = *records;
+  LILV_FOREACH (plugins, i, plugins) {
+    const LilvPlugin* const plugin = lilv_plugins_get(plugins, i);
+
+    record[0] = writer_node_id(writer, plugin->plugin_uri->node);
+    record[1] = writer_node_id(writer, plugin->bundle_uri->node);
+    record[2] = *n_data_uris;
+    record[3] = (uint32_t)lilv_nodes_size(plugin->data_uris);
+    record[4] = plugin->parse_errors ? LILV_IMAGE_PARSE_ERRORS : 0U;
+
+    LILV_FOREACH (nodes, d, plugin->data_uris) {
+      const LilvNode* const data_uri = lilv_nodes_get(plugin->data_uris, d);
+
+      (*data_uris)[(*n_data_uris)++] = writer_node_id(writer, data_uri->node);
+    }
+
+    record += LILV_IMAGE_PLUGIN;
+  }
+}
+
+/** Add the record of every plugin class. */
+static uint32_t*
+writer_add_classes(Writer* writer, LilvWorld* world)
+{
+  const LilvPluginClasses* const classes   = world->plugin_classes;
+  const size_t                   n_classes = lilv_plugin_classes_size(classes);
+
+  uint32_t* const records = (uint32_t*)calloc(
+    n_classes + 1U, LILV_IMAGE_CLASS * sizeof(uint32_t));
+  if (!records) {
+    writer->error = true;
+    return NULL;
+  }
+
+  uint32_t* record = records;
+  LILV_FOREACH (plugin_classes, i, classes) {
+    const LilvPluginClass* const pclass =
+      lilv_plugin_classes_get(classes, i);
+
+    record[0] = writer_node_id(writer, pclass->uri->node);
+    record[1] = pclass->parent_uri
+                  ? writer_node_id(writer, pclass->parent_uri->node)
+                  : 0U;
+    record[2] = writer_string(writer, lilv_node_as_string(pclass->label));
+    record += LILV_IMAGE_CLASS;
+  }
+
+  return records;
+}
+
+/** Make the record of every node in the store and every extra node. */
+static uint32_t*
+writer_add_nodes(Writer* writer)
+{
+  // Add any datatypes that aren't in the store (which have no datatypes)
+  const uint32_t n_nodes = writer->tables.n_nodes + writer->n_extras;
+  for (uint32_t id = 1U; id < n_nodes; ++id) {
+    writer_node_id(writer, sord_node_get_datatype(writer_node(writer, id)));
+  }
+
+  const uint32_t  n_all   = writer->tables.n_nodes + writer->n_extras;
+  uint32_t* const records = (uint32_t*)calloc(
+    n_all, LILV_IMAGE_NODE * sizeof(uint32_t));
+  if (!records) {
+    writer->error = true;
+    return NULL;
+  }
+
+  for (uint32_t id = 1U; id < n_all; ++id) {
+    const SordNode* const node     = writer_node(writer, id);
+    const SordNode* const datatype = sord_node_get_datatype(node);
+    const char* const     lang     = sord_node_get_language(node);
+    uint32_t* const       record   = &records[id * LILV_IMAGE_NODE];
+
+    record[0] = (uint32_t)sord_node_get_type(node);
+    record[1] = writer_node_id(writer, datatype);
+    record[2] = writer_string(writer, (const char*)sord_node_get_string(node));
+    record[3] = lang ? writer_string(writer, lang) + 1U : 0U;
+  }
+
+  return records;
+}
+
+int
+lilv_image_write(LilvWorld* world, const char* path)
+{
+  // Use the store of a compact world, or make a temporary one
+  LilvStore* const tmp_store =
+    world->store ? NULL : lilv_store_new(world->world, world->model);
+
+  Writer writer;
+  memset(&writer, 0, sizeof(writer));
+  writer.store = world->store ? world->store : tmp_store;
+  writer.index =
+    zix_tree_new(NULL, false, extra_node_cmp, NULL, extra_node_free, NULL);
+  if (!writer.store || !writer.index) {
+    LILV_ERRORF("Failed to make image of world for `%s'\n", path);
+    zix_tree_free(writer.index);
+    lilv_store_free(world->world, tmp_store);
+    return 1;
+  }
+
+  lilv_store_get_tables(writer.store, &writer.tables);
+
+  uint32_t* plugins     = NULL;
+  uint32_t* data_uris   = NULL;
+  uint32_t  n_data_uris = 0U;
+  writer_add_plugins(&writer, world, &plugins, &data_uris, &n_data_uris);
+
+  uint32_t* const classes = writer_add_classes(&writer, world);
+  uint32_t* const nodes   = writer_add_nodes(&writer);
+
+  const LilvStoreTables* const t = &writer.tables;
+
+  const LilvImageHeader header = {
+    {'L', 'I', 'L', 'V', 'I', 'M', 'A', 'G'},
+    LILV_IMAGE_VERSION,
+    LILV_IMAGE_BOM,
+    t->n_nodes + writer.n_extras,
+    t->n_nodes,
+    t->n_quads,
+    (uint32_t)lilv_plugins_size(world->plugins),
+    n_data_uris,
+    (uint32_t)lilv_plugin_classes_size(world->plugin_classes),
+    (uint32_t)writer.n_strings};
+
+  // Write to a temporary file, so processes never see a partial image
+  char* const tmp_path = lilv_strjoin(path, ".tmp", NULL);
+  FILE* const fd       = writer.error ? NULL : fopen(tmp_path, "wb");
+  bool        ok       = false;
+  if (fd) {
+    const size_t n_node_values   = LILV_IMAGE_NODE * (size_t)header.n_nodes;
+    const size_t n_row_values    = LILV_IMAGE_ROW * (size_t)t->n_quads;
+    const size_t n_plugin_values = LILV_IMAGE_PLUGIN * (size_t)header.n_plugins;
+    const size_t n_class_values  = LILV_IMAGE_CLASS * (size_t)header.n_classes;
+
+    ok = fwrite(&header, sizeof(header), 1, fd) == 1 &&
+         write_u32s(fd, nodes, n_node_values) &&
+         write_u32s(fd, t->spo, n_row_values) &&
+         write_u32s(fd, t->ops, n_row_values) &&
+         write_u32s(fd, t->subjects, t->n_nodes + 1U) &&
+         write_u32s(fd, t->objects, t->n_nodes + 1U) &&
+         write_u32s(fd, plugins, n_plugin_values) &&
+         write_u32s(fd, data_uris, n_data_uris) &&
+         write_u32s(fd, classes, n_class_values) &&
+         (!writer.n_strings ||
+          fwrite(writer.strings, 1, writer.n_strings, fd) == writer.n_strings);
+
+    ok = !fclose(fd) && ok;
+#ifdef _WIN32
+    if (ok) {
+      remove(path); // rename() does not replace existing files
+    }
+#endif
+    ok = ok && !rename(tmp_path, path);
+  }
+
+  if (!ok) {
+    LILV_ERRORF("Failed to write world image `%s'\n", path);
+    remove(tmp_path);
+  }
+
+  free(tmp_path);
+  free(nodes);
+  free(classes);
+  free(data_uris);
+  free(plugins);
+  free(writer.strings);
+  free(writer.extras);
+  zix_tree_free(writer.index);
+  lilv_store_free(world->world, tmp_store);
+  return ok ? 0 : 1;
+}
+
+/*
+ * Reading
+ */
+
+/** Return true if `id` is the ID of a URI in the node table. */
+static bool
+image_is_uri(const LilvImage* image, const uint32_t id)
+{
+  return id && id < image->header->n_nodes &&
+         image->nodes[id * LILV_IMAGE_NODE] == SORD_URI;
+}
+
+/** Return true if every offset is in order and within the rows. */
+static bool
+image_check_offsets(const uint32_t* offsets, uint32_t n_nodes, uint32_t n_rows)
+{
+  if (offsets[0]) {
+    return false;
+  }
+
+  for (uint32_t n = 0U; n < n_nodes; ++n) {
+    if (offsets[n + 1U] < offsets[n]) {
+      return false;
+    }
+  }
+
+  return offsets[n_nodes] == n_rows;
+}
+
+/** Return true if every row only refers to nodes in the store. */
+static bool
+image_check_rows(const uint32_t* rows, uint32_t n_rows, uint32_t n_nodes)
+{
+  for (size_t r = 0U; r < (size_t)n_rows * LILV_IMAGE_ROW; ++r) {
+    if (rows[r] >= n_nodes || (!rows[r] && r % LILV_IMAGE_ROW != 3U)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/** Return true if everything in the image refers to something in it. */
+static bool
+image_check(const LilvImage* image)
+{
+  const LilvImageHeader* const header = image->header;
+  if (header->n_strings && image->strings[header->n_strings - 1U]) {
+    return false; // Strings aren't terminated
+  }
+
+  for (uint32_t id = 1U; id < header->n_nodes; ++id) {
+    const uint32_t* const node    = &image->nodes[id * LILV_IMAGE_NODE];
+    const bool            literal = node[0] == SORD_LITERAL;
+    if ((node[0] != SORD_URI && node[0] != SORD_BLANK && !literal) ||
+        (node[1] && (!literal || !image_is_uri(image, node[1]))) ||
+        node[2] >= header->n_strings || node[3] > header->n_strings) {
+      return false;
+    }
+  }
+
+  const LilvStoreTables* const store = &image->store;
+  if (!header->n_store_nodes || header->n_store_nodes > header->n_nodes ||
+      !image_check_offsets(store->subjects, store->n_nodes, store->n_quads) ||
+      !image_check_offsets(store->objects, store->n_nodes, store->n_quads) ||
+      !image_check_rows(store->spo, store->n_quads, store->n_nodes) ||
+      !image_check_rows(store->ops, store->n_quads, store->n_nodes)) {
+    return false;
+  }
+
+  for (uint32_t p = 0U; p < header->n_plugins; ++p) {
+    const uint32_t* const plugin = &image->plugins[p * LILV_IMAGE_PLUGIN];
+    if (!image_is_uri(image, plugin[0]) || !image_is_uri(image, plugin[1]) ||
+        plugin[2] > header->n_data_uris ||
+        plugin[3] > header->n_data_uris - plugin[2]) {
+      return false;
+    }
+  }
+
+  for (uint32_t d = 0U; d < header->n_data_uris; ++d) {
+    if (!image_is_uri(image, image->data_uris[d])) {
+      return false;
+    }
+  }
+
+  for (uint32_t c = 0U; c < header->n_classes; ++c) {
+    const uint32_t* const pclass = &image->classes[c * LILV_IMAGE_CLASS];
+    if (!image_is_uri(image, pclass[0]) ||
+        (pclass[1] && !image_is_uri(image, pclass[1])) ||
+        pclass[2] >= header->n_strings) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/** Set the section pointers of an image, if its size matches its header. */
+static bool
+image_index(LilvImage* image)
+{
+  const LilvImageHeader* const header = (const LilvImageHeader*)image->data;
+  if (image->size < sizeof(LilvImageHeader) ||
+      memcmp(header->magic, LILV_IMAGE_MAGIC, sizeof(header->magic)) ||
+      header->version != LILV_IMAGE_VERSION || header->bom != LILV_IMAGE_BOM) {
+    return false;
+  }
+
+  // Calculate the size in 64 bits, which can't overflow
+  const uint64_t n_values =
+    (LILV_IMAGE_NODE * (uint64_t)header->n_nodes) +
+    (2U * LILV_IMAGE_ROW * (uint64_t)header->n_quads) +
+    (2U * ((uint64_t)header->n_store_nodes + 1U)) +
+    (LILV_IMAGE_PLUGIN * (uint64_t)header->n_plugins) +
+    (uint64_t)header->n_data_uris +
+    (LILV_IMAGE_CLASS * (uint64_t)header->n_classes);
+
+  const uint64_t size = sizeof(LilvImageHeader) +
+                        (n_values * sizeof(uint32_t)) + header->n_strings;
+  if ((uint64_t)image->size != size) {
+    return false;
+  }
+
+  const uint32_t* values = (const uint32_t*)(header + 1);
+  const size_t    n_rows = (size_t)header->n_quads * LILV_IMAGE_ROW;
+
+  image->header = header;
+  image->nodes  = values;
+  values += LILV_IMAGE_NODE * (size_t)header->n_nodes;
+
+  image->store.nodes   = NULL;
+  image->store.n_nodes = header->n_store_nodes;
+  image->store.n_quads = header->n_quads;
+  image->store.spo     = values;
+  values += n_rows;
+  image->store.ops = values;
+  values += n_rows;
+  image->store.subjects = values;
+  values += header->n_store_nodes + 1U;
+  image->store.objects = values;
+  values += header->n_store_nodes + 1U;
+
+  image->plugins = values;
+  values += LILV_IMAGE_PLUGIN * (size_t)header->n_plugins;
+  image->data_uris = values;
+  values += header->n_data_uris;
+  image->classes = values;
+  values += LILV_IMAGE_CLASS * (size_t)header->n_classes;
+  image->strings = (const char*)values;
+
+  return image_check(image);
+}
+
+/** Read a whole file into memory, for systems without mmap(). */
+static bool
+image_read(LilvImage* image, const char* path)
+{
+  FILE* const fd = fopen(path, "rb");
+  if (!fd) {
+    return false;
+  }
+
+  fseek(fd, 0, SEEK_END);
+  const long size = ftell(fd);
+  fseek(fd, 0, SEEK_SET);
+  if (size <= 0) {
+    fclose(fd);
+    return false;
+  }
+
+  image->data = malloc((size_t)size);
+  image->size = (size_t)size;
+  if (!image->data || fread(image->data, 1, image->size, fd) != image->size) {
+    free(image->data);
+    image->data = NULL;
+    fclose(fd);
+    return false;
+  }
+
+  fclose(fd);
+  return true;
+}
+
+LilvImage*
+lilv_image_open(const char* path)
+{
+  LilvImage* const image = (LilvImage*)calloc(1, sizeof(LilvImage));
+  if (!image) {
+    return NULL;
+  }
+
+#if USE_MMAP
+  // Map the file read-only and shared, so processes share the same pages
+  struct stat st;
+  const int   fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+      void* const map =
+        mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (map != MAP_FAILED) {
+        image->data   = map;
+        image->size   = (size_t)st.st_size;
+        image->mapped = true;
+      }
+    }
+
+    close(fd); // The mapping holds its own reference to the file
+  }
+#endif
+
+  if (!image->data && !image_read(image, path)) {
+    LILV_ERRORF("Failed to read world image `%s'\n", path);
+    free(image);
+    return NULL;
+  }
+
+  if (!image_index(image)) {
+    LILV_ERRORF("Invalid world image `%s'\n", path);
+    lilv_image_free(image);
+    return NULL;
+  }
+
+  return image;
+}
+
+void
+lilv_image_free(LilvImage* image)
+{
+  if (!image) {
+    return;
+  }
+
+#if USE_MMAP
+  if (image->mapped) {
+    munmap(image->data, image->size);
+  } else {
+    free(image->data);
+  }
+#else
+  free(image->data);
+#endif
+
+  free(image);
+}
+
+/** Make the node with the given ID, and any datatype it has first. */
+static SordNode*
+image_new_node(const LilvImage* image,
+               SordWorld*       world,
+               SordNode* const* nodes,
+               const uint32_t   id)
+{
+  const uint32_t* const record = &image->nodes[id * LILV_IMAGE_NODE];
+  const uint8_t* const  str    = (const uint8_t*)image->strings + record[2];
+
+  switch ((SordNodeType)record[0]) {
+  case SORD_URI:
+    return sord_new_uri(world, str);
+  case SORD_BLANK:
+    return sord_new_blank(world, str);
+  case SORD_LITERAL:
+    break;
+  }
+
+  return sord_new_literal(world,
+                          record[1] ? nodes[record[1]] : NULL,
+                          str,
+                          record[3] ? image->strings + record[3] - 1U : NULL);
+}
+
+int
+lilv_image_load(const LilvImage* image, LilvWorld* world)
+{
+  const LilvImageHeader* const header = image->header;
+
+  SordNode** const nodes =
+    (SordNode**)calloc(header->n_nodes, sizeof(SordNode*));
+  if (!nodes) {
+    return 1;
+  }
+
+  // Make every node, with literals last so their datatypes already exist
+  for (unsigned pass = 0U; pass < 2U; ++pass) {
+    for (uint32_t id = 1U; id < header->n_nodes; ++id) {
+      const bool literal =
+        image->nodes[id * LILV_IMAGE_NODE] == (uint32_t)SORD_LITERAL;
+      if (literal == (pass == 1U)) {
+        nodes[id] = image_new_node(image, world->world, nodes, id);
+      }
+    }
+  }
+
+  LilvStoreTables tables = image->store;
+  tables.nodes           = (const SordNode* const*)nodes;
+
+  world->store = lilv_store_new_from_tables(world->world, &tables);
+
+  for (uint32_t p = 0U; world->store && p < header->n_plugins; ++p) {
+    const uint32_t* const record = &image->plugins[p * LILV_IMAGE_PLUGIN];
+    LilvPlugin* const     plugin =
+      lilv_plugin_new(world,
+                      lilv_node_new_from_node(world, nodes[record[0]]),
+                      lilv_node_new_from_node(world, nodes[record[1]]));
+
+    for (uint32_t d = 0U; d < record[3]; ++d) {
+      const SordNode* const data_uri = nodes[image->data_uris[record[2] + d]];
+
+      lilv_collection_insert(plugin->data_uris,
+                             lilv_node_new_from_node(world, data_uri));
+    }
+
+    plugin->loaded       = true;
+    plugin->parse_errors = (record[4] & LILV_IMAGE_PARSE_ERRORS) != 0U;
+    if (lilv_collection_insert(world->plugins, plugin)) {
+      lilv_plugin_free(plugin); // Duplicate
+    }
+  }
+
+  for (uint32_t c = 0U; world->store && c < header->n_classes; ++c) {
+    const uint32_t* const  record = &image->classes[c * LILV_IMAGE_CLASS];
+    LilvPluginClass* const pclass =
+      lilv_plugin_class_new(world,
+                            record[1] ? nodes[record[1]] : NULL,
+                            nodes[record[0]],
+                            image->strings + record[2]);
+
+    if (lilv_collection_insert(world->plugin_classes, pclass)) {
+      lilv_plugin_class_free(pclass); // Duplicate
+    }
+  }
+
+  world->class_index_stale = true;
+
+  // The store and everything else now hold their own references
+  for (uint32_t id = 1U; id < header->n_nodes; ++id) {
+    sord_node_free(world->world, nodes[id]);
+  }
+
+  free(nodes);
+  return world->store ? 0 : 1;
+}
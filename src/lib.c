@@ -15,21 +15,13 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-LilvLib*
-lilv_lib_open(LilvWorld*                world,
+/** Open the library at `uri` that isn't open yet, or return NULL. */
+static LilvLib*
+lilv_lib_load(LilvWorld*                world,
               const LilvNode*           uri,
               const char*               bundle_path,
               const LV2_Feature* const* features)
 {
-  ZixTreeIter*  i   = NULL;
-  const LilvLib key = {
-    world, (LilvNode*)uri, (char*)bundle_path, NULL, NULL, NULL, 0};
-  if (!zix_tree_find(world->libs, &key, &i)) {
-    LilvLib* llib = (LilvLib*)zix_tree_get(i);
-    ++llib->refs;
-    return llib;
-  }
-
   const char* const lib_uri = lilv_node_as_uri(uri);
   char* const       lib_path =
     (char*)serd_file_uri_parse((const uint8_t*)lib_uri, NULL);
@@ -77,8 +69,36 @@ lilv_lib_open(LilvWorld*                world,
   llib->lv2_descriptor = df;
   llib->desc           = desc;
   llib->refs           = 1;
+  return llib;
+}
+
+LilvLib*
+lilv_lib_open(LilvWorld*                world,
+              const LilvNode*           uri,
+              const char*               bundle_path,
+              const LV2_Feature* const* features)
+{
+  ZixTreeIter*  i   = NULL;
+  const LilvLib key = {
+    world, (LilvNode*)uri, (char*)bundle_path, NULL, NULL, NULL, 0};
+
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+  if (!zix_tree_find(world->libs, &key, &i)) {
+    LilvLib* llib = (LilvLib*)zix_tree_get(i);
+    ++llib->refs;
+    lilv_world_unlock_caches(world);
+    lilv_world_unlock(world);
+    return llib;
+  }
+
+  LilvLib* const llib = lilv_lib_load(world, uri, bundle_path, features);
+  if (llib) {
+    zix_tree_insert(world->libs, llib, NULL);
+  }
 
-  zix_tree_insert(world->libs, llib, NULL);
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
   return llib;
 }
 
@@ -99,6 +119,10 @@ lilv_lib_get_plugin(LilvLib* lib, uint32_t index)
 void
 lilv_lib_close(LilvLib* lib)
 {
+  LilvWorld* const world = lib->world;
+
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
   if (--lib->refs == 0) {
     dlclose(lib->lib);
 
@@ -111,4 +135,6 @@ lilv_lib_close(LilvLib* lib)
     free(lib->bundle_path);
     free(lib);
   }
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
 }
@@ -30,4 +30,30 @@
 #  endif
 #endif
 
+// POSIX mmap() and posix_madvise(), used to read data files
+#ifndef HAVE_MMAP
+#  if defined(__APPLE__) || defined(__linux__) || defined(__unix__)
+#    define HAVE_MMAP 1
+#  endif
+#endif
+
+#if defined(HAVE_MMAP) && HAVE_MMAP
+#  define USE_MMAP 1
+#else
+#  define USE_MMAP 0
+#endif
+
+// Linux inotify, used to watch bundle directories for changes
+#ifndef HAVE_INOTIFY
+#  ifdef __linux__
+#    define HAVE_INOTIFY 1
+#  endif
+#endif
+
+#if defined(HAVE_INOTIFY) && HAVE_INOTIFY
+#  define USE_INOTIFY 1
+#else
+#  define USE_INOTIFY 0
+#endif
+
 #endif // LILV_CONFIG_H
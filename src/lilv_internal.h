@@ -17,6 +17,7 @@ extern "C" {
 #include "zix/tree.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -37,6 +38,7 @@ dlerror(void)
 }
 #else
 #  include <dlfcn.h>
+#  include <pthread.h>
 #endif
 
 #ifdef LILV_DYN_MANIFEST
@@ -49,13 +51,78 @@ dlerror(void)
  *
  */
 
-typedef void LilvCollection;
+typedef int (*LilvCompareFunc)(const void* a,
+                               const void* b,
+                               const void* user_data);
+
+typedef void (*LilvFreeFunc)(void* ptr);
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION LilvMutex;
+#else
+typedef pthread_mutex_t LilvMutex;
+#endif
+
+/** Atomically add `delta` to `*value`, and return the new value. */
+static inline unsigned
+lilv_atomic_add(unsigned* const value, const int delta)
+{
+#ifdef _WIN32
+  return (unsigned)InterlockedExchangeAdd((volatile LONG*)value, delta) +
+         (unsigned)delta;
+#else
+  return __atomic_add_fetch(value, (unsigned)delta, __ATOMIC_ACQ_REL);
+#endif
+}
+
+/** Atomically set `*value` to `desired` if it is `expected`. */
+static inline bool
+lilv_atomic_cas(unsigned* const value, unsigned expected, unsigned desired)
+{
+#ifdef _WIN32
+  return (unsigned)InterlockedCompareExchange(
+           (volatile LONG*)value, (LONG)desired, (LONG)expected) == expected;
+#else
+  return __atomic_compare_exchange_n(
+    value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/** Atomically load `*value`. */
+static inline unsigned
+lilv_atomic_load(const unsigned* const value)
+{
+#ifdef _WIN32
+  return *(const volatile unsigned*)value;
+#else
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+   A collection of pointers, stored contiguously.
+
+   Collections are usually small, and built once then iterated, so elements
+   are kept in a flat array, sorted by `cmp` if it is given, or in insertion
+   order otherwise.  Iterators point to elements in the array, so they are
+   invalidated by any modification of the collection.
+*/
+typedef struct LilvCollectionImpl {
+  LilvCompareFunc cmp;       ///< Element comparator, or NULL if unsorted
+  LilvFreeFunc    free_func; ///< Element destructor, or NULL if not owned
+  void**          elems;     ///< Array of elements
+  size_t          size;      ///< Number of elements
+  size_t          capacity;  ///< Allocated number of elements
+} LilvCollection;
 
 struct LilvPortImpl {
-  LilvNode*  node;    ///< RDF node
-  uint32_t   index;   ///< lv2:index
-  LilvNode*  symbol;  ///< lv2:symbol
-  LilvNodes* classes; ///< rdf:type
+  LilvNode*  node;        ///< RDF node
+  uint32_t   index;       ///< lv2:index
+  LilvNode*  symbol;      ///< lv2:symbol
+  LilvNodes* classes;     ///< rdf:type
+  uint32_t   flags;       ///< Well-known classes and properties
+  uint32_t   symbol_hash; ///< Hash of symbol, for lookup by symbol
+  LilvNode*  designation; ///< First lv2:designation, owned by the plugin
 };
 
 typedef struct LilvSpecImpl {
@@ -63,6 +130,7 @@ typedef struct LilvSpecImpl {
   SordNode*            bundle;
   LilvNodes*           data_uris;
   struct LilvSpecImpl* next;
+  bool                 loaded; ///< True if data files have been loaded
 } LilvSpec;
 
 /**
@@ -106,16 +174,24 @@ struct LilvPluginImpl {
   LilvNodes*             data_uris; ///< rdfs::seeAlso
   LilvPort**             ports;
   uint32_t               num_ports;
+  uint32_t*              port_symbols;   ///< Port indices by symbol hash
+  uint32_t               n_port_symbols; ///< Size of port_symbols
+  LilvPortInfo*          port_infos;     ///< Port summaries, or NULL
+  LilvDesignatedPort*    designations;   ///< Designated ports, by index
+  uint32_t               n_designations; ///< Size of designations
+  uint32_t               latency_port;   ///< Latency port index, or UINT32_MAX
+  bool                   has_latency;    ///< Any port reports latency
   bool                   loaded;
   bool                   parse_errors;
   bool                   replaced;
 };
 
 struct LilvPluginClassImpl {
-  LilvWorld* world;
-  LilvNode*  uri;
-  LilvNode*  parent_uri;
-  LilvNode*  label;
+  LilvWorld*         world;
+  LilvNode*          uri;
+  LilvNode*          parent_uri;
+  LilvNode*          label;
+  LilvPluginClasses* children; ///< Direct subclasses (not owned)
 };
 
 struct LilvInstancePimpl {
@@ -124,62 +200,218 @@ struct LilvInstancePimpl {
 };
 
 typedef struct {
-  bool  dyn_manifest;
-  bool  filter_language;
-  char* lv2_path;
+  bool     compact;
+  bool     dyn_manifest;
+  bool     filter_language;
+  bool     lazy_specs;
+  char*    lv2_path;
+  unsigned discovery_threads;
 } LilvOptions;
 
+/** Modification time and size of a file, used to detect changes. */
+typedef struct {
+  int64_t time; ///< Modification time in nanoseconds, or -1 if missing
+  int64_t size; ///< Size in bytes
+} LilvFileStamp;
+
+/** Persistent cache of parsed bundle manifests. */
+typedef struct LilvCacheImpl LilvCache;
+
+/** Parsed contents of a bundle manifest. */
+typedef struct LilvCacheEntryImpl LilvCacheEntry;
+
+/** Compact read-only copy of the statements in a model. */
+typedef struct LilvStoreImpl LilvStore;
+
+/**
+   Iterator over the statements that match a pattern in a model or store.
+
+   This is small and owned by the caller, usually on the stack, so searching
+   doesn't allocate, but it must be closed with lilv_matches_close().
+*/
+typedef struct {
+  SordIter*        iter;    ///< Model iterator, or NULL if in a store
+  const LilvStore* store;   ///< Store, or NULL if in a model
+  const uint32_t*  row;     ///< Current row in store index
+  const uint32_t*  end;     ///< End of matching range in store index
+  const unsigned*  columns; ///< Row column of each SordQuadIndex
+  uint32_t         key[3];  ///< Row values to match, or zero for anything
+} LilvMatches;
+
+/** The tables that make up a store, see lilv_store_get_tables(). */
+typedef struct {
+  const SordNode* const* nodes;    ///< Node table, with NULL first
+  const uint32_t*        spo;      ///< Rows in subject, predicate, object order
+  const uint32_t*        ops;      ///< Rows in object, predicate, subject order
+  const uint32_t*        subjects; ///< First SPO row of each node, and end
+  const uint32_t*        objects;  ///< First OPS row of each node, and end
+  uint32_t               n_nodes;  ///< Number of nodes, including NULL
+  uint32_t               n_quads;  ///< Number of statements
+} LilvStoreTables;
+
+/** World image file contents, mapped into memory. */
+typedef struct LilvImageImpl LilvImage;
+
+/** A file that belongs to a loaded bundle. */
+typedef struct {
+  char*         path;  ///< Local file path
+  LilvFileStamp stamp; ///< Stamp when the bundle was loaded
+} LilvBundleFile;
+
+typedef struct LilvVersion {
+  int minor;
+  int micro;
+} LilvVersion;
+
+/** Version of a plugin in a bundle, cached to avoid reading files again. */
+typedef struct {
+  LilvNode*   plugin_uri;
+  LilvVersion version;
+} LilvBundleVersion;
+
+/**
+   Record of a loaded bundle.
+
+   This is used to detect changes when rescanning, and to unload everything
+   that was loaded from the bundle without searching the whole world.
+
+   The first two fields match LilvHeader, so bundles are stored in a
+   collection sorted by URI.
+*/
+typedef struct {
+  LilvWorld*         world;
+  LilvNode*          uri;
+  LilvBundleFile*    files; ///< Bundle directory, manifest, and data files
+  unsigned           n_files;
+  bool               displaced;    ///< Newer plugin versions are elsewhere
+  LilvNodes*         loaded_files; ///< Loaded files within the bundle
+  LilvPlugins*       plugins;      ///< Plugins loaded from the bundle
+  LilvBundleVersion* versions;     ///< Known versions of plugins in bundle
+  unsigned           n_versions;
+} LilvBundle;
+
+/**
+   A plugin that has been replaced by another known plugin.
+
+   The first two fields match LilvHeader, so replacements are stored in a
+   collection sorted by the URI of the replaced plugin.
+*/
+typedef struct {
+  LilvWorld* world;
+  LilvNode*  uri;         ///< Replaced plugin
+  LilvNode*  replacement; ///< Plugin that replaces it
+} LilvReplacement;
+
+/**
+   The URIs used internally, as X(field, uri) entries.
+
+   Each entry is a field in the `uris` of the world, which is created with the
+   world so that common lookups never need to make nodes.  The URI expressions
+   are only expanded in world.c, which includes the headers that define them.
+*/
+#define LILV_WORLD_URIS(X)                                                     \
+  X(atom_AtomPort, LV2_ATOM__AtomPort)                                         \
+  X(atom_supports, LV2_ATOM__supports)                                         \
+  X(dc_replaces, NS_DCTERMS "replaces")                                        \
+  X(dman_DynManifest, NS_DYNMAN "DynManifest")                                 \
+  X(doap_maintainer, LILV_NS_DOAP "maintainer")                                \
+  X(doap_name, LILV_NS_DOAP "name")                                            \
+  X(ev_EventPort, LV2_EVENT__EventPort)                                        \
+  X(ev_supportsEvent, LV2_EVENT__supportsEvent)                                \
+  X(foaf_homepage, LILV_NS_FOAF "homepage")                                    \
+  X(foaf_mbox, LILV_NS_FOAF "mbox")                                            \
+  X(foaf_name, LILV_NS_FOAF "name")                                            \
+  X(lv2_AudioPort, LV2_CORE__AudioPort)                                        \
+  X(lv2_CVPort, LV2_CORE__CVPort)                                              \
+  X(lv2_ControlPort, LV2_CORE__ControlPort)                                    \
+  X(lv2_InputPort, LV2_CORE__InputPort)                                        \
+  X(lv2_OutputPort, LV2_CORE__OutputPort)                                      \
+  X(lv2_Plugin, LV2_CORE__Plugin)                                              \
+  X(lv2_Specification, LV2_CORE__Specification)                                \
+  X(lv2_appliesTo, LV2_CORE__appliesTo)                                        \
+  X(lv2_binary, LV2_CORE__binary)                                              \
+  X(lv2_connectionOptional, LV2_CORE__connectionOptional)                      \
+  X(lv2_default, LV2_CORE__default)                                            \
+  X(lv2_designation, LV2_CORE__designation)                                    \
+  X(lv2_enumeration, LV2_CORE__enumeration)                                    \
+  X(lv2_extensionData, LV2_CORE__extensionData)                                \
+  X(lv2_index, LV2_CORE__index)                                                \
+  X(lv2_integer, LV2_CORE__integer)                                            \
+  X(lv2_latency, LV2_CORE__latency)                                            \
+  X(lv2_maximum, LV2_CORE__maximum)                                            \
+  X(lv2_microVersion, LV2_CORE__microVersion)                                  \
+  X(lv2_minimum, LV2_CORE__minimum)                                            \
+  X(lv2_minorVersion, LV2_CORE__minorVersion)                                  \
+  X(lv2_name, LV2_CORE__name)                                                  \
+  X(lv2_optionalFeature, LV2_CORE__optionalFeature)                            \
+  X(lv2_port, LV2_CORE__port)                                                  \
+  X(lv2_portProperty, LV2_CORE__portProperty)                                  \
+  X(lv2_project, LV2_CORE__project)                                            \
+  X(lv2_prototype, LV2_CORE__prototype)                                        \
+  X(lv2_reportsLatency, LV2_CORE__reportsLatency)                              \
+  X(lv2_requiredFeature, LV2_CORE__requiredFeature)                            \
+  X(lv2_sampleRate, LV2_CORE__sampleRate)                                      \
+  X(lv2_scalePoint, LV2_CORE__scalePoint)                                      \
+  X(lv2_symbol, LV2_CORE__symbol)                                              \
+  X(lv2_toggled, LV2_CORE__toggled)                                            \
+  X(owl_Ontology, NS_OWL "Ontology")                                           \
+  X(pset_Preset, LV2_PRESETS__Preset)                                          \
+  X(pset_value, LV2_PRESETS__value)                                            \
+  X(rdf_a, LILV_NS_RDF "type")                                                 \
+  X(rdf_value, LILV_NS_RDF "value")                                            \
+  X(rdfs_Class, LILV_NS_RDFS "Class")                                          \
+  X(rdfs_label, LILV_NS_RDFS "label")                                          \
+  X(rdfs_seeAlso, LILV_NS_RDFS "seeAlso")                                      \
+  X(rdfs_subClassOf, LILV_NS_RDFS "subClassOf")                                \
+  X(state_state, LV2_STATE__state)                                             \
+  X(ui_binary, LV2_UI__binary)                                                 \
+  X(ui_ui, LV2_UI__ui)                                                         \
+  X(xsd_base64Binary, LILV_NS_XSD "base64Binary")                              \
+  X(xsd_boolean, LILV_NS_XSD "boolean")                                        \
+  X(xsd_decimal, LILV_NS_XSD "decimal")                                        \
+  X(xsd_double, LILV_NS_XSD "double")                                          \
+  X(xsd_integer, LILV_NS_XSD "integer")
+
+#define LILV_WORLD_URI_FIELD(field, uri) SordNode* field;
+
 struct LilvWorldImpl {
   SordWorld*         world;
   SordModel*         model;
+  LilvStore*         store; ///< Compact statements, if frozen with compact
+  LilvImage*         image; ///< Image that `store` was made from, or NULL
   SerdReader*        reader;
   unsigned           n_read_files;
+  char               blank_prefix[16]; ///< Last blank node prefix made
   LilvPluginClass*   lv2_plugin_class;
   LilvPluginClasses* plugin_classes;
   LilvSpec*          specs;
+  unsigned           n_unloaded_specs;
+  bool               classes_pending;
+  bool               class_index_stale;
   LilvPlugins*       plugins;
   LilvPlugins*       zombies;
   LilvNodes*         loaded_files;
+  LilvNodes*         orphan_files; ///< Loaded files not in a known bundle
   ZixTree*           libs;
+  LilvCollection*    bundles;
+  LilvCollection*    replacements;
+  ZixTree*           nodes; ///< Interned nodes, by key
+  LilvCache*         cache;
+  char*              lang_env;       ///< LANG that `lang` was parsed from
+  const char*        lang;           ///< Cached result of lilv_get_lang()
+  char**             langs;          ///< Every distinct `lang`, kept alive
+  size_t             n_langs;        ///< Number of elements in `langs`
+  ZixTree*           queries;        ///< Query results, or NULL if disabled
+  size_t             max_queries;    ///< Maximum number of cached results
+  unsigned           epoch;          ///< Incremented whenever the model changes
+  unsigned           queries_epoch;  ///< Epoch of cached query results
+  uint64_t           n_query_hits;   ///< Queries answered from the cache
+  uint64_t           n_query_misses; ///< Cacheable queries that were run
+  LilvMutex          mutex;          ///< Recursive lock for world contents
+  LilvMutex          caches_mutex;   ///< Recursive lock for nodes and caches
+  bool               frozen;         ///< True if the world can't be changed
   struct {
-    SordNode* dc_replaces;
-    SordNode* dman_DynManifest;
-    SordNode* doap_name;
-    SordNode* lv2_Plugin;
-    SordNode* lv2_Specification;
-    SordNode* lv2_appliesTo;
-    SordNode* lv2_binary;
-    SordNode* lv2_default;
-    SordNode* lv2_designation;
-    SordNode* lv2_extensionData;
-    SordNode* lv2_index;
-    SordNode* lv2_latency;
-    SordNode* lv2_maximum;
-    SordNode* lv2_microVersion;
-    SordNode* lv2_minimum;
-    SordNode* lv2_minorVersion;
-    SordNode* lv2_name;
-    SordNode* lv2_optionalFeature;
-    SordNode* lv2_port;
-    SordNode* lv2_portProperty;
-    SordNode* lv2_reportsLatency;
-    SordNode* lv2_requiredFeature;
-    SordNode* lv2_symbol;
-    SordNode* lv2_prototype;
-    SordNode* owl_Ontology;
-    SordNode* pset_value;
-    SordNode* rdf_a;
-    SordNode* rdf_value;
-    SordNode* rdfs_Class;
-    SordNode* rdfs_label;
-    SordNode* rdfs_seeAlso;
-    SordNode* rdfs_subClassOf;
-    SordNode* xsd_base64Binary;
-    SordNode* xsd_boolean;
-    SordNode* xsd_decimal;
-    SordNode* xsd_double;
-    SordNode* xsd_integer;
-    SordNode* null_uri;
+    LILV_WORLD_URIS(LILV_WORLD_URI_FIELD)
   } uris;
   LilvOptions opt;
 };
@@ -194,9 +426,18 @@ typedef enum {
   LILV_VALUE_BLOB
 } LilvNodeType;
 
+/**
+   A node, which is immutable and reference counted.
+
+   Nodes made from model nodes, and non-numeric nodes, are interned in the
+   world so that equal nodes share a single instance.  Numeric nodes made from
+   values are not, since their exact value may not match their string.
+*/
 struct LilvNodeImpl {
   LilvWorld*   world;
   SordNode*    node;
+  SordNode*    key;  ///< Key in world intern table, or NULL if not interned
+  unsigned     refs; ///< Number of references, changed atomically
   LilvNodeType type;
   union {
     int   int_val;
@@ -218,11 +459,6 @@ struct LilvUIImpl {
   LilvNodes* classes;
 };
 
-typedef struct LilvVersion {
-  int minor;
-  int micro;
-} LilvVersion;
-
 /*
  *
  * Functions
@@ -237,6 +473,16 @@ lilv_port_new(LilvWorld*      world,
 void
 lilv_port_free(const LilvPlugin* plugin, LilvPort* port);
 
+void
+lilv_port_load_flags(const LilvPlugin* plugin, LilvPort* port);
+
+void
+lilv_port_get_range_values(const LilvPlugin*   plugin,
+                           const LilvPort*     port,
+                           LilvPortRange*      range,
+                           LilvPortScalePoint* points,
+                           uint32_t            n_points);
+
 LilvPlugin*
 lilv_plugin_new(LilvWorld* world, LilvNode* uri, LilvNode* bundle_uri);
 
@@ -254,6 +500,9 @@ lilv_plugin_get_unique(const LilvPlugin* plugin,
                        const SordNode*   subject,
                        const SordNode*   predicate);
 
+LilvCollection*
+lilv_collection_new(LilvCompareFunc cmp, LilvFreeFunc free_func);
+
 void
 lilv_collection_free(LilvCollection* collection);
 
@@ -266,6 +515,15 @@ lilv_collection_begin(const LilvCollection* collection);
 void*
 lilv_collection_get(const LilvCollection* collection, const LilvIter* i);
 
+LilvIter*
+lilv_collection_find(const LilvCollection* collection, const void* key);
+
+int
+lilv_collection_insert(LilvCollection* collection, void* elem);
+
+void
+lilv_collection_remove(LilvCollection* collection, LilvIter* i);
+
 LilvPluginClass*
 lilv_plugin_class_new(LilvWorld*      world,
                       const SordNode* parent_node,
@@ -275,6 +533,9 @@ lilv_plugin_class_new(LilvWorld*      world,
 void
 lilv_plugin_class_free(LilvPluginClass* plugin_class);
 
+void
+lilv_plugin_class_update_index(LilvWorld* world);
+
 LilvLib*
 lilv_lib_open(LilvWorld*                world,
               const LilvNode*           uri,
@@ -302,9 +563,59 @@ lilv_plugin_classes_new(void);
 LilvUIs*
 lilv_uis_new(void);
 
+/** Return true if the world can't change, so reading it needs no lock. */
+bool
+lilv_world_is_immutable(const LilvWorld* world);
+
+/**
+   Lock the world, which may be done recursively by the same thread.
+
+   This does nothing for a frozen and compact world, which can't change.
+   Since lilv_world_freeze() can't run while another thread uses the world,
+   whether this locks never changes between it and lilv_world_unlock().
+*/
+void
+lilv_world_lock(const LilvWorld* world);
+
+/** Unlock the world after a call to lilv_world_lock(). */
+void
+lilv_world_unlock(const LilvWorld* world);
+
+/**
+   Lock the node table and caches, which may be done recursively.
+
+   Nodes, the query cache, libraries, and lazily loaded plugin data change
+   even in a frozen world, so this is always needed to change them.  If the
+   world is also locked, it must be locked first.
+*/
+void
+lilv_world_lock_caches(const LilvWorld* world);
+
+/** Unlock the caches after a call to lilv_world_lock_caches(). */
+void
+lilv_world_unlock_caches(const LilvWorld* world);
+
 LilvNode*
 lilv_world_get_manifest_uri(LilvWorld* world, const LilvNode* bundle_uri);
 
+const char*
+lilv_world_get_lv2_path(const LilvWorld* world);
+
+void
+lilv_world_load_specs_for(LilvWorld* world, const SordNode* node);
+
+void
+lilv_world_load_classes_if_necessary(LilvWorld* world);
+
+const LilvPluginClass*
+lilv_world_get_plugin_class_by_uri(LilvWorld* world, const LilvNode* uri);
+
+void
+lilv_for_each_path_dir(const char* lv2_path,
+                       void*       data,
+                       void (*f)(const char* dir, void* data));
+
+/** Return a new blank node prefix, which is valid until the next call. */
 const uint8_t*
 lilv_world_blank_node_prefix(LilvWorld* world);
 
@@ -314,6 +625,166 @@ lilv_world_load_file(LilvWorld* world, SerdReader* reader, const LilvNode* uri);
 SerdStatus
 lilv_world_load_graph(LilvWorld* world, SordNode* graph, const LilvNode* uri);
 
+/** Create a cache, which is only kept in memory if `path` is NULL. */
+LilvCache*
+lilv_cache_new(const char* path);
+
+void
+lilv_cache_free(LilvCache* cache);
+
+/**
+   Replay the cached manifest of `bundle` into the world model.
+
+   @return Zero on success, or non-zero if the bundle is not cached or any of
+   its files have changed since it was.
+*/
+int
+lilv_cache_replay(LilvCache* cache, LilvWorld* world, SordNode* bundle);
+
+/**
+   Store the current contents of the `bundle` graph in the cache.
+
+   This does nothing for a cache without a path, since it would never be saved.
+*/
+void
+lilv_cache_update(LilvCache*      cache,
+                  LilvWorld*      world,
+                  const SordNode* bundle,
+                  const char*     manifest_path,
+                  LilvFileStamp   manifest_stamp);
+
+/**
+   Parse a manifest into a new cache entry.
+
+   This only uses serd, so it can be called from any thread.
+
+   @return The parsed entry, or NULL if the manifest could not be parsed.
+*/
+LilvCacheEntry*
+lilv_cache_parse(const char* bundle_uri,
+                 const char* manifest_uri,
+                 const char* manifest_path);
+
+/** Return true if the entry for `bundle_uri` exists and is up to date. */
+bool
+lilv_cache_is_fresh(const LilvCache* cache, const char* bundle_uri);
+
+/** Add `entry` to the cache, replacing any existing entry for its bundle. */
+void
+lilv_cache_insert(LilvCache* cache, LilvCacheEntry* entry);
+
+/**
+   Write the cache to disk if it has changed.
+
+   @param prune If true, drop any entries that have not been used since the
+   cache was opened.
+*/
+int
+lilv_cache_save(LilvCache* cache, bool prune);
+
+/**
+   Write an image of a frozen world to a file.
+
+   @return Zero on success, or non-zero on error.
+*/
+int
+lilv_image_write(LilvWorld* world, const char* path);
+
+/**
+   Map an image file into memory and check that it is valid.
+
+   @return The image, or NULL if the file could not be read or is invalid.
+*/
+LilvImage*
+lilv_image_open(const char* path);
+
+void
+lilv_image_free(LilvImage* image);
+
+/**
+   Add the statements, plugins, and plugin classes in an image to a new world.
+
+   The world's store borrows from the image, so the image must outlive it.
+
+   @return Zero on success, or non-zero on error.
+*/
+int
+lilv_image_load(const LilvImage* image, LilvWorld* world);
+
+/**
+   Make a compact copy of every statement in `model`.
+
+   The store references every node in the model, so the model can be freed
+   afterwards.
+
+   @return The new store, or NULL on error.
+*/
+LilvStore*
+lilv_store_new(SordWorld* world, SordModel* model);
+
+/**
+   Make a store from the tables of another, like one written to an image.
+
+   The store references every node in the node table, but only borrows the
+   rows and offsets, which must outlive it.
+
+   @return The new store, or NULL on error.
+*/
+LilvStore*
+lilv_store_new_from_tables(SordWorld* world, const LilvStoreTables* tables);
+
+void
+lilv_store_free(SordWorld* world, LilvStore* store);
+
+size_t
+lilv_store_num_quads(const LilvStore* store);
+
+/** Get the tables of a store, which are valid until it is freed. */
+void
+lilv_store_get_tables(const LilvStore* store, LilvStoreTables* tables);
+
+/** Return the ID of a node, or zero if it isn't in the store. */
+uint32_t
+lilv_store_find_id(const LilvStore* store, const SordNode* node);
+
+/** Set `matches` to the statements in a store that match a pattern. */
+LilvMatches*
+lilv_store_search(const LilvStore* store,
+                  const SordNode*  subject,
+                  const SordNode*  predicate,
+                  const SordNode*  object,
+                  LilvMatches*     matches);
+
+bool
+lilv_store_ask(const LilvStore* store,
+               const SordNode*  subject,
+               const SordNode*  predicate,
+               const SordNode*  object);
+
+/** Set `matches` to a model iterator, which is freed when it is closed. */
+LilvMatches*
+lilv_matches_init(LilvMatches* matches, SordIter* iter);
+
+bool
+lilv_matches_end(const LilvMatches* matches);
+
+bool
+lilv_matches_next(LilvMatches* matches);
+
+const SordNode*
+lilv_matches_get_node(const LilvMatches* matches, SordQuadIndex index);
+
+void
+lilv_matches_get(const LilvMatches* matches, SordQuad quad);
+
+/** Write every remaining statement and close `matches`. */
+void
+lilv_matches_write(LilvMatches* matches, SerdWriter* writer);
+
+/** Free the resources used by `matches`, but not `matches` itself. */
+void
+lilv_matches_close(LilvMatches* matches);
+
 LilvUI*
 lilv_ui_new(LilvWorld* world,
             LilvNode*  uri,
@@ -329,6 +800,30 @@ lilv_node_new(LilvWorld* world, LilvNodeType type, const char* str);
 LilvNode*
 lilv_node_new_from_node(LilvWorld* world, const SordNode* node);
 
+/**
+   Initialise `view` as a node with no references for the model node `node`.
+
+   Unlike lilv_node_view(), this never returns an interned node, so the result
+   stays valid for as long as `view` and the model node do.
+*/
+const LilvNode*
+lilv_node_init_view(LilvWorld* world, const SordNode* node, LilvNode* view);
+
+/**
+   Return a borrowed node for the model node `node` without allocating.
+
+   This is the interned node if there is one and the world lock is held,
+   otherwise `view` is initialised as a node with no references that is only
+   valid while `view` is.  Nothing keeps an interned node alive without the
+   lock, so an immutable world always uses `view`.
+*/
+const LilvNode*
+lilv_node_view(LilvWorld* world, const SordNode* node, LilvNode* view);
+
+/** Return the value of a numeric literal model node, or NaN. */
+float
+lilv_literal_as_float(const LilvWorld* world, const SordNode* node);
+
 int
 lilv_header_compare_by_uri(const void* a, const void* b, const void* user_data);
 
@@ -341,6 +836,9 @@ lilv_ptr_cmp(const void* a, const void* b, const void* user_data);
 int
 lilv_resource_node_cmp(const void* a, const void* b, const void* user_data);
 
+int
+lilv_node_key_cmp(const void* a, const void* b, const void* user_data);
+
 static inline int
 lilv_version_cmp(const LilvVersion* a, const LilvVersion* b)
 {
@@ -355,8 +853,13 @@ lilv_version_cmp(const LilvVersion* a, const LilvVersion* b)
   return 1;
 }
 
+LilvIter*
+lilv_collection_find_by_uri(const LilvCollection* collection,
+                            const LilvNode*       uri);
+
 struct LilvHeader*
-lilv_collection_get_by_uri(const ZixTree* seq, const LilvNode* uri);
+lilv_collection_get_by_uri(const LilvCollection* collection,
+                           const LilvNode*       uri);
 
 LilvScalePoint*
 lilv_scale_point_new(LilvNode* value, LilvNode* label);
@@ -364,11 +867,13 @@ lilv_scale_point_new(LilvNode* value, LilvNode* label);
 void
 lilv_scale_point_free(LilvScalePoint* point);
 
-SordIter*
+/** Set `matches` to the statements that match a pattern, and return it. */
+LilvMatches*
 lilv_world_query_internal(LilvWorld*      world,
                           const SordNode* subject,
                           const SordNode* predicate,
-                          const SordNode* object);
+                          const SordNode* object,
+                          LilvMatches*    matches);
 
 bool
 lilv_world_ask_internal(LilvWorld*      world,
@@ -376,12 +881,39 @@ lilv_world_ask_internal(LilvWorld*      world,
                         const SordNode* predicate,
                         const SordNode* object);
 
+/**
+   Return the missing node of the first statement that matches a pattern.
+
+   Exactly one of `subject`, `predicate`, or `object` must be NULL.  The
+   returned node is borrowed from the model, or NULL if nothing matches.
+*/
+const SordNode*
+lilv_world_get_internal(LilvWorld*      world,
+                        const SordNode* subject,
+                        const SordNode* predicate,
+                        const SordNode* object);
+
 LilvNodes*
 lilv_world_find_nodes_internal(LilvWorld*      world,
                                const SordNode* subject,
                                const SordNode* predicate,
                                const SordNode* object);
 
+/**
+   Call `func` with borrowed nodes for every statement matching a pattern.
+
+   If `translate` is true, then only the objects in the best language are
+   visited, like with lilv_nodes_from_stream_objects().
+*/
+unsigned
+lilv_world_foreach_internal(LilvWorld*      world,
+                            const SordNode* subject,
+                            const SordNode* predicate,
+                            const SordNode* object,
+                            bool            translate,
+                            LilvMatchFunc   func,
+                            void*           data);
+
 SordModel*
 lilv_world_filter_model(LilvWorld*      world,
                         SordModel*      model,
@@ -392,11 +924,56 @@ lilv_world_filter_model(LilvWorld*      world,
 
 #define FOREACH_MATCH(iter) for (; !sord_iter_end(iter); sord_iter_next(iter))
 
+#define FOREACH_MATCHES(matches)                                               \
+  for (; !lilv_matches_end(matches); lilv_matches_next(matches))
+
 LilvNodes*
 lilv_nodes_from_stream_objects(LilvWorld*    world,
-                               SordIter*     stream,
+                               LilvMatches*  stream,
                                SordQuadIndex field);
 
+/** Return the value of a property in the best available language, or NULL. */
+const SordNode*
+lilv_world_get_translated(LilvWorld*      world,
+                          const SordNode* subject,
+                          const SordNode* predicate);
+
+/** The kind of a public query, which determines the type of its result. */
+typedef enum {
+  LILV_QUERY_FIND, ///< lilv_world_find_nodes()
+  LILV_QUERY_GET,  ///< lilv_world_get()
+  LILV_QUERY_ASK,  ///< lilv_world_ask()
+} LilvQueryKind;
+
+/** A query pattern, and its result if it has been run. */
+typedef struct {
+  LilvQueryKind   kind;
+  const SordNode* subject;   ///< Subject, or NULL
+  const SordNode* predicate; ///< Predicate, or NULL
+  const SordNode* object;    ///< Object, or NULL
+  LilvNodes*      nodes;     ///< Result of lilv_world_find_nodes()
+  LilvNode*       node;      ///< Result of lilv_world_get()
+  bool            found;     ///< Result of lilv_world_ask()
+} LilvQueryResult;
+
+/// Number of query results cached if #LILV_OPTION_QUERY_CACHE is just true
+#define LILV_DEFAULT_MAX_QUERIES 4096U
+
+ZixTree*
+lilv_query_cache_new(LilvWorld* world);
+
+/**
+   Set the result of `query` to a new copy of the cached one if possible.
+
+   @return True if the result was found in the query cache.
+*/
+bool
+lilv_world_find_query(LilvWorld* world, LilvQueryResult* query);
+
+/** Store a copy of the result of `query` in the query cache, if enabled. */
+void
+lilv_world_add_query(LilvWorld* world, const LilvQueryResult* query);
+
 char*
 lilv_strjoin(const char* first, ...);
 
@@ -406,12 +983,21 @@ lilv_strdup(const char* str);
 char*
 lilv_get_lang(void);
 
+const char*
+lilv_world_get_lang(LilvWorld* world);
+
 char*
 lilv_expand(const char* path);
 
 char*
 lilv_get_latest_copy(const char* path, const char* copy_path);
 
+LilvFileStamp
+lilv_file_stamp(const char* path);
+
+SerdStatus
+lilv_reader_read_file(SerdReader* reader, const uint8_t* uri);
+
 char*
 lilv_find_free_path(const char* in_path,
                     bool (*exists)(const char*, const void*),
@@ -10,6 +10,7 @@
 #include "zix/filesystem.h"
 #include "zix/path.h"
 #include "zix/string_view.h"
+#include "zix/tree.h"
 
 #include <math.h>
 #include <stdbool.h>
@@ -41,53 +42,208 @@ lilv_node_set_numerics_from_string(LilvNode* val)
   }
 }
 
+float
+lilv_literal_as_float(const LilvWorld* world, const SordNode* node)
+{
+  if (!node || sord_node_get_type(node) != SORD_LITERAL) {
+    return NAN;
+  }
+
+  const SordNode* const datatype = sord_node_get_datatype(node);
+  const char* const     str      = (const char*)sord_node_get_string(node);
+  if (datatype == world->uris.xsd_integer) {
+    return (float)strtol(str, NULL, 10);
+  }
+
+  if (datatype == world->uris.xsd_decimal ||
+      datatype == world->uris.xsd_double) {
+    return (float)serd_strtod(str, NULL);
+  }
+
+  return NAN;
+}
+
+/** Return the node interned as `key` without a new reference, or NULL. */
+static LilvNode*
+lilv_node_lookup(const LilvWorld* world, const SordNode* key)
+{
+  LilvNode pattern;
+  pattern.key = (SordNode*)key;
+
+  ZixTreeIter* i = NULL;
+  if (zix_tree_find((const ZixTree*)world->nodes, &pattern, &i)) {
+    return NULL;
+  }
+
+  return (LilvNode*)zix_tree_get(i);
+}
+
+/** Return a new reference to the node interned as `key`, or NULL. */
+static LilvNode*
+lilv_node_find_interned(LilvWorld* world, const SordNode* key)
+{
+  LilvNode* const result = lilv_node_lookup(world, key);
+  if (result) {
+    lilv_atomic_add(&result->refs, 1);
+  }
+
+  return result;
+}
+
+/** Intern `val` as `key`, so equal nodes share it. */
+static void
+lilv_node_intern(LilvNode* val, const SordNode* key)
+{
+  val->key = sord_node_copy(key);
+  zix_tree_insert((ZixTree*)val->world->nodes, val, NULL);
+}
+
+/**
+   Return a node of `type` that takes ownership of `node`.
+
+   Non-numeric nodes are interned, so if an equal node exists, a new reference
+   to it is returned instead.
+*/
+static LilvNode*
+lilv_node_wrap(LilvWorld* world, LilvNodeType type, SordNode* node)
+{
+  const bool numeric = type == LILV_VALUE_INT || type == LILV_VALUE_FLOAT ||
+                       type == LILV_VALUE_BOOL;
+
+  LilvNode* val = numeric ? NULL : lilv_node_find_interned(world, node);
+  if (val) {
+    sord_node_free(world->world, node);
+    return val;
+  }
+
+  val        = (LilvNode*)malloc(sizeof(LilvNode));
+  val->world = world;
+  val->node  = node;
+  val->key   = NULL;
+  val->refs  = 1U;
+  val->type  = type;
+  if (!numeric) {
+    lilv_node_intern(val, node);
+  }
+
+  return val;
+}
+
 /** Note that if `type` is numeric or boolean, the returned value is corrupt
  * until lilv_node_set_numerics_from_string is called.  It is not
  * automatically called from here to avoid overhead and imprecision when the
- * exact string value is known.
+ * exact string value is known.  Such nodes are not interned.
  */
 LilvNode*
 lilv_node_new(LilvWorld* world, LilvNodeType type, const char* str)
 {
-  LilvNode* val = (LilvNode*)malloc(sizeof(LilvNode));
-  val->world    = world;
-  val->type     = type;
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
 
+  SordNode*      node = NULL;
   const uint8_t* ustr = (const uint8_t*)str;
   switch (type) {
   case LILV_VALUE_URI:
-    val->node = sord_new_uri(world->world, ustr);
+    node = sord_new_uri(world->world, ustr);
     break;
   case LILV_VALUE_BLANK:
-    val->node = sord_new_blank(world->world, ustr);
+    node = sord_new_blank(world->world, ustr);
     break;
   case LILV_VALUE_STRING:
-    val->node = sord_new_literal(world->world, NULL, ustr, NULL);
+    node = sord_new_literal(world->world, NULL, ustr, NULL);
     break;
   case LILV_VALUE_INT:
-    val->node =
-      sord_new_literal(world->world, world->uris.xsd_integer, ustr, NULL);
+    node = sord_new_literal(world->world, world->uris.xsd_integer, ustr, NULL);
     break;
   case LILV_VALUE_FLOAT:
-    val->node =
-      sord_new_literal(world->world, world->uris.xsd_decimal, ustr, NULL);
+    node = sord_new_literal(world->world, world->uris.xsd_decimal, ustr, NULL);
     break;
   case LILV_VALUE_BOOL:
-    val->node =
-      sord_new_literal(world->world, world->uris.xsd_boolean, ustr, NULL);
+    node = sord_new_literal(world->world, world->uris.xsd_boolean, ustr, NULL);
     break;
   case LILV_VALUE_BLOB:
-    val->node =
+    node =
       sord_new_literal(world->world, world->uris.xsd_base64Binary, ustr, NULL);
     break;
   }
 
-  if (!val->node) {
-    free(val);
+  LilvNode* const result = node ? lilv_node_wrap(world, type, node) : NULL;
+
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
+  return result;
+}
+
+/** Return the type of a LilvNode for the model node `node`. */
+static LilvNodeType
+lilv_node_type_of(const LilvWorld* world, const SordNode* node)
+{
+  switch (sord_node_get_type(node)) {
+  case SORD_URI:
+    return LILV_VALUE_URI;
+  case SORD_BLANK:
+    return LILV_VALUE_BLANK;
+  case SORD_LITERAL:
+    break;
+  }
+
+  const SordNode* const datatype = sord_node_get_datatype(node);
+  if (!datatype) {
+    return LILV_VALUE_STRING;
+  }
+
+  if (datatype == world->uris.xsd_boolean) {
+    return LILV_VALUE_BOOL;
+  }
+
+  if (datatype == world->uris.xsd_decimal ||
+      datatype == world->uris.xsd_double) {
+    return LILV_VALUE_FLOAT;
+  }
+
+  if (datatype == world->uris.xsd_integer) {
+    return LILV_VALUE_INT;
+  }
+
+  return datatype == world->uris.xsd_base64Binary ? LILV_VALUE_BLOB
+                                                  : LILV_VALUE_STRING;
+}
+
+const LilvNode*
+lilv_node_init_view(LilvWorld* world, const SordNode* node, LilvNode* view)
+{
+  if (!node) {
     return NULL;
   }
 
-  return val;
+  view->world = world;
+  view->node  = (SordNode*)node;
+  view->key   = NULL;
+  view->refs  = 0U;
+  view->type  = lilv_node_type_of(world, node);
+  lilv_node_set_numerics_from_string(view);
+  return view;
+}
+
+const LilvNode*
+lilv_node_view(LilvWorld* world, const SordNode* node, LilvNode* view)
+{
+  if (!node) {
+    return NULL;
+  }
+
+  // Use the interned node if there is one, without taking a reference, which
+  // is only safe if the world lock stops other threads from freeing it
+  if (!lilv_world_is_immutable(world)) {
+    lilv_world_lock_caches(world);
+    const LilvNode* const interned = lilv_node_lookup(world, node);
+    lilv_world_unlock_caches(world);
+    if (interned) {
+      return interned;
+    }
+  }
+
+  return lilv_node_init_view(world, node, view);
 }
 
 /** Create a new LilvNode from `node`, or return NULL if impossible */
@@ -98,46 +254,41 @@ lilv_node_new_from_node(LilvWorld* world, const SordNode* node)
     return NULL;
   }
 
-  LilvNode*    result       = NULL;
-  SordNode*    datatype_uri = NULL;
-  LilvNodeType type         = LILV_VALUE_STRING;
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+
+  LilvNode* result = lilv_node_find_interned(world, node);
+  if (result) {
+    lilv_world_unlock_caches(world);
+    lilv_world_unlock(world);
+    return result;
+  }
+
+  const SordNode* const datatype_uri = sord_node_get_datatype(node);
+  const LilvNodeType    type         = lilv_node_type_of(world, node);
 
   switch (sord_node_get_type(node)) {
   case SORD_URI:
-    result        = (LilvNode*)malloc(sizeof(LilvNode));
-    result->world = world;
-    result->type  = LILV_VALUE_URI;
-    result->node  = sord_node_copy(node);
-    break;
   case SORD_BLANK:
-    result        = (LilvNode*)malloc(sizeof(LilvNode));
-    result->world = world;
-    result->type  = LILV_VALUE_BLANK;
-    result->node  = sord_node_copy(node);
+    result = lilv_node_wrap(world, type, sord_node_copy(node));
     break;
   case SORD_LITERAL:
-    datatype_uri = sord_node_get_datatype(node);
-    if (datatype_uri) {
-      if (sord_node_equals(datatype_uri, world->uris.xsd_boolean)) {
-        type = LILV_VALUE_BOOL;
-      } else if (sord_node_equals(datatype_uri, world->uris.xsd_decimal) ||
-                 sord_node_equals(datatype_uri, world->uris.xsd_double)) {
-        type = LILV_VALUE_FLOAT;
-      } else if (sord_node_equals(datatype_uri, world->uris.xsd_integer)) {
-        type = LILV_VALUE_INT;
-      } else if (sord_node_equals(datatype_uri, world->uris.xsd_base64Binary)) {
-        type = LILV_VALUE_BLOB;
-      } else {
-        LILV_ERRORF("Unknown datatype `%s'\n",
-                    sord_node_get_string(datatype_uri));
-      }
+    if (datatype_uri && type == LILV_VALUE_STRING) {
+      LILV_ERRORF("Unknown datatype `%s'\n",
+                  sord_node_get_string(datatype_uri));
     }
     result =
       lilv_node_new(world, type, (const char*)sord_node_get_string(node));
-    lilv_node_set_numerics_from_string(result);
+    if (result && !result->key) {
+      // Intern numeric nodes as the model node, which determines their value
+      lilv_node_set_numerics_from_string(result);
+      lilv_node_intern(result, node);
+    }
     break;
   }
 
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
   return result;
 }
 
@@ -217,28 +368,65 @@ lilv_node_duplicate(const LilvNode* val)
     return NULL;
   }
 
-  LilvNode* result = (LilvNode*)malloc(sizeof(LilvNode));
-  result->world    = val->world;
-  result->node     = sord_node_copy(val->node);
-  result->val      = val->val;
-  result->type     = val->type;
+  if (!lilv_atomic_load(&val->refs)) {
+    // Borrowed view of a model node, so make a real node of the same value
+    LilvNode* const result = lilv_node_new(
+      val->world, val->type, (const char*)sord_node_get_string(val->node));
+    if (result && !result->key) {
+      result->val = val->val;
+    }
+
+    return result;
+  }
+
+  // Nodes are immutable, so a duplicate is just another reference
+  LilvNode* const result = (LilvNode*)val;
+  lilv_atomic_add(&result->refs, 1);
   return result;
 }
 
 void
 lilv_node_free(LilvNode* val)
 {
-  if (val) {
-    sord_node_free(val->world->world, val->node);
+  if (!val) {
+    return;
+  }
+
+  // Drop a reference without locking if it isn't the last
+  unsigned refs = lilv_atomic_load(&val->refs);
+  while (refs > 1U) {
+    if (lilv_atomic_cas(&val->refs, refs, refs - 1U)) {
+      return;
+    }
+
+    refs = lilv_atomic_load(&val->refs);
+  }
+
+  // Otherwise, lock so the node can't be found while it is destroyed
+  LilvWorld* const world = val->world;
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+  if (!lilv_atomic_add(&val->refs, -1)) {
+    if (val->key) {
+      ZixTreeIter* i = NULL;
+      if (!zix_tree_find((ZixTree*)world->nodes, val, &i)) {
+        zix_tree_remove((ZixTree*)world->nodes, i);
+      }
+      sord_node_free(world->world, val->key);
+    }
+
+    sord_node_free(world->world, val->node);
     free(val);
   }
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
 }
 
 bool
 lilv_node_equals(const LilvNode* value, const LilvNode* other)
 {
-  if (value == NULL && other == NULL) {
-    return true;
+  if (value == other) {
+    return true; // Including interned equal nodes, and both NULL
   }
 
   if (value == NULL || other == NULL || value->type != other->type) {
@@ -248,9 +436,15 @@ lilv_node_equals(const LilvNode* value, const LilvNode* other)
   switch (value->type) {
   case LILV_VALUE_URI:
   case LILV_VALUE_BLANK:
+    return sord_node_equals(value->node, other->node);
   case LILV_VALUE_STRING:
   case LILV_VALUE_BLOB:
-    return sord_node_equals(value->node, other->node);
+    // A view may have a language or datatype that real strings don't have
+    return sord_node_equals(value->node, other->node) ||
+           ((!lilv_atomic_load(&value->refs) ||
+             !lilv_atomic_load(&other->refs)) &&
+            !strcmp((const char*)sord_node_get_string(value->node),
+                    (const char*)sord_node_get_string(other->node)));
   case LILV_VALUE_INT:
     return (value->val.int_val == other->val.int_val);
   case LILV_VALUE_FLOAT:
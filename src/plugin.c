@@ -6,16 +6,13 @@
 #include "lilv/lilv.h"
 #include "serd/serd.h"
 #include "sord/sord.h"
-#include "zix/tree.h"
 
 #include "lv2/core/lv2.h"
-#include "lv2/ui/ui.h"
 
 #ifdef LILV_DYN_MANIFEST
 #  include "lv2/dynmanifest/dynmanifest.h"
 #endif
 
-#include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -23,9 +20,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define NS_DOAP (const uint8_t*)"http://usefulinc.com/ns/doap#"
-#define NS_FOAF (const uint8_t*)"http://xmlns.com/foaf/0.1/"
-
 static void
 lilv_plugin_init(LilvPlugin* plugin, LilvNode* bundle_uri)
 {
@@ -34,13 +28,20 @@ lilv_plugin_init(LilvPlugin* plugin, LilvNode* bundle_uri)
 #ifdef LILV_DYN_MANIFEST
   plugin->dynmanifest = NULL;
 #endif
-  plugin->plugin_class = NULL;
-  plugin->data_uris    = lilv_nodes_new();
-  plugin->ports        = NULL;
-  plugin->num_ports    = 0;
-  plugin->loaded       = false;
-  plugin->parse_errors = false;
-  plugin->replaced     = false;
+  plugin->plugin_class   = NULL;
+  plugin->data_uris      = lilv_nodes_new();
+  plugin->ports          = NULL;
+  plugin->num_ports      = 0;
+  plugin->port_symbols   = NULL;
+  plugin->n_port_symbols = 0U;
+  plugin->port_infos     = NULL;
+  plugin->designations   = NULL;
+  plugin->n_designations = 0U;
+  plugin->latency_port   = UINT32_MAX;
+  plugin->has_latency    = false;
+  plugin->loaded         = false;
+  plugin->parse_errors   = false;
+  plugin->replaced       = false;
 }
 
 /** Ownership of `uri` and `bundle` is taken */
@@ -76,6 +77,21 @@ lilv_plugin_free_ports(LilvPlugin* plugin)
     plugin->num_ports = 0;
     plugin->ports     = NULL;
   }
+
+  for (uint32_t i = 0U; i < plugin->n_designations; ++i) {
+    lilv_node_free((LilvNode*)plugin->designations[i].designation);
+  }
+
+  free(plugin->port_symbols);
+  free(plugin->port_infos);
+  free(plugin->designations);
+  plugin->port_symbols   = NULL;
+  plugin->n_port_symbols = 0U;
+  plugin->port_infos     = NULL;
+  plugin->designations   = NULL;
+  plugin->n_designations = 0U;
+  plugin->latency_port   = UINT32_MAX;
+  plugin->has_latency    = false;
 }
 
 void
@@ -109,22 +125,14 @@ lilv_plugin_get_one(const LilvPlugin* plugin,
                     const SordNode*   subject,
                     const SordNode*   predicate)
 {
-  /* TODO: This is slower than it could be in some cases, but it's simpler to
-     use the existing i18n code. */
-
-  SordIter* stream =
-    lilv_world_query_internal(plugin->world, subject, predicate, NULL);
+  lilv_world_lock(plugin->world);
 
-  LilvNodes* nodes =
-    lilv_nodes_from_stream_objects(plugin->world, stream, SORD_OBJECT);
+  LilvNode* const value = lilv_node_new_from_node(
+    plugin->world,
+    lilv_world_get_translated(plugin->world, subject, predicate));
 
-  if (nodes) {
-    LilvNode* value = lilv_node_duplicate(lilv_nodes_get_first(nodes));
-    lilv_nodes_free(nodes);
-    return value;
-  }
-
-  return NULL;
+  lilv_world_unlock(plugin->world);
+  return value;
 }
 
 LilvNode*
@@ -234,6 +242,7 @@ lilv_plugin_load(LilvPlugin* plugin)
   serd_reader_free(reader);
   serd_env_free(env);
 
+  ++plugin->world->epoch;
   plugin->loaded = true;
 }
 
@@ -249,24 +258,133 @@ is_symbol(const char* str)
   return true;
 }
 
+/** Return the FNV-1a hash of a port symbol. */
+static uint32_t
+lilv_symbol_hash(const char* str)
+{
+  uint32_t hash = 2166136261U;
+  for (const char* s = str; *s; ++s) {
+    hash = (hash ^ (uint8_t)*s) * 16777619U;
+  }
+
+  return hash;
+}
+
+/** Build the open-addressed table of port indices by symbol hash. */
+static void
+lilv_plugin_index_port_symbols(LilvPlugin* plugin)
+{
+  // Keep at least half of the slots empty, so probe sequences stay short
+  uint32_t n_slots = 4U;
+  while (n_slots < 2U * plugin->num_ports) {
+    n_slots *= 2U;
+  }
+
+  plugin->port_symbols   = (uint32_t*)malloc(n_slots * sizeof(uint32_t));
+  plugin->n_port_symbols = n_slots;
+  memset(plugin->port_symbols, 0xFF, n_slots * sizeof(uint32_t));
+
+  const uint32_t mask = n_slots - 1U;
+  for (uint32_t i = 0U; i < plugin->num_ports; ++i) {
+    LilvPort* const port = plugin->ports[i];
+
+    port->symbol_hash = lilv_symbol_hash(lilv_node_as_string(port->symbol));
+
+    uint32_t s = port->symbol_hash & mask;
+    while (plugin->port_symbols[s] != UINT32_MAX) {
+      s = (s + 1U) & mask;
+    }
+
+    plugin->port_symbols[s] = i;
+  }
+}
+
+/**
+   Cache the designations and latency port, which hosts frequently need.
+
+   The designation of each port is the first one found for it here.
+*/
+static void
+lilv_plugin_index_designations(LilvPlugin* plugin)
+{
+  LilvWorld* const world = plugin->world;
+
+  uint32_t capacity       = 0U;
+  uint32_t latency_output = UINT32_MAX;
+  for (uint32_t i = 0U; i < plugin->num_ports; ++i) {
+    LilvPort* const port = plugin->ports[i];
+    if (port->flags & LILV_PORT_REPORTS_LATENCY) {
+      plugin->has_latency = true;
+      if (plugin->latency_port == UINT32_MAX) {
+        plugin->latency_port = i;
+      }
+    }
+
+    LilvMatches        designations_matches;
+    LilvMatches* const designations = lilv_world_query_internal(
+      world,
+      port->node->node,
+      world->uris.lv2_designation,
+      NULL,
+      &designations_matches);
+    FOREACH_MATCHES (designations) {
+      const SordNode* const designation =
+        lilv_matches_get_node(designations, SORD_OBJECT);
+
+      if (designation == world->uris.lv2_latency) {
+        plugin->has_latency = true;
+        if ((port->flags & LILV_PORT_OUTPUT) && latency_output == UINT32_MAX) {
+          latency_output = i;
+        }
+      }
+
+      if (plugin->n_designations == capacity) {
+        capacity             = capacity ? capacity * 2U : 4U;
+        plugin->designations = (LilvDesignatedPort*)realloc(
+          plugin->designations, capacity * sizeof(LilvDesignatedPort));
+      }
+
+      LilvNode* const node = lilv_node_new_from_node(world, designation);
+      if (!port->designation) {
+        port->designation = node;
+      }
+
+      LilvDesignatedPort* const d =
+        &plugin->designations[plugin->n_designations++];
+
+      d->port        = port;
+      d->designation = node;
+    }
+    lilv_matches_close(designations);
+  }
+
+  if (plugin->latency_port == UINT32_MAX) {
+    plugin->latency_port = latency_output;
+  }
+}
+
 static void
 lilv_plugin_load_ports_if_necessary(const LilvPlugin* const_plugin)
 {
   LilvPlugin* plugin = (LilvPlugin*)const_plugin;
 
+  lilv_world_lock(plugin->world);
+  lilv_world_lock_caches(plugin->world);
   lilv_plugin_load_if_necessary(plugin);
 
   if (!plugin->ports) {
     plugin->ports    = (LilvPort**)malloc(sizeof(LilvPort*));
     plugin->ports[0] = NULL;
 
-    SordIter* ports = lilv_world_query_internal(plugin->world,
-                                                plugin->plugin_uri->node,
-                                                plugin->world->uris.lv2_port,
-                                                NULL);
+    LilvMatches  ports_matches;
+    LilvMatches* ports = lilv_world_query_internal(plugin->world,
+                                                   plugin->plugin_uri->node,
+                                                   plugin->world->uris.lv2_port,
+                                                   NULL,
+                                                   &ports_matches);
 
-    FOREACH_MATCH (ports) {
-      const SordNode* port = sord_iter_get_node(ports, SORD_OBJECT);
+    FOREACH_MATCHES (ports) {
+      const SordNode* port = lilv_matches_get_node(ports, SORD_OBJECT);
 
       LilvNode* index =
         lilv_plugin_get_unique(plugin, port, plugin->world->uris.lv2_index);
@@ -314,25 +432,25 @@ lilv_plugin_load_ports_if_necessary(const LilvPlugin* const_plugin)
         plugin->ports[this_index] = this_port;
       }
 
-      SordIter* types = lilv_world_query_internal(
-        plugin->world, port, plugin->world->uris.rdf_a, NULL);
-      FOREACH_MATCH (types) {
-        const SordNode* type = sord_iter_get_node(types, SORD_OBJECT);
+      LilvMatches  types_matches;
+      LilvMatches* types = lilv_world_query_internal(
+        plugin->world, port, plugin->world->uris.rdf_a, NULL, &types_matches);
+      FOREACH_MATCHES (types) {
+        const SordNode* type = lilv_matches_get_node(types, SORD_OBJECT);
         if (sord_node_get_type(type) == SORD_URI) {
-          zix_tree_insert((ZixTree*)this_port->classes,
-                          lilv_node_new_from_node(plugin->world, type),
-                          NULL);
+          lilv_collection_insert(this_port->classes,
+                                 lilv_node_new_from_node(plugin->world, type));
         } else {
           LILV_WARNF("Plugin <%s> port type is not a URI\n",
                      lilv_node_as_uri(plugin->plugin_uri));
         }
       }
-      sord_iter_free(types);
+      lilv_matches_close(types);
 
       lilv_node_free(symbol);
       lilv_node_free(index);
     }
-    sord_iter_free(ports);
+    lilv_matches_close(ports);
 
     // Check sanity
     for (uint32_t i = 0; i < plugin->num_ports; ++i) {
@@ -345,15 +463,37 @@ lilv_plugin_load_ports_if_necessary(const LilvPlugin* const_plugin)
         break;
       }
     }
+
+    // Cache what hosts commonly check, to avoid querying for every port
+    for (uint32_t i = 0; i < plugin->num_ports; ++i) {
+      lilv_port_load_flags(plugin, plugin->ports[i]);
+    }
+
+    if (plugin->ports) {
+      lilv_plugin_index_port_symbols(plugin);
+      lilv_plugin_index_designations(plugin);
+    }
   }
+
+  lilv_world_unlock_caches(plugin->world);
+  lilv_world_unlock(plugin->world);
 }
 
 void
 lilv_plugin_load_if_necessary(const LilvPlugin* plugin)
 {
-  if (!plugin->loaded) {
+  lilv_world_lock(plugin->world);
+  lilv_world_lock_caches(plugin->world);
+  if (!plugin->loaded && plugin->world->store) {
+    // Data would be added to the empty model, which a compact world ignores
+    LILV_ERRORF("Can't load plugin <%s> into a compact world\n",
+                lilv_node_as_uri(plugin->plugin_uri));
+    ((LilvPlugin*)plugin)->loaded = true;
+  } else if (!plugin->loaded) {
     lilv_plugin_load((LilvPlugin*)plugin);
   }
+  lilv_world_unlock_caches(plugin->world);
+  lilv_world_unlock(plugin->world);
 }
 
 const LilvNode*
@@ -371,28 +511,36 @@ lilv_plugin_get_bundle_uri(const LilvPlugin* plugin)
 const LilvNode*
 lilv_plugin_get_library_uri(const LilvPlugin* plugin)
 {
+  lilv_world_lock(plugin->world);
+  lilv_world_lock_caches(plugin->world);
   lilv_plugin_load_if_necessary((LilvPlugin*)plugin);
   if (!plugin->binary_uri) {
     // <plugin> lv2:binary ?binary
-    SordIter* i = lilv_world_query_internal(plugin->world,
-                                            plugin->plugin_uri->node,
-                                            plugin->world->uris.lv2_binary,
-                                            NULL);
-    FOREACH_MATCH (i) {
-      const SordNode* binary_node = sord_iter_get_node(i, SORD_OBJECT);
+    LilvMatches  matches;
+    LilvMatches* i = lilv_world_query_internal(plugin->world,
+                                               plugin->plugin_uri->node,
+                                               plugin->world->uris.lv2_binary,
+                                               NULL,
+                                               &matches);
+    FOREACH_MATCHES (i) {
+      const SordNode* binary_node = lilv_matches_get_node(i, SORD_OBJECT);
       if (sord_node_get_type(binary_node) == SORD_URI) {
         ((LilvPlugin*)plugin)->binary_uri =
           lilv_node_new_from_node(plugin->world, binary_node);
         break;
       }
     }
-    sord_iter_free(i);
+    lilv_matches_close(i);
   }
   if (!plugin->binary_uri) {
     LILV_WARNF("Plugin <%s> has no lv2:binary\n",
                lilv_node_as_uri(lilv_plugin_get_uri(plugin)));
   }
-  return plugin->binary_uri;
+
+  const LilvNode* const binary_uri = plugin->binary_uri;
+  lilv_world_unlock_caches(plugin->world);
+  lilv_world_unlock(plugin->world);
+  return binary_uri;
 }
 
 const LilvNodes*
@@ -404,13 +552,19 @@ lilv_plugin_get_data_uris(const LilvPlugin* plugin)
 const LilvPluginClass*
 lilv_plugin_get_class(const LilvPlugin* plugin)
 {
+  lilv_world_lock(plugin->world);
+  lilv_world_lock_caches(plugin->world);
   lilv_plugin_load_if_necessary((LilvPlugin*)plugin);
   if (!plugin->plugin_class) {
     // <plugin> a ?class
-    SordIter* c = lilv_world_query_internal(
-      plugin->world, plugin->plugin_uri->node, plugin->world->uris.rdf_a, NULL);
-    FOREACH_MATCH (c) {
-      const SordNode* class_node = sord_iter_get_node(c, SORD_OBJECT);
+    LilvMatches  matches;
+    LilvMatches* c = lilv_world_query_internal(plugin->world,
+                                               plugin->plugin_uri->node,
+                                               plugin->world->uris.rdf_a,
+                                               NULL,
+                                               &matches);
+    FOREACH_MATCHES (c) {
+      const SordNode* class_node = lilv_matches_get_node(c, SORD_OBJECT);
       if (sord_node_get_type(class_node) != SORD_URI) {
         continue;
       }
@@ -429,13 +583,40 @@ lilv_plugin_get_class(const LilvPlugin* plugin)
 
       lilv_node_free(klass);
     }
-    sord_iter_free(c);
+    lilv_matches_close(c);
+
+    if (!plugin->plugin_class && plugin->world->classes_pending) {
+      // Classes aren't loaded yet, so load only the ones this plugin has
+      LilvNodes* types =
+        lilv_world_find_nodes_internal(plugin->world,
+                                       plugin->plugin_uri->node,
+                                       plugin->world->uris.rdf_a,
+                                       NULL);
+      LILV_FOREACH (nodes, i, types) {
+        const LilvNode* klass = lilv_nodes_get(types, i);
+        if (lilv_node_is_uri(klass) &&
+            !lilv_node_equals(klass, plugin->world->lv2_plugin_class->uri)) {
+          const LilvPluginClass* pclass =
+            lilv_world_get_plugin_class_by_uri(plugin->world, klass);
+
+          if (pclass) {
+            ((LilvPlugin*)plugin)->plugin_class = pclass;
+            break;
+          }
+        }
+      }
+      lilv_nodes_free(types);
+    }
 
     if (plugin->plugin_class == NULL) {
       ((LilvPlugin*)plugin)->plugin_class = plugin->world->lv2_plugin_class;
     }
   }
-  return plugin->plugin_class;
+
+  const LilvPluginClass* const plugin_class = plugin->plugin_class;
+  lilv_world_unlock_caches(plugin->world);
+  lilv_world_unlock(plugin->world);
+  return plugin_class;
 }
 
 static LilvNodes*
@@ -443,8 +624,13 @@ lilv_plugin_get_value_internal(const LilvPlugin* plugin,
                                const SordNode*   predicate)
 {
   lilv_plugin_load_if_necessary(plugin);
-  return lilv_world_find_nodes_internal(
+  lilv_world_lock(plugin->world);
+
+  LilvNodes* const values = lilv_world_find_nodes_internal(
     plugin->world, plugin->plugin_uri->node, predicate, NULL);
+
+  lilv_world_unlock(plugin->world);
+  return values;
 }
 
 bool
@@ -455,9 +641,8 @@ lilv_plugin_verify(const LilvPlugin* plugin)
     return false;
   }
 
-  LilvNode*  rdf_type = lilv_new_uri(plugin->world, LILV_NS_RDF "type");
-  LilvNodes* results  = lilv_plugin_get_value(plugin, rdf_type);
-  lilv_node_free(rdf_type);
+  LilvNodes* results =
+    lilv_plugin_get_value_internal(plugin, plugin->world->uris.rdf_a);
   if (!results) {
     return false;
   }
@@ -470,9 +655,8 @@ lilv_plugin_verify(const LilvPlugin* plugin)
   }
 
   lilv_nodes_free(results);
-  LilvNode* lv2_port = lilv_new_uri(plugin->world, LV2_CORE__port);
-  results            = lilv_plugin_get_value(plugin, lv2_port);
-  lilv_node_free(lv2_port);
+  results =
+    lilv_plugin_get_value_internal(plugin, plugin->world->uris.lv2_port);
   if (!results) {
     return false;
   }
@@ -484,19 +668,14 @@ lilv_plugin_verify(const LilvPlugin* plugin)
 LilvNode*
 lilv_plugin_get_name(const LilvPlugin* plugin)
 {
-  LilvNodes* results =
-    lilv_plugin_get_value_internal(plugin, plugin->world->uris.doap_name);
+  lilv_plugin_load_if_necessary(plugin);
 
-  LilvNode* ret = NULL;
-  if (results) {
-    LilvNode* val = lilv_nodes_get_first(results);
-    if (lilv_node_is_string(val)) {
-      ret = lilv_node_duplicate(val);
-    }
-    lilv_nodes_free(results);
-  }
+  LilvNode* ret = lilv_plugin_get_one(
+    plugin, plugin->plugin_uri->node, plugin->world->uris.doap_name);
 
-  if (!ret) {
+  if (!lilv_node_is_string(ret)) {
+    lilv_node_free(ret);
+    ret = NULL;
     LILV_WARNF("Plugin <%s> has no (mandatory) doap:name\n",
                lilv_node_as_string(lilv_plugin_get_uri(plugin)));
   }
@@ -512,6 +691,34 @@ lilv_plugin_get_value(const LilvPlugin* plugin, const LilvNode* predicate)
     plugin->world, plugin->plugin_uri, predicate, NULL);
 }
 
+unsigned
+lilv_plugin_foreach_value(const LilvPlugin* plugin,
+                          const LilvNode*   predicate,
+                          LilvMatchFunc     func,
+                          void*             data)
+{
+  if (!lilv_node_is_uri(predicate)) {
+    LILV_ERRORF("Predicate `%s' is not a URI\n",
+                sord_node_get_string(predicate->node));
+    return 0U;
+  }
+
+  lilv_plugin_load_if_necessary(plugin);
+  lilv_world_lock(plugin->world);
+
+  const unsigned n_values =
+    lilv_world_foreach_internal(plugin->world,
+                                plugin->plugin_uri->node,
+                                predicate->node,
+                                NULL,
+                                plugin->world->opt.filter_language,
+                                func,
+                                data);
+
+  lilv_world_unlock(plugin->world);
+  return n_values;
+}
+
 uint32_t
 lilv_plugin_get_num_ports(const LilvPlugin* plugin)
 {
@@ -526,44 +733,48 @@ lilv_plugin_get_port_ranges_float(const LilvPlugin* plugin,
                                   float*            def_values)
 {
   lilv_plugin_load_ports_if_necessary(plugin);
-  LilvNode*  min    = NULL;
-  LilvNode*  max    = NULL;
-  LilvNode*  def    = NULL;
-  LilvNode** minptr = min_values ? &min : NULL;
-  LilvNode** maxptr = max_values ? &max : NULL;
-  LilvNode** defptr = def_values ? &def : NULL;
 
   for (uint32_t i = 0; i < plugin->num_ports; ++i) {
-    lilv_port_get_range(plugin, plugin->ports[i], defptr, minptr, maxptr);
+    LilvPortRange range;
+    lilv_port_get_range_values(plugin, plugin->ports[i], &range, NULL, 0U);
 
     if (min_values) {
-      if (lilv_node_is_float(min) || lilv_node_is_int(min)) {
-        min_values[i] = lilv_node_as_float(min);
-      } else {
-        min_values[i] = NAN;
-      }
+      min_values[i] = range.min;
     }
 
     if (max_values) {
-      if (lilv_node_is_float(max) || lilv_node_is_int(max)) {
-        max_values[i] = lilv_node_as_float(max);
-      } else {
-        max_values[i] = NAN;
-      }
+      max_values[i] = range.max;
     }
 
     if (def_values) {
-      if (lilv_node_is_float(def) || lilv_node_is_int(def)) {
-        def_values[i] = lilv_node_as_float(def);
-      } else {
-        def_values[i] = NAN;
-      }
+      def_values[i] = range.def;
     }
+  }
+}
 
-    lilv_node_free(def);
-    lilv_node_free(min);
-    lilv_node_free(max);
+uint32_t
+lilv_plugin_get_port_ranges(const LilvPlugin*   plugin,
+                            LilvPortRange*      ranges,
+                            LilvPortScalePoint* points,
+                            uint32_t            n_points)
+{
+  lilv_plugin_load_ports_if_necessary(plugin);
+
+  uint32_t n = 0U;
+  for (uint32_t i = 0; i < plugin->num_ports; ++i) {
+    LilvPortRange* const range = &ranges[i];
+
+    const bool                fits  = points && n < n_points;
+    LilvPortScalePoint* const first = fits ? points + n : NULL;
+
+    lilv_port_get_range_values(
+      plugin, plugin->ports[i], range, first, fits ? n_points - n : 0U);
+
+    range->scale_points = n;
+    n += range->n_scale_points;
   }
+
+  return n;
 }
 
 uint32_t
@@ -625,63 +836,39 @@ lilv_plugin_get_num_ports_of_class(const LilvPlugin* plugin,
 bool
 lilv_plugin_has_latency(const LilvPlugin* plugin)
 {
-  lilv_plugin_load_if_necessary(plugin);
-  SordIter* ports = lilv_world_query_internal(plugin->world,
-                                              plugin->plugin_uri->node,
-                                              plugin->world->uris.lv2_port,
-                                              NULL);
-
-  bool ret = false;
-  FOREACH_MATCH (ports) {
-    const SordNode* port = sord_iter_get_node(ports, SORD_OBJECT);
+  lilv_plugin_load_ports_if_necessary(plugin);
+  if (plugin->ports) {
+    return plugin->has_latency;
+  }
 
-    SordIter* prop =
-      lilv_world_query_internal(plugin->world,
-                                port,
-                                plugin->world->uris.lv2_portProperty,
-                                plugin->world->uris.lv2_reportsLatency);
+  // Ports are invalid, so nothing is cached, but check any that are described
+  LilvWorld* const world = plugin->world;
+  lilv_world_lock(world);
 
-    SordIter* des =
-      lilv_world_query_internal(plugin->world,
+  bool               latent = false;
+  LilvMatches        ports_matches;
+  LilvMatches* const ports  = lilv_world_query_internal(
+    world,
+    plugin->plugin_uri->node,
+    world->uris.lv2_port,
+    NULL,
+    &ports_matches);
+  FOREACH_MATCHES (ports) {
+    const SordNode* const port = lilv_matches_get_node(ports, SORD_OBJECT);
+    if (lilv_world_ask_internal(world,
                                 port,
-                                plugin->world->uris.lv2_designation,
-                                plugin->world->uris.lv2_latency);
-
-    const bool latent = !sord_iter_end(prop) || !sord_iter_end(des);
-    sord_iter_free(prop);
-    sord_iter_free(des);
-    if (latent) {
-      ret = true;
+                                world->uris.lv2_portProperty,
+                                world->uris.lv2_reportsLatency) ||
+        lilv_world_ask_internal(
+          world, port, world->uris.lv2_designation, world->uris.lv2_latency)) {
+      latent = true;
       break;
     }
   }
-  sord_iter_free(ports);
+  lilv_matches_close(ports);
 
-  return ret;
-}
-
-static const LilvPort*
-lilv_plugin_get_port_by_property(const LilvPlugin* plugin,
-                                 const SordNode*   port_property)
-{
-  lilv_plugin_load_ports_if_necessary(plugin);
-  for (uint32_t i = 0; i < plugin->num_ports; ++i) {
-    LilvPort* port = plugin->ports[i];
-    SordIter* iter =
-      lilv_world_query_internal(plugin->world,
-                                port->node->node,
-                                plugin->world->uris.lv2_portProperty,
-                                port_property);
-
-    const bool found = !sord_iter_end(iter);
-    sord_iter_free(iter);
-
-    if (found) {
-      return port;
-    }
-  }
-
-  return NULL;
+  lilv_world_unlock(world);
+  return latent;
 }
 
 const LilvPort*
@@ -689,49 +876,31 @@ lilv_plugin_get_port_by_designation(const LilvPlugin* plugin,
                                     const LilvNode*   port_class,
                                     const LilvNode*   designation)
 {
-  LilvWorld* world = plugin->world;
   lilv_plugin_load_ports_if_necessary(plugin);
-  for (uint32_t i = 0; i < plugin->num_ports; ++i) {
-    LilvPort* port = plugin->ports[i];
-    SordIter* iter = lilv_world_query_internal(
-      world, port->node->node, world->uris.lv2_designation, designation->node);
-
-    const bool found =
-      !sord_iter_end(iter) &&
-      (!port_class || lilv_port_is_a(plugin, port, port_class));
-    sord_iter_free(iter);
-
-    if (found) {
-      return port;
+  for (uint32_t i = 0U; i < plugin->n_designations; ++i) {
+    const LilvDesignatedPort* const d = &plugin->designations[i];
+    if (d->designation->node == designation->node &&
+        (!port_class || lilv_port_is_a(plugin, d->port, port_class))) {
+      return d->port;
     }
   }
 
   return NULL;
 }
 
+const LilvDesignatedPort*
+lilv_plugin_get_designated_ports(const LilvPlugin* plugin, uint32_t* n_ports)
+{
+  lilv_plugin_load_ports_if_necessary(plugin);
+  *n_ports = plugin->n_designations;
+  return plugin->designations;
+}
+
 uint32_t
 lilv_plugin_get_latency_port_index(const LilvPlugin* plugin)
 {
-  LilvNode* lv2_OutputPort = lilv_new_uri(plugin->world, LV2_CORE__OutputPort);
-  LilvNode* lv2_latency    = lilv_new_uri(plugin->world, LV2_CORE__latency);
-
-  const LilvPort* prop_port = lilv_plugin_get_port_by_property(
-    plugin, plugin->world->uris.lv2_reportsLatency);
-  const LilvPort* des_port =
-    lilv_plugin_get_port_by_designation(plugin, lv2_OutputPort, lv2_latency);
-
-  lilv_node_free(lv2_latency);
-  lilv_node_free(lv2_OutputPort);
-
-  if (prop_port) {
-    return prop_port->index;
-  }
-
-  if (des_port) {
-    return des_port->index;
-  }
-
-  return (uint32_t)-1;
+  lilv_plugin_load_ports_if_necessary(plugin);
+  return plugin->latency_port;
 }
 
 bool
@@ -742,13 +911,14 @@ lilv_plugin_has_feature(const LilvPlugin* plugin, const LilvNode* feature)
                                   plugin->world->uris.lv2_optionalFeature,
                                   NULL};
 
-  for (const SordNode** pred = predicates; *pred; ++pred) {
-    if (lilv_world_ask_internal(
-          plugin->world, plugin->plugin_uri->node, *pred, feature->node)) {
-      return true;
-    }
+  bool found = false;
+  lilv_world_lock(plugin->world);
+  for (const SordNode** pred = predicates; *pred && !found; ++pred) {
+    found = lilv_world_ask_internal(
+      plugin->world, plugin->plugin_uri->node, *pred, feature->node);
   }
-  return false;
+  lilv_world_unlock(plugin->world);
+  return found;
 }
 
 LilvNodes*
@@ -765,21 +935,15 @@ lilv_plugin_get_supported_features(const LilvPlugin* plugin)
 LilvNodes*
 lilv_plugin_get_optional_features(const LilvPlugin* plugin)
 {
-  lilv_plugin_load_if_necessary(plugin);
-  return lilv_world_find_nodes_internal(plugin->world,
-                                        plugin->plugin_uri->node,
-                                        plugin->world->uris.lv2_optionalFeature,
-                                        NULL);
+  return lilv_plugin_get_value_internal(
+    plugin, plugin->world->uris.lv2_optionalFeature);
 }
 
 LilvNodes*
 lilv_plugin_get_required_features(const LilvPlugin* plugin)
 {
-  lilv_plugin_load_if_necessary(plugin);
-  return lilv_world_find_nodes_internal(plugin->world,
-                                        plugin->plugin_uri->node,
-                                        plugin->world->uris.lv2_requiredFeature,
-                                        NULL);
+  return lilv_plugin_get_value_internal(
+    plugin, plugin->world->uris.lv2_requiredFeature);
 }
 
 bool
@@ -792,10 +956,16 @@ lilv_plugin_has_extension_data(const LilvPlugin* plugin, const LilvNode* uri)
   }
 
   lilv_plugin_load_if_necessary(plugin);
-  return lilv_world_ask_internal(plugin->world,
-                                 plugin->plugin_uri->node,
-                                 plugin->world->uris.lv2_extensionData,
-                                 uri->node);
+  lilv_world_lock(plugin->world);
+
+  const bool has_extension_data =
+    lilv_world_ask_internal(plugin->world,
+                            plugin->plugin_uri->node,
+                            plugin->world->uris.lv2_extensionData,
+                            uri->node);
+
+  lilv_world_unlock(plugin->world);
+  return has_extension_data;
 }
 
 LilvNodes*
@@ -820,38 +990,79 @@ const LilvPort*
 lilv_plugin_get_port_by_symbol(const LilvPlugin* plugin, const LilvNode* symbol)
 {
   lilv_plugin_load_ports_if_necessary(plugin);
-  for (uint32_t i = 0; i < plugin->num_ports; ++i) {
-    LilvPort* port = plugin->ports[i];
-    if (lilv_node_equals(port->symbol, symbol)) {
+  if (!plugin->port_symbols || !lilv_node_is_string(symbol)) {
+    return NULL;
+  }
+
+  const char* const str  = lilv_node_as_string(symbol);
+  const uint32_t    hash = lilv_symbol_hash(str);
+  const uint32_t    mask = plugin->n_port_symbols - 1U;
+  for (uint32_t s = hash & mask; plugin->port_symbols[s] != UINT32_MAX;) {
+    LilvPort* const port = plugin->ports[plugin->port_symbols[s]];
+    if (port->symbol_hash == hash &&
+        !strcmp(lilv_node_as_string(port->symbol), str)) {
       return port;
     }
+
+    s = (s + 1U) & mask;
   }
 
   return NULL;
 }
 
-LilvNode*
-lilv_plugin_get_project(const LilvPlugin* plugin)
+const LilvPortInfo*
+lilv_plugin_get_port_infos(const LilvPlugin* plugin)
 {
-  lilv_plugin_load_if_necessary(plugin);
+  lilv_plugin_load_ports_if_necessary(plugin);
+  lilv_world_lock(plugin->world);
+  lilv_world_lock_caches(plugin->world);
+  if (plugin->port_infos || !plugin->num_ports) {
+    const LilvPortInfo* const port_infos = plugin->port_infos;
+    lilv_world_unlock_caches(plugin->world);
+    lilv_world_unlock(plugin->world);
+    return port_infos;
+  }
 
-  SordNode* lv2_project =
-    sord_new_uri(plugin->world->world, (const uint8_t*)LV2_CORE__project);
+  const uint32_t      n_ports = plugin->num_ports;
+  LilvPortInfo* const infos =
+    (LilvPortInfo*)calloc(n_ports, sizeof(LilvPortInfo));
+  for (uint32_t i = 0U; i < n_ports; ++i) {
+    const LilvPort* const port = plugin->ports[i];
+    LilvPortInfo* const   info = &infos[i];
+
+    LilvPortRange range;
+    lilv_port_get_range_values(plugin, port, &range, NULL, 0U);
+
+    info->port        = port;
+    info->index       = port->index;
+    info->flags       = port->flags;
+    info->symbol      = lilv_node_as_string(port->symbol);
+    info->designation = port->designation;
+    info->min         = range.min;
+    info->max         = range.max;
+    info->def         = range.def;
+  }
 
-  SordIter* projects = lilv_world_query_internal(
-    plugin->world, plugin->plugin_uri->node, lv2_project, NULL);
+  ((LilvPlugin*)plugin)->port_infos = infos;
+  lilv_world_unlock_caches(plugin->world);
+  lilv_world_unlock(plugin->world);
+  return infos;
+}
 
-  sord_node_free(plugin->world->world, lv2_project);
+LilvNode*
+lilv_plugin_get_project(const LilvPlugin* plugin)
+{
+  lilv_plugin_load_if_necessary(plugin);
 
-  if (sord_iter_end(projects)) {
-    sord_iter_free(projects);
-    return NULL;
-  }
+  LilvWorld* const world = plugin->world;
+  lilv_world_lock(world);
 
-  const SordNode* project = sord_iter_get_node(projects, SORD_OBJECT);
+  const SordNode* const project = lilv_world_get_internal(
+    world, plugin->plugin_uri->node, world->uris.lv2_project, NULL);
 
-  sord_iter_free(projects);
-  return lilv_node_new_from_node(plugin->world, project);
+  LilvNode* const result = lilv_node_new_from_node(world, project);
+  lilv_world_unlock(world);
+  return result;
 }
 
 static const SordNode*
@@ -859,70 +1070,76 @@ lilv_plugin_get_author(const LilvPlugin* plugin)
 {
   lilv_plugin_load_if_necessary(plugin);
 
-  SordNode* doap_maintainer =
-    sord_new_uri(plugin->world->world, NS_DOAP "maintainer");
+  const SordNode* const doap_maintainer = plugin->world->uris.doap_maintainer;
 
-  SordIter* maintainers = lilv_world_query_internal(
-    plugin->world, plugin->plugin_uri->node, doap_maintainer, NULL);
+  LilvMatches  maintainers_matches;
+  LilvMatches* maintainers = lilv_world_query_internal(plugin->world,
+                                                       plugin->plugin_uri->node,
+                                                       doap_maintainer,
+                                                       NULL,
+                                                       &maintainers_matches);
 
-  if (sord_iter_end(maintainers)) {
-    sord_iter_free(maintainers);
+  if (lilv_matches_end(maintainers)) {
+    lilv_matches_close(maintainers);
 
     LilvNode* project = lilv_plugin_get_project(plugin);
     if (!project) {
-      sord_node_free(plugin->world->world, doap_maintainer);
       return NULL;
     }
 
-    maintainers = lilv_world_query_internal(
-      plugin->world, project->node, doap_maintainer, NULL);
+    maintainers = lilv_world_query_internal(plugin->world,
+                                            project->node,
+                                            doap_maintainer,
+                                            NULL,
+                                            &maintainers_matches);
 
     lilv_node_free(project);
   }
 
-  sord_node_free(plugin->world->world, doap_maintainer);
-
-  if (sord_iter_end(maintainers)) {
-    sord_iter_free(maintainers);
+  if (lilv_matches_end(maintainers)) {
+    lilv_matches_close(maintainers);
     return NULL;
   }
 
-  const SordNode* author = sord_iter_get_node(maintainers, SORD_OBJECT);
+  const SordNode* author = lilv_matches_get_node(maintainers, SORD_OBJECT);
 
-  sord_iter_free(maintainers);
+  lilv_matches_close(maintainers);
   return author;
 }
 
 static LilvNode*
-lilv_plugin_get_author_property(const LilvPlugin* plugin, const uint8_t* uri)
+lilv_plugin_get_author_property(const LilvPlugin* plugin,
+                                const SordNode*   predicate)
 {
-  const SordNode* author = lilv_plugin_get_author(plugin);
-  if (author) {
-    SordWorld* sworld = plugin->world->world;
-    SordNode*  pred   = sord_new_uri(sworld, uri);
-    LilvNode*  ret    = lilv_plugin_get_one(plugin, author, pred);
-    sord_node_free(sworld, pred);
-    return ret;
-  }
-  return NULL;
+  lilv_world_lock(plugin->world);
+
+  const SordNode* const author = lilv_plugin_get_author(plugin);
+  LilvNode* const       value =
+    author ? lilv_plugin_get_one(plugin, author, predicate) : NULL;
+
+  lilv_world_unlock(plugin->world);
+  return value;
 }
 
 LilvNode*
 lilv_plugin_get_author_name(const LilvPlugin* plugin)
 {
-  return lilv_plugin_get_author_property(plugin, NS_FOAF "name");
+  return lilv_plugin_get_author_property(plugin,
+                                         plugin->world->uris.foaf_name);
 }
 
 LilvNode*
 lilv_plugin_get_author_email(const LilvPlugin* plugin)
 {
-  return lilv_plugin_get_author_property(plugin, NS_FOAF "mbox");
+  return lilv_plugin_get_author_property(plugin,
+                                         plugin->world->uris.foaf_mbox);
 }
 
 LilvNode*
 lilv_plugin_get_author_homepage(const LilvPlugin* plugin)
 {
-  return lilv_plugin_get_author_property(plugin, NS_FOAF "homepage");
+  return lilv_plugin_get_author_property(plugin,
+                                         plugin->world->uris.foaf_homepage);
 }
 
 bool
@@ -935,25 +1152,26 @@ LilvUIs*
 lilv_plugin_get_uis(const LilvPlugin* plugin)
 {
   lilv_plugin_load_if_necessary(plugin);
+  lilv_world_lock(plugin->world);
 
-  SordNode* ui_ui_node =
-    sord_new_uri(plugin->world->world, (const uint8_t*)LV2_UI__ui);
-  SordNode* ui_binary_node =
-    sord_new_uri(plugin->world->world, (const uint8_t*)LV2_UI__binary);
-
-  LilvUIs*  result = lilv_uis_new();
-  SordIter* uis    = lilv_world_query_internal(
-    plugin->world, plugin->plugin_uri->node, ui_ui_node, NULL);
+  LilvUIs*     result = lilv_uis_new();
+  LilvMatches  uis_matches;
+  LilvMatches* uis    = lilv_world_query_internal(plugin->world,
+                                                  plugin->plugin_uri->node,
+                                                  plugin->world->uris.ui_ui,
+                                                  NULL,
+                                                  &uis_matches);
 
-  FOREACH_MATCH (uis) {
-    const SordNode* ui = sord_iter_get_node(uis, SORD_OBJECT);
+  FOREACH_MATCHES (uis) {
+    const SordNode* ui = lilv_matches_get_node(uis, SORD_OBJECT);
 
     LilvNode* type =
       lilv_plugin_get_unique(plugin, ui, plugin->world->uris.rdf_a);
     LilvNode* binary =
       lilv_plugin_get_one(plugin, ui, plugin->world->uris.lv2_binary);
     if (!binary) {
-      binary = lilv_plugin_get_unique(plugin, ui, ui_binary_node);
+      binary =
+        lilv_plugin_get_unique(plugin, ui, plugin->world->uris.ui_binary);
     }
 
     if (sord_node_get_type(ui) != SORD_URI || !lilv_node_is_uri(type) ||
@@ -967,12 +1185,12 @@ lilv_plugin_get_uis(const LilvPlugin* plugin)
     LilvUI* lilv_ui = lilv_ui_new(
       plugin->world, lilv_node_new_from_node(plugin->world, ui), type, binary);
 
-    zix_tree_insert((ZixTree*)result, lilv_ui, NULL);
+    if (lilv_collection_insert(result, lilv_ui)) {
+      lilv_ui_free(lilv_ui); // Duplicate UI
+    }
   }
-  sord_iter_free(uis);
-
-  sord_node_free(plugin->world->world, ui_binary_node);
-  sord_node_free(plugin->world->world, ui_ui_node);
+  lilv_matches_close(uis);
+  lilv_world_unlock(plugin->world);
 
   if (lilv_uis_size(result) > 0) {
     return result;
@@ -987,25 +1205,29 @@ lilv_plugin_get_related(const LilvPlugin* plugin, const LilvNode* type)
 {
   lilv_plugin_load_if_necessary(plugin);
 
-  LilvWorld* const world   = plugin->world;
+  LilvWorld* const world = plugin->world;
+  lilv_world_lock(world);
+
   LilvNodes* const related = lilv_world_find_nodes_internal(
     world, NULL, world->uris.lv2_appliesTo, lilv_plugin_get_uri(plugin)->node);
 
   if (!type) {
+    lilv_world_unlock(world);
     return related;
   }
 
   LilvNodes* matches = lilv_nodes_new();
   LILV_FOREACH (nodes, i, related) {
-    LilvNode* node = (LilvNode*)lilv_collection_get((ZixTree*)related, i);
+    LilvNode* node = (LilvNode*)lilv_collection_get(related, i);
     if (lilv_world_ask_internal(
           world, node->node, world->uris.rdf_a, type->node)) {
-      zix_tree_insert(
-        (ZixTree*)matches, lilv_node_new_from_node(world, node->node), NULL);
+      lilv_collection_insert(matches,
+                             lilv_node_new_from_node(world, node->node));
     }
   }
 
   lilv_nodes_free(related);
+  lilv_world_unlock(world);
   return matches;
 }
 
@@ -1061,17 +1283,21 @@ lilv_plugin_write_description(LilvWorld*        world,
   maybe_write_prefixes(writer, env, plugin_file);
 
   // Write plugin description
-  SordIter* plug_iter =
-    lilv_world_query_internal(world, subject->node, NULL, NULL);
-  sord_write_iter(plug_iter, writer);
+  lilv_world_lock(world);
+  LilvMatches  plug_iter_matches;
+  LilvMatches* plug_iter = lilv_world_query_internal(
+    world, subject->node, NULL, NULL, &plug_iter_matches);
+  lilv_matches_write(plug_iter, writer);
 
   // Write port descriptions
   for (uint32_t i = 0; i < num_ports; ++i) {
     const LilvPort* port = plugin->ports[i];
-    SordIter*       port_iter =
-      lilv_world_query_internal(world, port->node->node, NULL, NULL);
-    sord_write_iter(port_iter, writer);
+    LilvMatches     port_iter_matches;
+    LilvMatches*    port_iter = lilv_world_query_internal(
+      world, port->node->node, NULL, NULL, &port_iter_matches);
+    lilv_matches_write(port_iter, writer);
   }
+  lilv_world_unlock(world);
 
   serd_writer_free(writer);
   serd_env_free(env);
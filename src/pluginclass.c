@@ -5,9 +5,9 @@
 
 #include "lilv/lilv.h"
 #include "sord/sord.h"
-#include "zix/tree.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 
 LilvPluginClass*
@@ -22,6 +22,7 @@ lilv_plugin_class_new(LilvWorld*      world,
   pc->label           = lilv_node_new(world, LILV_VALUE_STRING, label);
   pc->parent_uri =
     (parent_node ? lilv_node_new_from_node(world, parent_node) : NULL);
+  pc->children = NULL;
   return pc;
 }
 
@@ -35,6 +36,7 @@ lilv_plugin_class_free(LilvPluginClass* plugin_class)
   lilv_node_free(plugin_class->uri);
   lilv_node_free(plugin_class->parent_uri);
   lilv_node_free(plugin_class->label);
+  lilv_collection_free(plugin_class->children);
   free(plugin_class);
 }
 
@@ -56,24 +58,136 @@ lilv_plugin_class_get_label(const LilvPluginClass* plugin_class)
   return plugin_class->label;
 }
 
+static void
+lilv_plugin_class_add_child(LilvPluginClass* parent, LilvPluginClass* child)
+{
+  if (!parent->children) {
+    parent->children = lilv_collection_new(lilv_header_compare_by_uri, NULL);
+  }
+
+  lilv_collection_insert(parent->children, child);
+}
+
+/** Add `child` to the children of its parent class, if it is loaded. */
+static void
+lilv_plugin_class_link(LilvWorld* world, LilvPluginClass* child)
+{
+  const LilvNode* parent_uri = child->parent_uri;
+  if (!parent_uri) {
+    return;
+  }
+
+  // The root class may also be described by a loaded class with the same URI
+  if (lilv_node_equals(parent_uri, world->lv2_plugin_class->uri)) {
+    lilv_plugin_class_add_child(world->lv2_plugin_class, child);
+  }
+
+  LilvPluginClass* const parent = (LilvPluginClass*)
+    lilv_plugin_classes_get_by_uri(world->plugin_classes, parent_uri);
+  if (parent) {
+    lilv_plugin_class_add_child(parent, child);
+  }
+}
+
+/** Rebuild the parent to children index if classes have been added. */
+void
+lilv_plugin_class_update_index(LilvWorld* world)
+{
+  lilv_world_load_classes_if_necessary(world);
+  if (!world->class_index_stale) {
+    return;
+  }
+
+  const LilvCollection* const all = world->plugin_classes;
+
+  lilv_collection_free(world->lv2_plugin_class->children);
+  world->lv2_plugin_class->children = NULL;
+  for (size_t i = 0U; i < all->size; ++i) {
+    LilvPluginClass* const c = (LilvPluginClass*)all->elems[i];
+    lilv_collection_free(c->children);
+    c->children = NULL;
+  }
+
+  for (size_t i = 0U; i < all->size; ++i) {
+    lilv_plugin_class_link(world, (LilvPluginClass*)all->elems[i]);
+  }
+
+  world->class_index_stale = false;
+}
+
 LilvPluginClasses*
 lilv_plugin_class_get_children(const LilvPluginClass* plugin_class)
 {
+  lilv_world_lock(plugin_class->world);
+  lilv_plugin_class_update_index(plugin_class->world);
+
   // Returned list doesn't own categories
-  LilvPluginClasses* all = plugin_class->world->plugin_classes;
-  LilvPluginClasses* result =
-    zix_tree_new(NULL, false, lilv_ptr_cmp, NULL, NULL, NULL);
-
-  for (ZixTreeIter* i = zix_tree_begin((ZixTree*)all);
-       i != zix_tree_end((ZixTree*)all);
-       i = zix_tree_iter_next(i)) {
-    const LilvPluginClass* c      = (LilvPluginClass*)zix_tree_get(i);
-    const LilvNode*        parent = lilv_plugin_class_get_parent_uri(c);
-    if (parent &&
-        lilv_node_equals(lilv_plugin_class_get_uri(plugin_class), parent)) {
-      zix_tree_insert((ZixTree*)result, (LilvPluginClass*)c, NULL);
+  const LilvCollection* const children = plugin_class->children;
+  LilvCollection* const       result =
+    lilv_collection_new(lilv_header_compare_by_uri, NULL);
+
+  for (size_t i = 0U; i < lilv_collection_size(children); ++i) {
+    lilv_collection_insert(result, children->elems[i]);
+  }
+
+  lilv_world_unlock(plugin_class->world);
+  return result;
+}
+
+/** Add all descendants of `plugin_class` that aren't in `result` yet. */
+static void
+lilv_plugin_class_add_descendants(LilvCollection*        result,
+                                  const LilvPluginClass* plugin_class)
+{
+  const LilvCollection* const children = plugin_class->children;
+
+  for (size_t i = 0U; i < lilv_collection_size(children); ++i) {
+    LilvPluginClass* const child = (LilvPluginClass*)children->elems[i];
+    if (!lilv_collection_insert(result, child)) {
+      lilv_plugin_class_add_descendants(result, child);
+    }
+  }
+}
+
+LilvPluginClasses*
+lilv_plugin_class_get_descendants(const LilvPluginClass* plugin_class)
+{
+  lilv_world_lock(plugin_class->world);
+  lilv_plugin_class_update_index(plugin_class->world);
+
+  // Returned list doesn't own categories
+  LilvCollection* const result =
+    lilv_collection_new(lilv_header_compare_by_uri, NULL);
+
+  lilv_plugin_class_add_descendants(result, plugin_class);
+  lilv_world_unlock(plugin_class->world);
+  return result;
+}
+
+LilvPlugins*
+lilv_plugin_class_get_plugins(const LilvPluginClass* plugin_class)
+{
+  LilvWorld* const world = plugin_class->world;
+  lilv_world_lock(world);
+  lilv_plugin_class_update_index(world);
+
+  // Gather the subtree, including the class itself, as a set of pointers
+  LilvCollection* const subtree = lilv_collection_new(lilv_ptr_cmp, NULL);
+  lilv_collection_insert(subtree, (LilvPluginClass*)plugin_class);
+  lilv_plugin_class_add_descendants(subtree, plugin_class);
+
+  // Returned list doesn't own plugins
+  LilvCollection* const       result  = lilv_plugins_new();
+  const LilvCollection* const plugins = world->plugins;
+  for (size_t i = 0U; i < plugins->size; ++i) {
+    LilvPlugin* const            plugin = (LilvPlugin*)plugins->elems[i];
+    const LilvPluginClass* const pclass = lilv_plugin_get_class(plugin);
+    if (lilv_collection_find(subtree, pclass)) {
+      lilv_collection_insert(result, plugin);
     }
   }
 
+  lilv_collection_free(subtree);
+  lilv_world_unlock(world);
   return result;
 }
@@ -3,15 +3,11 @@
 
 #include "lilv_internal.h"
 
-#include "lv2/atom/atom.h"
-#include "lv2/core/lv2.h"
-#include "lv2/event/event.h"
-
 #include "lilv/lilv.h"
 #include "sord/sord.h"
-#include "zix/tree.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -23,11 +19,14 @@ lilv_port_new(LilvWorld*      world,
               uint32_t        index,
               const char*     symbol)
 {
-  LilvPort* port = (LilvPort*)malloc(sizeof(LilvPort));
-  port->node     = lilv_node_new_from_node(world, node);
-  port->index    = index;
-  port->symbol   = lilv_node_new(world, LILV_VALUE_STRING, symbol);
-  port->classes  = lilv_nodes_new();
+  LilvPort* port    = (LilvPort*)malloc(sizeof(LilvPort));
+  port->node        = lilv_node_new_from_node(world, node);
+  port->index       = index;
+  port->symbol      = lilv_node_new(world, LILV_VALUE_STRING, symbol);
+  port->classes     = lilv_nodes_new();
+  port->flags       = 0U;
+  port->symbol_hash = 0U;
+  port->designation = NULL;
   return port;
 }
 
@@ -44,6 +43,74 @@ lilv_port_free(const LilvPlugin* plugin, LilvPort* port)
   }
 }
 
+/** Return the flag for a well-known port class, or zero. */
+static uint32_t
+lilv_port_class_flag(const LilvWorld* world, const SordNode* uri)
+{
+  // In the order of LilvPortFlag
+  const SordNode* const classes[] = {world->uris.lv2_InputPort,
+                                     world->uris.lv2_OutputPort,
+                                     world->uris.lv2_AudioPort,
+                                     world->uris.lv2_ControlPort,
+                                     world->uris.lv2_CVPort,
+                                     world->uris.atom_AtomPort,
+                                     world->uris.ev_EventPort};
+
+  for (uint32_t i = 0U; i < sizeof(classes) / sizeof(classes[0]); ++i) {
+    if (uri == classes[i]) {
+      return LILV_PORT_INPUT << i;
+    }
+  }
+
+  return 0U;
+}
+
+/** Return the flag for a well-known port property, or zero. */
+static uint32_t
+lilv_port_property_flag(const LilvWorld* world, const SordNode* uri)
+{
+  // In the order of LilvPortFlag
+  const SordNode* const properties[] = {world->uris.lv2_connectionOptional,
+                                        world->uris.lv2_enumeration,
+                                        world->uris.lv2_integer,
+                                        world->uris.lv2_reportsLatency,
+                                        world->uris.lv2_sampleRate,
+                                        world->uris.lv2_toggled};
+
+  for (uint32_t i = 0U; i < sizeof(properties) / sizeof(properties[0]); ++i) {
+    if (uri == properties[i]) {
+      return LILV_PORT_CONNECTION_OPTIONAL << i;
+    }
+  }
+
+  return 0U;
+}
+
+void
+lilv_port_load_flags(const LilvPlugin* plugin, LilvPort* port)
+{
+  LilvWorld* const world = plugin->world;
+
+  port->flags = 0U;
+  LILV_FOREACH (nodes, i, port->classes) {
+    const LilvNode* const port_class = lilv_nodes_get(port->classes, i);
+    port->flags |= lilv_port_class_flag(world, port_class->node);
+  }
+
+  LilvMatches        properties_matches;
+  LilvMatches* const properties = lilv_world_query_internal(
+    world,
+    port->node->node,
+    world->uris.lv2_portProperty,
+    NULL,
+    &properties_matches);
+  FOREACH_MATCHES (properties) {
+    const SordNode* property = lilv_matches_get_node(properties, SORD_OBJECT);
+    port->flags |= lilv_port_property_flag(world, property);
+  }
+  lilv_matches_close(properties);
+}
+
 bool
 lilv_port_is_a(const LilvPlugin* plugin,
                const LilvPort*   port,
@@ -51,6 +118,16 @@ lilv_port_is_a(const LilvPlugin* plugin,
 {
   (void)plugin;
 
+  if (!port_class) {
+    return false;
+  }
+
+  const uint32_t flag =
+    lilv_port_class_flag(port->node->world, port_class->node);
+  if (flag) {
+    return port->flags & flag;
+  }
+
   LILV_FOREACH (nodes, i, port->classes) {
     if (lilv_node_equals(lilv_nodes_get(port->classes, i), port_class)) {
       return true;
@@ -65,10 +142,22 @@ lilv_port_has_property(const LilvPlugin* plugin,
                        const LilvPort*   port,
                        const LilvNode*   property)
 {
-  return lilv_world_ask_internal(plugin->world,
-                                 port->node->node,
-                                 plugin->world->uris.lv2_portProperty,
-                                 property->node);
+  const uint32_t flag =
+    property ? lilv_port_property_flag(plugin->world, property->node) : 0U;
+  if (flag) {
+    return port->flags & flag;
+  }
+
+  lilv_world_lock(plugin->world);
+
+  const bool has_property =
+    lilv_world_ask_internal(plugin->world,
+                            port->node->node,
+                            plugin->world->uris.lv2_portProperty,
+                            property->node);
+
+  lilv_world_unlock(plugin->world);
+  return has_property;
 }
 
 bool
@@ -76,19 +165,33 @@ lilv_port_supports_event(const LilvPlugin* plugin,
                          const LilvPort*   port,
                          const LilvNode*   event_type)
 {
-  const uint8_t* predicates[] = {(const uint8_t*)LV2_EVENT__supportsEvent,
-                                 (const uint8_t*)LV2_ATOM__supports,
-                                 NULL};
-
-  for (const uint8_t** pred = predicates; *pred; ++pred) {
-    if (lilv_world_ask_internal(plugin->world,
-                                port->node->node,
-                                sord_new_uri(plugin->world->world, *pred),
-                                event_type->node)) {
-      return true;
-    }
+  const SordNode* predicates[] = {plugin->world->uris.ev_supportsEvent,
+                                  plugin->world->uris.atom_supports,
+                                  NULL};
+
+  bool found = false;
+  lilv_world_lock(plugin->world);
+  for (const SordNode** pred = predicates; *pred && !found; ++pred) {
+    found = lilv_world_ask_internal(
+      plugin->world, port->node->node, *pred, event_type->node);
   }
-  return false;
+  lilv_world_unlock(plugin->world);
+  return found;
+}
+
+static LilvNode*
+lilv_port_get_one(const LilvPlugin* plugin,
+                  const LilvPort*   port,
+                  const SordNode*   predicate)
+{
+  lilv_world_lock(plugin->world);
+
+  LilvNode* const value = lilv_node_new_from_node(
+    plugin->world,
+    lilv_world_get_translated(plugin->world, port->node->node, predicate));
+
+  lilv_world_unlock(plugin->world);
+  return value;
 }
 
 static LilvNodes*
@@ -96,8 +199,13 @@ lilv_port_get_value_by_node(const LilvPlugin* plugin,
                             const LilvPort*   port,
                             const SordNode*   predicate)
 {
-  return lilv_world_find_nodes_internal(
+  lilv_world_lock(plugin->world);
+
+  LilvNodes* const values = lilv_world_find_nodes_internal(
     plugin->world, port->node->node, predicate, NULL);
+
+  lilv_world_unlock(plugin->world);
+  return values;
 }
 
 const LilvNode*
@@ -122,18 +230,46 @@ lilv_port_get_value(const LilvPlugin* plugin,
   return lilv_port_get_value_by_node(plugin, port, predicate->node);
 }
 
+unsigned
+lilv_port_foreach_value(const LilvPlugin* plugin,
+                        const LilvPort*   port,
+                        const LilvNode*   predicate,
+                        LilvMatchFunc     func,
+                        void*             data)
+{
+  if (!lilv_node_is_uri(predicate)) {
+    LILV_ERRORF("Predicate `%s' is not a URI\n",
+                sord_node_get_string(predicate->node));
+    return 0U;
+  }
+
+  lilv_world_lock(plugin->world);
+
+  const unsigned n_values =
+    lilv_world_foreach_internal(plugin->world,
+                                port->node->node,
+                                predicate->node,
+                                NULL,
+                                plugin->world->opt.filter_language,
+                                func,
+                                data);
+
+  lilv_world_unlock(plugin->world);
+  return n_values;
+}
+
 LilvNode*
 lilv_port_get(const LilvPlugin* plugin,
               const LilvPort*   port,
               const LilvNode*   predicate)
 {
-  LilvNodes* values = lilv_port_get_value(plugin, port, predicate);
-
-  LilvNode* value =
-    lilv_node_duplicate(values ? lilv_nodes_get_first(values) : NULL);
+  if (!lilv_node_is_uri(predicate)) {
+    LILV_ERRORF("Predicate `%s' is not a URI\n",
+                sord_node_get_string(predicate->node));
+    return NULL;
+  }
 
-  lilv_nodes_free(values);
-  return value;
+  return lilv_port_get_one(plugin, port, predicate->node);
 }
 
 uint32_t
@@ -155,19 +291,11 @@ lilv_port_get_symbol(const LilvPlugin* plugin, const LilvPort* port)
 LilvNode*
 lilv_port_get_name(const LilvPlugin* plugin, const LilvPort* port)
 {
-  LilvNodes* results =
-    lilv_port_get_value_by_node(plugin, port, plugin->world->uris.lv2_name);
-
-  LilvNode* ret = NULL;
-  if (results) {
-    LilvNode* val = lilv_nodes_get_first(results);
-    if (lilv_node_is_string(val)) {
-      ret = lilv_node_duplicate(val);
-    }
-    lilv_nodes_free(results);
-  }
+  LilvNode* ret = lilv_port_get_one(plugin, port, plugin->world->uris.lv2_name);
 
-  if (!ret) {
+  if (!lilv_node_is_string(ret)) {
+    lilv_node_free(ret);
+    ret = NULL;
     LILV_WARNF("Plugin <%s> port has no (mandatory) doap:name\n",
                lilv_node_as_string(lilv_plugin_get_uri(plugin)));
   }
@@ -191,47 +319,102 @@ lilv_port_get_range(const LilvPlugin* plugin,
                     LilvNode**        max)
 {
   if (def) {
-    LilvNodes* defaults = lilv_port_get_value_by_node(
-      plugin, port, plugin->world->uris.lv2_default);
-    *def =
-      defaults ? lilv_node_duplicate(lilv_nodes_get_first(defaults)) : NULL;
-    lilv_nodes_free(defaults);
+    *def = lilv_port_get_one(plugin, port, plugin->world->uris.lv2_default);
   }
 
   if (min) {
-    LilvNodes* minimums = lilv_port_get_value_by_node(
-      plugin, port, plugin->world->uris.lv2_minimum);
-    *min =
-      minimums ? lilv_node_duplicate(lilv_nodes_get_first(minimums)) : NULL;
-    lilv_nodes_free(minimums);
+    *min = lilv_port_get_one(plugin, port, plugin->world->uris.lv2_minimum);
   }
 
   if (max) {
-    LilvNodes* maximums = lilv_port_get_value_by_node(
-      plugin, port, plugin->world->uris.lv2_maximum);
-    *max =
-      maximums ? lilv_node_duplicate(lilv_nodes_get_first(maximums)) : NULL;
-    lilv_nodes_free(maximums);
+    *max = lilv_port_get_one(plugin, port, plugin->world->uris.lv2_maximum);
   }
 }
 
+void
+lilv_port_get_range_values(const LilvPlugin*   plugin,
+                           const LilvPort*     port,
+                           LilvPortRange*      range,
+                           LilvPortScalePoint* points,
+                           uint32_t            n_points)
+{
+  LilvWorld* const world = plugin->world;
+
+  range->min            = NAN;
+  range->max            = NAN;
+  range->def            = NAN;
+  range->flags          = port->flags;
+  range->n_scale_points = 0U;
+
+  // Scan all statements about the port once, and use the first of each value
+  lilv_world_lock(world);
+
+  bool has_min = false;
+  bool has_max = false;
+  bool has_def = false;
+
+  LilvMatches        matches;
+  LilvMatches* const i =
+    lilv_world_query_internal(world, port->node->node, NULL, NULL, &matches);
+  FOREACH_MATCHES (i) {
+    const SordNode* const pred  = lilv_matches_get_node(i, SORD_PREDICATE);
+    const SordNode* const value = lilv_matches_get_node(i, SORD_OBJECT);
+    if (pred == world->uris.lv2_minimum && !has_min) {
+      range->min = lilv_literal_as_float(world, value);
+      has_min    = true;
+    } else if (pred == world->uris.lv2_maximum && !has_max) {
+      range->max = lilv_literal_as_float(world, value);
+      has_max    = true;
+    } else if (pred == world->uris.lv2_default && !has_def) {
+      range->def = lilv_literal_as_float(world, value);
+      has_def    = true;
+    } else if (pred == world->uris.lv2_scalePoint) {
+      const SordNode* const point_value =
+        lilv_world_get_internal(world, value, world->uris.rdf_value, NULL);
+      const SordNode* const point_label =
+        lilv_world_get_translated(world, value, world->uris.rdfs_label);
+
+      // Skip incomplete points, like lilv_port_get_scale_points()
+      if (point_value && point_label) {
+        if (range->n_scale_points < n_points) {
+          LilvPortScalePoint* const point = &points[range->n_scale_points];
+
+          point->value = lilv_literal_as_float(world, point_value);
+          point->label = (const char*)sord_node_get_string(point_label);
+        }
+
+        ++range->n_scale_points;
+      }
+    }
+  }
+  lilv_matches_close(i);
+
+  lilv_world_unlock(world);
+}
+
 LilvScalePoints*
 lilv_port_get_scale_points(const LilvPlugin* plugin, const LilvPort* port)
 {
-  SordIter* points = lilv_world_query_internal(
+  lilv_world_lock(plugin->world);
+
+  LilvMatches  points_matches;
+  LilvMatches* points = lilv_world_query_internal(
     plugin->world,
     port->node->node,
-    sord_new_uri(plugin->world->world, (const uint8_t*)LV2_CORE__scalePoint),
-    NULL);
+    plugin->world->uris.lv2_scalePoint,
+    NULL,
+    &points_matches);
 
-  if (sord_iter_end(points)) {
+  if (lilv_matches_end(points)) {
+    lilv_matches_close(points);
+    lilv_world_unlock(plugin->world);
     return NULL;
   }
 
   LilvScalePoints* ret = lilv_scale_points_new();
 
-  FOREACH_MATCH (points) {
-    const SordNode* point = sord_iter_get_node(points, SORD_OBJECT);
+  FOREACH_MATCHES (points) {
+    const SordNode* point = lilv_matches_get_node(points, SORD_OBJECT);
 
     LilvNode* value =
       lilv_plugin_get_unique(plugin, point, plugin->world->uris.rdf_value);
@@ -240,10 +423,14 @@ lilv_port_get_scale_points(const LilvPlugin* plugin, const LilvPort* port)
       lilv_plugin_get_unique(plugin, point, plugin->world->uris.rdfs_label);
 
     if (value && label) {
-      zix_tree_insert((ZixTree*)ret, lilv_scale_point_new(value, label), NULL);
+      lilv_collection_insert(ret, lilv_scale_point_new(value, label));
+    } else {
+      lilv_node_free(label);
+      lilv_node_free(value);
     }
   }
-  sord_iter_free(points);
+  lilv_matches_close(points);
+  lilv_world_unlock(plugin->world);
 
   assert(lilv_nodes_size(ret) > 0);
   return ret;
@@ -252,9 +439,6 @@ lilv_port_get_scale_points(const LilvPlugin* plugin, const LilvPort* port)
 LilvNodes*
 lilv_port_get_properties(const LilvPlugin* plugin, const LilvPort* port)
 {
-  LilvNode* pred = lilv_node_new_from_node(
-    plugin->world, plugin->world->uris.lv2_portProperty);
-  LilvNodes* ret = lilv_port_get_value(plugin, port, pred);
-  lilv_node_free(pred);
-  return ret;
+  return lilv_port_get_value_by_node(
+    plugin, port, plugin->world->uris.lv2_portProperty);
 }
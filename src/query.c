@@ -7,6 +7,8 @@
 #include "sord/sord.h"
 #include "zix/tree.h"
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -41,15 +43,15 @@ lilv_lang_matches(const char* a, const char* b)
 
 static LilvNodes*
 lilv_nodes_from_stream_objects_i18n(LilvWorld*    world,
-                                    SordIter*     stream,
+                                    LilvMatches*  stream,
                                     SordQuadIndex field)
 {
   LilvNodes*      values  = lilv_nodes_new();
   const SordNode* nolang  = NULL; // Untranslated value
   const SordNode* partial = NULL; // Partial language match
-  char*           syslang = lilv_get_lang();
-  FOREACH_MATCH (stream) {
-    const SordNode* value = sord_iter_get_node(stream, field);
+  const char*     syslang = lilv_world_get_lang(world);
+  FOREACH_MATCHES (stream) {
+    const SordNode* value = lilv_matches_get_node(stream, field);
     if (sord_node_get_type(value) == SORD_LITERAL) {
       const char* lang = sord_node_get_language(value);
 
@@ -59,8 +61,7 @@ lilv_nodes_from_stream_objects_i18n(LilvWorld*    world,
         switch (lilv_lang_matches(lang, syslang)) {
         case LILV_LANG_MATCH_EXACT:
           // Exact language match, add to results
-          zix_tree_insert(
-            (ZixTree*)values, lilv_node_new_from_node(world, value), NULL);
+          lilv_collection_insert(values, lilv_node_new_from_node(world, value));
           break;
         case LILV_LANG_MATCH_PARTIAL:
           // Partial language match, save in case we find no exact
@@ -71,12 +72,10 @@ lilv_nodes_from_stream_objects_i18n(LilvWorld*    world,
         }
       }
     } else {
-      zix_tree_insert(
-        (ZixTree*)values, lilv_node_new_from_node(world, value), NULL);
+      lilv_collection_insert(values, lilv_node_new_from_node(world, value));
     }
   }
-  sord_iter_free(stream);
-  free(syslang);
+  lilv_matches_close(stream);
 
   if (lilv_nodes_size(values) > 0) {
     return values;
@@ -88,8 +87,7 @@ lilv_nodes_from_stream_objects_i18n(LilvWorld*    world,
   }
 
   if (best) {
-    zix_tree_insert(
-      (ZixTree*)values, lilv_node_new_from_node(world, best), NULL);
+    lilv_collection_insert(values, lilv_node_new_from_node(world, best));
   } else {
     // No matches whatsoever
     lilv_nodes_free(values);
@@ -99,13 +97,58 @@ lilv_nodes_from_stream_objects_i18n(LilvWorld*    world,
   return values;
 }
 
+const SordNode*
+lilv_world_get_translated(LilvWorld*      world,
+                          const SordNode* subject,
+                          const SordNode* predicate)
+{
+  const char* const  lang = lilv_world_get_lang(world);
+  LilvMatches        stream_matches;
+  LilvMatches* const stream =
+    lilv_world_query_internal(world, subject, predicate, NULL, &stream_matches);
+
+  const SordNode* result  = NULL;
+  const SordNode* nolang  = NULL; // Untranslated value
+  const SordNode* partial = NULL; // Partial language match
+  for (; !result && !lilv_matches_end(stream); lilv_matches_next(stream)) {
+    const SordNode* value = lilv_matches_get_node(stream, SORD_OBJECT);
+    if (!world->opt.filter_language ||
+        sord_node_get_type(value) != SORD_LITERAL) {
+      result = value;
+    } else if (!sord_node_get_language(value)) {
+      nolang = value;
+    } else {
+      switch (lilv_lang_matches(sord_node_get_language(value), lang)) {
+      case LILV_LANG_MATCH_EXACT:
+        result = value;
+        break;
+      case LILV_LANG_MATCH_PARTIAL:
+        partial = value;
+        break;
+      case LILV_LANG_MATCH_NONE:
+        break;
+      }
+    }
+  }
+  lilv_matches_close(stream);
+
+  if (!result) {
+    result = nolang;
+    if ((lang && partial) || !result) {
+      result = partial;
+    }
+  }
+
+  return result;
+}
+
 LilvNodes*
 lilv_nodes_from_stream_objects(LilvWorld*    world,
-                               SordIter*     stream,
+                               LilvMatches*  stream,
                                SordQuadIndex field)
 {
-  if (sord_iter_end(stream)) {
-    sord_iter_free(stream);
+  if (lilv_matches_end(stream)) {
+    lilv_matches_close(stream);
     return NULL;
   }
 
@@ -114,13 +157,668 @@ lilv_nodes_from_stream_objects(LilvWorld*    world,
   }
 
   LilvNodes* values = lilv_nodes_new();
-  FOREACH_MATCH (stream) {
-    const SordNode* value = sord_iter_get_node(stream, field);
+  FOREACH_MATCHES (stream) {
+    const SordNode* value = lilv_matches_get_node(stream, field);
     LilvNode*       node  = lilv_node_new_from_node(world, value);
     if (node) {
-      zix_tree_insert((ZixTree*)values, node, NULL);
+      lilv_collection_insert(values, node);
     }
   }
-  sord_iter_free(stream);
+  lilv_matches_close(stream);
   return values;
 }
+
+/** Call `func` with borrowed views of the nodes in a statement. */
+static int
+lilv_match_emit(LilvWorld*      world,
+                const SordNode* subject,
+                const SordNode* predicate,
+                const SordNode* object,
+                LilvMatchFunc   func,
+                void*           data)
+{
+  LilvNode s;
+  LilvNode p;
+  LilvNode o;
+
+  return func(data,
+              lilv_node_view(world, subject, &s),
+              lilv_node_view(world, predicate, &p),
+              lilv_node_view(world, object, &o));
+}
+
+unsigned
+lilv_world_foreach_internal(LilvWorld*      world,
+                            const SordNode* subject,
+                            const SordNode* predicate,
+                            const SordNode* object,
+                            const bool      translate,
+                            LilvMatchFunc   func,
+                            void*           data)
+{
+  const char* const  lang = translate ? lilv_world_get_lang(world) : NULL;
+  LilvMatches        matches;
+  LilvMatches* const i =
+    lilv_world_query_internal(world, subject, predicate, object, &matches);
+
+  unsigned        n_matches = 0U;
+  bool            stop      = false;
+  const SordNode* nolang    = NULL; // Untranslated value
+  const SordNode* partial   = NULL; // Partial language match
+  for (; !stop && !lilv_matches_end(i); lilv_matches_next(i)) {
+    SordQuad quad;
+    lilv_matches_get(i, quad);
+
+    const SordNode* const value = quad[SORD_OBJECT];
+    if (translate && sord_node_get_type(value) == SORD_LITERAL) {
+      const char* const value_lang = sord_node_get_language(value);
+      if (!value_lang) {
+        nolang = value;
+        continue;
+      }
+
+      const LilvLangMatch match = lilv_lang_matches(value_lang, lang);
+      if (match == LILV_LANG_MATCH_PARTIAL) {
+        partial = value;
+      }
+
+      if (match != LILV_LANG_MATCH_EXACT) {
+        continue;
+      }
+    }
+
+    ++n_matches;
+    stop = lilv_match_emit(world, quad[0], quad[1], quad[2], func, data);
+  }
+  lilv_matches_close(i);
+
+  if (!stop && translate && !n_matches) {
+    // No exact matches, so use the best translation if there is one
+    const SordNode* const best =
+      ((lang && partial) || !nolang) ? partial : nolang;
+    if (best) {
+      ++n_matches;
+      lilv_match_emit(world, subject, predicate, best, func, data);
+    }
+  }
+
+  return n_matches;
+}
+
+static int
+lilv_query_result_cmp(const void* a, const void* b, const void* user_data)
+{
+  (void)user_data;
+
+  const LilvQueryResult* const qa = (const LilvQueryResult*)a;
+  const LilvQueryResult* const qb = (const LilvQueryResult*)b;
+
+  // Nodes are interned, so patterns can be ordered by address
+  const uintptr_t ka[] = {(uintptr_t)qa->kind,
+                          (uintptr_t)qa->subject,
+                          (uintptr_t)qa->predicate,
+                          (uintptr_t)qa->object};
+  const uintptr_t kb[] = {(uintptr_t)qb->kind,
+                          (uintptr_t)qb->subject,
+                          (uintptr_t)qb->predicate,
+                          (uintptr_t)qb->object};
+
+  for (unsigned i = 0U; i < sizeof(ka) / sizeof(ka[0]); ++i) {
+    if (ka[i] != kb[i]) {
+      return ka[i] < kb[i] ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+static void
+lilv_query_result_free(void* ptr, const void* user_data)
+{
+  LilvWorld* const       world = (LilvWorld*)user_data;
+  LilvQueryResult* const query = (LilvQueryResult*)ptr;
+
+  sord_node_free(world->world, (SordNode*)query->subject);
+  sord_node_free(world->world, (SordNode*)query->predicate);
+  sord_node_free(world->world, (SordNode*)query->object);
+  lilv_nodes_free(query->nodes);
+  lilv_node_free(query->node);
+  free(query);
+}
+
+static LilvNodes*
+lilv_nodes_copy(const LilvNodes* nodes)
+{
+  if (!nodes) {
+    return NULL;
+  }
+
+  LilvNodes* const copy = lilv_nodes_new();
+  LILV_FOREACH (nodes, i, nodes) {
+    lilv_collection_insert(copy,
+                           lilv_node_duplicate(lilv_nodes_get(nodes, i)));
+  }
+
+  return copy;
+}
+
+ZixTree*
+lilv_query_cache_new(LilvWorld* world)
+{
+  return zix_tree_new(NULL,
+                      false,
+                      lilv_query_result_cmp,
+                      NULL,
+                      lilv_query_result_free,
+                      world);
+}
+
+bool
+lilv_world_find_query(LilvWorld* world, LilvQueryResult* query)
+{
+  lilv_world_lock_caches(world);
+  if (!world->queries) {
+    lilv_world_unlock_caches(world);
+    return false;
+  }
+
+  // Discard all results if the model or language has changed since
+  lilv_world_get_lang(world);
+  if (world->queries_epoch != world->epoch) {
+    zix_tree_free(world->queries);
+    world->queries       = lilv_query_cache_new(world);
+    world->queries_epoch = world->epoch;
+  }
+
+  ZixTreeIter* i = NULL;
+  if (zix_tree_find(world->queries, query, &i)) {
+    ++world->n_query_misses;
+    lilv_world_unlock_caches(world);
+    return false;
+  }
+
+  const LilvQueryResult* const cached = (LilvQueryResult*)zix_tree_get(i);
+
+  query->nodes = lilv_nodes_copy(cached->nodes);
+  query->node  = lilv_node_duplicate(cached->node);
+  query->found = cached->found;
+  ++world->n_query_hits;
+  lilv_world_unlock_caches(world);
+  return true;
+}
+
+void
+lilv_world_add_query(LilvWorld* world, const LilvQueryResult* query)
+{
+  lilv_world_lock_caches(world);
+  if (!world->queries || world->queries_epoch != world->epoch) {
+    lilv_world_unlock_caches(world);
+    return;
+  }
+
+  // Discard all results when full, so the cache can't grow without bound
+  if (zix_tree_size(world->queries) >= world->max_queries) {
+    zix_tree_free(world->queries);
+    world->queries = lilv_query_cache_new(world);
+  }
+
+  LilvQueryResult* const cached =
+    (LilvQueryResult*)malloc(sizeof(LilvQueryResult));
+
+  cached->kind      = query->kind;
+  cached->subject   = sord_node_copy(query->subject);
+  cached->predicate = sord_node_copy(query->predicate);
+  cached->object    = sord_node_copy(query->object);
+  cached->nodes     = lilv_nodes_copy(query->nodes);
+  cached->node      = lilv_node_duplicate(query->node);
+  cached->found     = query->found;
+
+  if (zix_tree_insert(world->queries, cached, NULL)) {
+    lilv_query_result_free(cached, world);
+  }
+  lilv_world_unlock_caches(world);
+}
+
+/** A term in a query pattern, which is either a node or a variable. */
+typedef struct {
+  SordNode* node; ///< Node to match, or NULL for a variable
+  uint32_t  var;  ///< Index of variable if node is NULL
+} LilvPatternTerm;
+
+typedef struct {
+  LilvPatternTerm terms[3]; ///< Subject, predicate, and object
+} LilvPattern;
+
+struct LilvQueryImpl {
+  LilvWorld*   world;
+  LilvPattern* patterns;    ///< Patterns in the order they were added
+  uint32_t     n_patterns;  ///< Number of patterns
+  uint32_t     n_variables; ///< One more than the highest variable index
+};
+
+/** The state of a running query. */
+typedef struct {
+  const LilvQuery*    query;
+  const LilvPattern** order;  ///< Patterns in the order they are matched
+  const SordNode**    values; ///< Current value of each variable, or NULL
+  const LilvNode**    row;    ///< Row passed to the sink
+  LilvNode*           views;  ///< Storage for views of values in the row
+  LilvQuerySink       sink;
+  void*               handle;
+  unsigned            n_results;
+  bool                stop;
+} LilvJoin;
+
+LilvQuery*
+lilv_query_new(LilvWorld* world)
+{
+  LilvQuery* const query = (LilvQuery*)calloc(1, sizeof(LilvQuery));
+
+  query->world = world;
+  return query;
+}
+
+void
+lilv_query_free(LilvQuery* query)
+{
+  if (!query) {
+    return;
+  }
+
+  lilv_world_lock(query->world);
+  lilv_world_lock_caches(query->world);
+  for (uint32_t i = 0U; i < query->n_patterns; ++i) {
+    for (unsigned t = 0U; t < 3U; ++t) {
+      sord_node_free(query->world->world, query->patterns[i].terms[t].node);
+    }
+  }
+  lilv_world_unlock_caches(query->world);
+  lilv_world_unlock(query->world);
+
+  free(query->patterns);
+  free(query);
+}
+
+int
+lilv_query_add_pattern(LilvQuery*    query,
+                       LilvQueryTerm subject,
+                       LilvQueryTerm predicate,
+                       LilvQueryTerm object)
+{
+  if (predicate.node && !lilv_node_is_uri(predicate.node)) {
+    LILV_ERRORF("Predicate `%s' is not a URI\n",
+                sord_node_get_string(predicate.node->node));
+    return 1;
+  }
+
+  const LilvQueryTerm terms[] = {subject, predicate, object};
+  for (unsigned t = 0U; t < 3U; ++t) {
+    if (!terms[t].node && terms[t].var >= LILV_MAX_QUERY_VARIABLES) {
+      LILV_ERRORF("Variable index %u is too large\n", (unsigned)terms[t].var);
+      return 1;
+    }
+  }
+
+  LilvPattern* const patterns = (LilvPattern*)realloc(
+    query->patterns, (query->n_patterns + 1U) * sizeof(LilvPattern));
+  if (!patterns) {
+    return 1;
+  }
+
+  LilvPattern* const pattern = &patterns[query->n_patterns];
+  lilv_world_lock(query->world);
+  lilv_world_lock_caches(query->world);
+  for (unsigned t = 0U; t < 3U; ++t) {
+    if (terms[t].node) {
+      pattern->terms[t].node = sord_node_copy(terms[t].node->node);
+      pattern->terms[t].var  = 0U;
+    } else {
+      pattern->terms[t].node = NULL;
+      pattern->terms[t].var  = terms[t].var;
+      if (terms[t].var >= query->n_variables) {
+        query->n_variables = terms[t].var + 1U;
+      }
+    }
+  }
+  lilv_world_unlock_caches(query->world);
+  lilv_world_unlock(query->world);
+
+  query->patterns = patterns;
+  ++query->n_patterns;
+  return 0;
+}
+
+uint32_t
+lilv_query_get_n_variables(const LilvQuery* query)
+{
+  return query->n_variables;
+}
+
+/**
+   Return how cheaply `pattern` can be matched once `bound` variables are known.
+
+   The model has SPO and OPS indices, so a pattern with a known subject or
+   object is a range scan, and every other known term narrows that range.  A
+   pattern with neither is a scan of the whole model.
+*/
+static unsigned
+lilv_pattern_score(const LilvPattern* pattern, const bool* bound)
+{
+  bool known[3];
+  for (unsigned t = 0U; t < 3U; ++t) {
+    const LilvPatternTerm* const term = &pattern->terms[t];
+    known[t] = term->node || bound[term->var];
+  }
+
+  const unsigned n_known = (unsigned)known[0] + known[1] + known[2];
+  return (known[0] || known[2]) ? 3U + n_known : n_known;
+}
+
+/** Order patterns so each one is as cheap as possible given the previous. */
+static void
+lilv_query_order(const LilvQuery* query, const LilvPattern** order, bool* bound)
+{
+  for (uint32_t i = 0U; i < query->n_patterns; ++i) {
+    order[i] = NULL;
+  }
+
+  for (uint32_t n = 0U; n < query->n_patterns; ++n) {
+    const LilvPattern* best       = NULL;
+    unsigned           best_score = 0U;
+    for (uint32_t i = 0U; i < query->n_patterns; ++i) {
+      const LilvPattern* const pattern = &query->patterns[i];
+
+      bool used = false;
+      for (uint32_t j = 0U; j < n && !used; ++j) {
+        used = order[j] == pattern;
+      }
+
+      const unsigned score = used ? 0U : lilv_pattern_score(pattern, bound);
+      if (!used && (!best || score > best_score)) {
+        best       = pattern;
+        best_score = score;
+      }
+    }
+
+    order[n] = best;
+    for (unsigned t = 0U; t < 3U; ++t) {
+      if (!best->terms[t].node) {
+        bound[best->terms[t].var] = true;
+      }
+    }
+  }
+}
+
+static void
+lilv_join_emit(LilvJoin* join)
+{
+  LilvWorld* const world       = join->query->world;
+  const uint32_t   n_variables = join->query->n_variables;
+
+  for (uint32_t v = 0U; v < n_variables; ++v) {
+    join->row[v] = lilv_node_view(world, join->values[v], &join->views[v]);
+  }
+
+  ++join->n_results;
+  join->stop = join->sink(join->handle, join->row);
+}
+
+/** Match the pattern at `depth`, and every pattern after it, recursively. */
+static void
+lilv_join(LilvJoin* join, const uint32_t depth)
+{
+  if (depth == join->query->n_patterns) {
+    lilv_join_emit(join);
+    return;
+  }
+
+  const LilvPattern* const pattern = join->order[depth];
+  const SordNode*          search[3];
+  bool                     binds[3];
+  for (unsigned t = 0U; t < 3U; ++t) {
+    const LilvPatternTerm* const term = &pattern->terms[t];
+
+    search[t] = term->node ? term->node : join->values[term->var];
+    binds[t]  = !search[t];
+  }
+
+  LilvMatches        matches;
+  LilvMatches* const i = lilv_world_query_internal(
+    join->query->world, search[0], search[1], search[2], &matches);
+
+  for (; !join->stop && !lilv_matches_end(i); lilv_matches_next(i)) {
+    SordQuad quad;
+    lilv_matches_get(i, quad);
+
+    // Bind new variables, checking that repeated ones have the same value
+    bool match = true;
+    for (unsigned t = 0U; t < 3U; ++t) {
+      if (binds[t]) {
+        const SordNode** const value = &join->values[pattern->terms[t].var];
+        if (!*value) {
+          *value = quad[t];
+        } else {
+          match = match && *value == quad[t];
+        }
+      }
+    }
+
+    if (match) {
+      lilv_join(join, depth + 1U);
+    }
+
+    for (unsigned t = 0U; t < 3U; ++t) {
+      if (binds[t]) {
+        join->values[pattern->terms[t].var] = NULL;
+      }
+    }
+  }
+
+  lilv_matches_close(i);
+}
+
+unsigned
+lilv_query_run(LilvQuery* query, LilvQuerySink sink, void* handle)
+{
+  if (!query->n_patterns) {
+    return 0U;
+  }
+
+  // Load any lazy specifications that the query refers to
+  lilv_world_lock(query->world);
+  for (uint32_t i = 0U; i < query->n_patterns; ++i) {
+    lilv_world_load_specs_for(query->world, query->patterns[i].terms[0].node);
+    lilv_world_load_specs_for(query->world, query->patterns[i].terms[2].node);
+  }
+
+  // Allocate at least one variable so a query without any is not a special case
+  const size_t n_vars = query->n_variables + 1U;
+
+  LilvJoin join = {query, NULL, NULL, NULL, NULL, sink, handle, 0U, false};
+
+  join.order  = (const LilvPattern**)calloc(query->n_patterns,
+                                           sizeof(const LilvPattern*));
+  join.values = (const SordNode**)calloc(n_vars, sizeof(const SordNode*));
+  join.row    = (const LilvNode**)calloc(n_vars, sizeof(const LilvNode*));
+  join.views  = (LilvNode*)calloc(n_vars, sizeof(LilvNode));
+
+  bool* const bound = (bool*)calloc(n_vars, sizeof(bool));
+  if (join.order && join.values && join.row && join.views && bound) {
+    lilv_query_order(query, join.order, bound);
+    lilv_join(&join, 0U);
+  }
+
+  lilv_world_unlock(query->world);
+  free(bound);
+  free(join.views);
+  free(join.row);
+  free(join.values);
+  free(join.order);
+  return join.n_results;
+}
+
+struct LilvPreparedQueryImpl {
+  LilvWorld* world;
+  SordNode*  predicate;
+  SordNode*  object;   ///< Object to match, or NULL to get objects
+  LilvNode*  values;   ///< Views written by the last run
+  uint32_t   n_values; ///< Size of values array
+};
+
+LilvPreparedQuery*
+lilv_prepared_query_new(LilvWorld*      world,
+                        const LilvNode* predicate,
+                        const LilvNode* object)
+{
+  if (!lilv_node_is_uri(predicate)) {
+    LILV_ERRORF("Predicate `%s' is not a URI\n",
+                predicate ? sord_node_get_string(predicate->node)
+                          : (const uint8_t*)"(null)");
+    return NULL;
+  }
+
+  LilvPreparedQuery* const query =
+    (LilvPreparedQuery*)calloc(1, sizeof(LilvPreparedQuery));
+
+  lilv_world_lock(world);
+  lilv_world_load_specs_for(world, object ? object->node : NULL);
+
+  lilv_world_lock_caches(world);
+  query->world     = world;
+  query->predicate = sord_node_copy(predicate->node);
+  query->object    = object ? sord_node_copy(object->node) : NULL;
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
+  return query;
+}
+
+void
+lilv_prepared_query_free(LilvPreparedQuery* query)
+{
+  if (!query) {
+    return;
+  }
+
+  lilv_world_lock(query->world);
+  lilv_world_lock_caches(query->world);
+  sord_node_free(query->world->world, query->object);
+  sord_node_free(query->world->world, query->predicate);
+  lilv_world_unlock_caches(query->world);
+  lilv_world_unlock(query->world);
+  free(query->values);
+  free(query);
+}
+
+/**
+   Set the value at `index` in the result of a prepared query.
+
+   The value is always a view in a slot of the query, so running a query
+   doesn't allocate any nodes, and the value stays valid until the next run
+   even if the caller frees an equal interned node.
+*/
+static void
+lilv_prepared_query_set(LilvPreparedQuery* query,
+                        const LilvNode**   values,
+                        uint32_t           n_values,
+                        uint32_t           index,
+                        const SordNode*    value)
+{
+  if (index < n_values) {
+    values[index] =
+      lilv_node_init_view(query->world, value, &query->values[index]);
+  }
+}
+
+/** Run a prepared query while the world is locked. */
+static uint32_t
+lilv_prepared_query_run_locked(LilvPreparedQuery* query,
+                               const LilvNode*    subject,
+                               const LilvNode**   values,
+                               uint32_t           n_values)
+{
+  LilvWorld* const world = query->world;
+
+  lilv_world_load_specs_for(world, subject->node);
+
+  if (query->object) {
+    // Only report existence, since a statement may match once for each graph
+    return lilv_world_ask_internal(
+             world, subject->node, query->predicate, query->object)
+             ? 1U
+             : 0U;
+  }
+
+  LilvMatches        matches;
+  LilvMatches* const i = lilv_world_query_internal(
+    world, subject->node, query->predicate, NULL, &matches);
+
+  uint32_t n = 0U;
+
+  if (n_values > query->n_values) {
+    LilvNode* const slots =
+      (LilvNode*)realloc(query->values, n_values * sizeof(LilvNode));
+    if (!slots) {
+      lilv_matches_close(i);
+      return 0U;
+    }
+
+    query->values   = slots;
+    query->n_values = n_values;
+  }
+
+  const char* const lang    = lilv_world_get_lang(world);
+  const SordNode*   nolang  = NULL; // Untranslated value
+  const SordNode*   partial = NULL; // Partial language match
+  FOREACH_MATCHES (i) {
+    const SordNode* const value = lilv_matches_get_node(i, SORD_OBJECT);
+    if (!world->opt.filter_language ||
+        sord_node_get_type(value) != SORD_LITERAL) {
+      lilv_prepared_query_set(query, values, n_values, n++, value);
+    } else if (!sord_node_get_language(value)) {
+      nolang = value;
+    } else {
+      switch (lilv_lang_matches(sord_node_get_language(value), lang)) {
+      case LILV_LANG_MATCH_EXACT:
+        lilv_prepared_query_set(query, values, n_values, n++, value);
+        break;
+      case LILV_LANG_MATCH_PARTIAL:
+        partial = value;
+        break;
+      case LILV_LANG_MATCH_NONE:
+        break;
+      }
+    }
+  }
+  lilv_matches_close(i);
+
+  if (!n) {
+    // No exact matches, so use the best translation if there is one
+    const SordNode* const best =
+      ((lang && partial) || !nolang) ? partial : nolang;
+    if (best) {
+      lilv_prepared_query_set(query, values, n_values, n++, best);
+    }
+  }
+
+  return n;
+}
+
+uint32_t
+lilv_prepared_query_run(LilvPreparedQuery* query,
+                        const LilvNode*    subject,
+                        const LilvNode**   values,
+                        uint32_t           n_values)
+{
+  if (!subject) {
+    LILV_ERROR("Prepared query run without a subject\n");
+    return 0U;
+  }
+
+  lilv_world_lock(query->world);
+
+  const uint32_t n =
+    lilv_prepared_query_run_locked(query, subject, values, n_values);
+
+  lilv_world_unlock(query->world);
+  return n;
+}
@@ -447,7 +447,6 @@ lilv_state_new_from_instance(const LilvPlugin*         plugin,
                              const LV2_Feature* const* features)
 {
   const LV2_Feature** sfeatures = NULL;
-  LilvWorld* const    world     = plugin->world;
   LilvState* const    state     = (LilvState*)calloc(1, sizeof(LilvState));
   state->plugin_uri  = lilv_node_duplicate(lilv_plugin_get_uri(plugin));
   state->abs2rel     = zix_tree_new(NULL, false, abs_cmp, NULL, map_free, NULL);
@@ -469,12 +468,10 @@ lilv_state_new_from_instance(const LilvPlugin*         plugin,
 
   // Store port values
   if (get_value) {
-    LilvNode* lv2_ControlPort = lilv_new_uri(world, LILV_URI_CONTROL_PORT);
-    LilvNode* lv2_InputPort   = lilv_new_uri(world, LILV_URI_INPUT_PORT);
+    const uint32_t control_input = LILV_PORT_CONTROL | LILV_PORT_INPUT;
     for (uint32_t i = 0; i < plugin->num_ports; ++i) {
       const LilvPort* const port = plugin->ports[i];
-      if (lilv_port_is_a(plugin, port, lv2_ControlPort) &&
-          lilv_port_is_a(plugin, port, lv2_InputPort)) {
+      if ((port->flags & control_input) == control_input) {
         uint32_t    size  = 0;
         uint32_t    type  = 0;
         const char* sym   = lilv_node_as_string(port->symbol);
@@ -482,8 +479,6 @@ lilv_state_new_from_instance(const LilvPlugin*         plugin,
         append_port_value(state, sym, value, size, type);
       }
     }
-    lilv_node_free(lv2_ControlPort);
-    lilv_node_free(lv2_InputPort);
   }
 
   // Store properties
@@ -673,8 +668,8 @@ new_state_from_model(LilvWorld*      world,
   sord_iter_free(ports);
 
   // Get properties
-  SordNode* statep     = sord_new_uri(world->world, USTR(LV2_STATE__state));
-  SordNode* state_node = sord_get(model, node, statep, NULL, NULL);
+  SordNode* state_node =
+    sord_get(model, node, world->uris.state_state, NULL, NULL);
   if (state_node) {
     SordIter* props = sord_search(model, state_node, 0, 0, 0);
     FOREACH_MATCH (props) {
@@ -709,7 +704,6 @@ new_state_from_model(LilvWorld*      world,
     sord_iter_free(props);
   }
   sord_node_free(world->world, state_node);
-  sord_node_free(world->world, statep);
 
   serd_free((void*)chunk.buf);
   sratom_free(sratom);
@@ -724,6 +718,30 @@ new_state_from_model(LilvWorld*      world,
   return state;
 }
 
+/** Copy the statements about `node`, and any blank nodes it refers to. */
+static void
+copy_description(LilvWorld* world, SordModel* model, const SordNode* node)
+{
+  LilvMatches        matches;
+  LilvMatches* const i =
+    lilv_world_query_internal(world, node, NULL, NULL, &matches);
+  FOREACH_MATCHES (i) {
+    SordQuad quad;
+    lilv_matches_get(i, quad);
+
+    const SordNode* const object = quad[SORD_OBJECT];
+    const bool            nested =
+      sord_node_get_type(object) == SORD_BLANK &&
+      !sord_ask(model, object, NULL, NULL, NULL);
+
+    sord_add(model, quad);
+    if (nested) {
+      copy_description(world, model, object);
+    }
+  }
+  lilv_matches_close(i);
+}
+
 LilvState*
 lilv_state_new_from_world(LilvWorld*      world,
                           LV2_URID_Map*   map,
@@ -735,7 +753,24 @@ lilv_state_new_from_world(LilvWorld*      world,
     return NULL;
   }
 
-  return new_state_from_model(world, map, world->model, node->node, NULL);
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+
+  LilvState* state = NULL;
+  if (world->store) {
+    // Sratom reads from a model, so make one with only this description
+    SordModel* const model = sord_new(world->world, SORD_SPO, false);
+
+    copy_description(world, model, node->node);
+    state = new_state_from_model(world, map, model, node->node, NULL);
+    sord_free(model);
+  } else {
+    state = new_state_from_model(world, map, world->model, node->node, NULL);
+  }
+
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
+  return state;
 }
 
 LilvState*
@@ -750,13 +785,16 @@ lilv_state_new_from_file(LilvWorld*      world,
     return NULL;
   }
 
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+
   uint8_t*    abs_path = (uint8_t*)zix_canonical_path(NULL, path);
   SerdNode    node     = serd_node_new_file_uri(abs_path, NULL, NULL, true);
   SerdEnv*    env      = serd_env_new(&node);
   SordModel*  model    = sord_new(world->world, SORD_SPO, false);
   SerdReader* reader   = sord_new_reader(model, env, SERD_TURTLE, NULL);
 
-  serd_reader_read_file(reader, node.buf);
+  lilv_reader_read_file(reader, node.buf);
 
   SordNode* subject_node =
     (subject) ? subject->node
@@ -777,6 +815,8 @@ lilv_state_new_from_file(LilvWorld*      world,
   serd_reader_free(reader);
   sord_free(model);
   serd_env_free(env);
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
   return state;
 }
 
@@ -800,6 +840,9 @@ lilv_state_new_from_string(LilvWorld* world, LV2_URID_Map* map, const char* str)
     return NULL;
   }
 
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+
   SerdNode    base   = SERD_NODE_NULL;
   SerdEnv*    env    = serd_env_new(&base);
   SordModel*  model  = sord_new(world->world, SORD_SPO | SORD_OPS, false);
@@ -808,17 +851,18 @@ lilv_state_new_from_string(LilvWorld* world, LV2_URID_Map* map, const char* str)
   set_prefixes(env);
   serd_reader_read_string(reader, USTR(str));
 
-  SordNode* o = sord_new_uri(world->world, USTR(LV2_PRESETS__Preset));
-  SordNode* s = sord_get(model, NULL, world->uris.rdf_a, o, NULL);
+  SordNode* s =
+    sord_get(model, NULL, world->uris.rdf_a, world->uris.pset_Preset, NULL);
 
   LilvState* state = new_state_from_model(world, map, model, s, NULL);
 
   sord_node_free(world->world, s);
-  sord_node_free(world->world, o);
   serd_reader_free(reader);
   sord_free(model);
   serd_env_free(env);
 
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
   return state;
 }
 
@@ -937,7 +981,7 @@ add_state_to_manifest(LilvWorld*      lworld,
   if (zix_file_type(manifest_path) == ZIX_FILE_TYPE_REGULAR) {
     // Read manifest into model
     SerdReader* reader = sord_new_reader(model, env, SERD_TURTLE, NULL);
-    SerdStatus  st     = serd_reader_read_file(reader, manifest.buf);
+    SerdStatus  st     = lilv_reader_read_file(reader, manifest.buf);
     if (st) {
       LILV_WARNF("Failed to read manifest (%s)\n", serd_strerror(st));
     }
@@ -1266,6 +1310,9 @@ lilv_state_save(LilvWorld*       world,
   // Create symlinks to files if necessary
   lilv_state_make_links(state, abs_dir);
 
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+
   // Write state to Turtle file
   SerdNode    file = serd_node_new_file_uri(USTR(path), NULL, NULL, true);
   SerdNode    node = uri ? serd_node_from_string(SERD_URI, USTR(uri)) : file;
@@ -1294,6 +1341,8 @@ lilv_state_save(LilvWorld*       world,
     zix_free(NULL, manifest);
   }
 
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
   zix_free(NULL, abs_dir);
   zix_free(NULL, path);
   return ret;
@@ -1317,7 +1366,11 @@ lilv_state_to_string(LilvWorld*       world,
   SerdNode    base   = serd_node_from_string(SERD_URI, USTR(base_uri));
   SerdWriter* writer = ttl_writer(serd_chunk_sink, &chunk, &base, &env);
 
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
   lilv_state_write(world, map, unmap, state, writer, uri, NULL);
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
 
   serd_writer_free(writer);
   serd_env_free(env);
@@ -1355,6 +1408,15 @@ lilv_state_delete(LilvWorld* world, const LilvState* state)
     return -1;
   }
 
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to delete state from a frozen world\n");
+    lilv_world_unlock_caches(world);
+    lilv_world_unlock(world);
+    return -1;
+  }
+
   LilvNode*  bundle        = lilv_new_file_uri(world, NULL, state->dir);
   LilvNode*  manifest      = lilv_world_get_manifest_uri(world, bundle);
   char*      manifest_path = get_canonical_path(manifest);
@@ -1367,7 +1429,7 @@ lilv_state_delete(LilvWorld* world, const LilvState* state)
     // Read manifest into temporary local model
     SerdEnv*    env = serd_env_new(sord_node_to_serd_node(manifest->node));
     SerdReader* ttl = sord_new_reader(model, env, SERD_TURTLE, NULL);
-    serd_reader_read_file(ttl, USTR(manifest_path));
+    lilv_reader_read_file(ttl, USTR(manifest_path));
     serd_reader_free(ttl);
     serd_env_free(env);
   }
@@ -1442,6 +1504,8 @@ lilv_state_delete(LilvWorld* world, const LilvState* state)
   lilv_node_free(manifest);
   lilv_node_free(bundle);
 
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
   return 0;
 }
 
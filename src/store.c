@@ -0,0 +1,575 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "lilv_internal.h"
+
+#include "serd/serd.h"
+#include "sord/sord.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  A store is a sorted, read-only copy of every statement in a model.
+
+  Nodes are numbered in a table sorted by value, so statements can be stored
+  as rows of four 32-bit node IDs.  ID zero is reserved for a missing node,
+  which is only used for statements without a graph.  There are two indices:
+  one with rows in (subject, predicate, object, graph) order, and one with
+  rows in (object, predicate, subject, graph) order.  Each has an offset
+  table with the first row for every node, so the statements about a subject
+  (or with an object) are found without a search.
+*/
+
+#define LILV_STORE_ROW 4U
+
+/** A node and its ID, for finding IDs by address. */
+typedef struct {
+  const SordNode* node;
+  uint32_t        id;
+} LilvStoreKey;
+
+struct LilvStoreImpl {
+  const SordNode** nodes;    ///< Node table, sorted by value, with NULL first
+  LilvStoreKey*    keys;     ///< Node IDs, sorted by node address
+  const uint32_t*  spo;      ///< Rows in subject, predicate, object order
+  const uint32_t*  ops;      ///< Rows in object, predicate, subject order
+  const uint32_t*  subjects; ///< First SPO row of each node, and end
+  const uint32_t*  objects;  ///< First OPS row of each node, and end
+  uint32_t         n_nodes;  ///< Number of nodes, including NULL
+  uint32_t         n_quads;  ///< Number of statements
+  bool             borrowed; ///< True if rows and offsets aren't owned
+};
+
+static const unsigned spo_columns[] = {0U, 1U, 2U, 3U};
+static const unsigned ops_columns[] = {2U, 1U, 0U, 3U};
+
+static int
+lilv_store_cmp_strings(const char* a, const char* b)
+{
+  return (!a || !b) ? ((a > b) - (a < b)) : strcmp(a, b);
+}
+
+/** Compare nodes by value, so nodes are ordered like in a sord index. */
+static int
+lilv_store_cmp_nodes(const void* a, const void* b)
+{
+  const SordNode* const na = *(const SordNode* const*)a;
+  const SordNode* const nb = *(const SordNode* const*)b;
+  if (na == nb || !na || !nb) {
+    return (na > nb) - (na < nb);
+  }
+
+  const SordNodeType ta = sord_node_get_type(na);
+  const SordNodeType tb = sord_node_get_type(nb);
+  if (ta != tb) {
+    return (ta > tb) - (ta < tb);
+  }
+
+  int cmp = strcmp((const char*)sord_node_get_string(na),
+                   (const char*)sord_node_get_string(nb));
+  if (!cmp && ta == SORD_LITERAL) {
+    const SordNode* const da = sord_node_get_datatype(na);
+    const SordNode* const db = sord_node_get_datatype(nb);
+
+    cmp = lilv_store_cmp_strings(
+      da ? (const char*)sord_node_get_string(da) : NULL,
+      db ? (const char*)sord_node_get_string(db) : NULL);
+    if (!cmp) {
+      cmp = lilv_store_cmp_strings(sord_node_get_language(na),
+                                   sord_node_get_language(nb));
+    }
+  }
+
+  return cmp;
+}
+
+static int
+lilv_store_cmp_keys(const void* a, const void* b)
+{
+  const SordNode* const na = ((const LilvStoreKey*)a)->node;
+  const SordNode* const nb = ((const LilvStoreKey*)b)->node;
+
+  return (na > nb) - (na < nb);
+}
+
+static int
+lilv_store_cmp_rows(const void* a, const void* b)
+{
+  const uint32_t* const ra = (const uint32_t*)a;
+  const uint32_t* const rb = (const uint32_t*)b;
+  for (unsigned c = 0U; c < LILV_STORE_ROW; ++c) {
+    if (ra[c] != rb[c]) {
+      return ra[c] < rb[c] ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+uint32_t
+lilv_store_find_id(const LilvStore* store, const SordNode* node)
+{
+  const LilvStoreKey key = {node, 0U};
+  const size_t       n   = store->n_nodes - 1U;
+
+  const LilvStoreKey* const found = (const LilvStoreKey*)bsearch(
+    &key, store->keys, n, sizeof(LilvStoreKey), lilv_store_cmp_keys);
+
+  return found ? found->id : 0U;
+}
+
+/** Reference every node, and index the table by address (skipping NULL). */
+static bool
+lilv_store_index_nodes(LilvStore* store)
+{
+  const uint32_t n_nodes = store->n_nodes;
+
+  store->keys = (LilvStoreKey*)malloc(n_nodes * sizeof(LilvStoreKey));
+  if (!store->keys) {
+    return false;
+  }
+
+  for (uint32_t id = 1U; id < n_nodes; ++id) {
+    store->keys[id - 1U].node = sord_node_copy(store->nodes[id]);
+    store->keys[id - 1U].id   = id;
+  }
+
+  qsort(store->keys, n_nodes - 1U, sizeof(LilvStoreKey), lilv_store_cmp_keys);
+  return true;
+}
+
+/** Build an index and the first row of each value in its first column. */
+static uint32_t*
+lilv_store_index(const LilvStore* store,
+                 const uint32_t*  quads,
+                 const unsigned*  columns,
+                 uint32_t**       offsets)
+{
+  const size_t n_quads  = store->n_quads;
+  const size_t row_size = LILV_STORE_ROW * sizeof(uint32_t);
+  uint32_t*    rows     = (uint32_t*)malloc((n_quads + 1U) * row_size);
+
+  *offsets = (uint32_t*)calloc(store->n_nodes + 1U, sizeof(uint32_t));
+  if (!rows || !*offsets) {
+    free(rows);
+    return NULL;
+  }
+
+  for (size_t q = 0U; q < n_quads; ++q) {
+    const uint32_t* const quad = &quads[q * LILV_STORE_ROW];
+    uint32_t* const       row  = &rows[q * LILV_STORE_ROW];
+    for (unsigned f = 0U; f < LILV_STORE_ROW; ++f) {
+      row[columns[f]] = quad[f];
+    }
+  }
+
+  qsort(rows, n_quads, row_size, lilv_store_cmp_rows);
+
+  // Count rows per first column, then accumulate counts into offsets
+  for (size_t q = 0U; q < n_quads; ++q) {
+    ++(*offsets)[rows[q * LILV_STORE_ROW] + 1U];
+  }
+
+  for (uint32_t n = 0U; n < store->n_nodes; ++n) {
+    (*offsets)[n + 1U] += (*offsets)[n];
+  }
+
+  return rows;
+}
+
+LilvStore*
+lilv_store_new(SordWorld* world, SordModel* model)
+{
+  const size_t n_quads = sord_num_quads(model);
+  const size_t n_refs  = n_quads * LILV_STORE_ROW;
+  if (n_quads >= UINT32_MAX / LILV_STORE_ROW) {
+    return NULL;
+  }
+
+  LilvStore* const store = (LilvStore*)calloc(1, sizeof(LilvStore));
+  if (!store) {
+    return NULL;
+  }
+
+  // Gather every node reference in the model, in statement order
+  const SordNode** const refs =
+    (const SordNode**)malloc((n_refs + 1U) * sizeof(const SordNode*));
+
+  uint32_t* const quads = (uint32_t*)malloc((n_refs + 1U) * sizeof(uint32_t));
+  if (!refs || !quads) {
+    free(quads);
+    free(refs);
+    lilv_store_free(world, store);
+    return NULL;
+  }
+
+  size_t    n = 0U;
+  SordIter* i = sord_begin(model);
+  for (; !sord_iter_end(i) && n < n_refs; sord_iter_next(i)) {
+    SordQuad quad;
+    sord_iter_get(i, quad);
+    for (unsigned f = 0U; f < LILV_STORE_ROW; ++f) {
+      refs[n++] = quad[f];
+    }
+  }
+  sord_iter_free(i);
+  store->n_quads = (uint32_t)(n / LILV_STORE_ROW);
+
+  // Make a table of distinct nodes, sorted by value, with NULL first
+  const SordNode** const table =
+    (const SordNode**)malloc((n + 1U) * sizeof(const SordNode*));
+  if (!table) {
+    free(quads);
+    free(refs);
+    lilv_store_free(world, store);
+    return NULL;
+  }
+
+  memcpy(table, refs, n * sizeof(const SordNode*));
+  table[n] = NULL;
+  qsort(table, n + 1U, sizeof(const SordNode*), lilv_store_cmp_nodes);
+
+  uint32_t n_nodes = 0U;
+  for (size_t t = 0U; t <= n; ++t) {
+    if (!n_nodes || table[t] != table[n_nodes - 1U]) {
+      table[n_nodes++] = table[t];
+    }
+  }
+
+  // Shrink the table, which was allocated for every reference, to fit
+  const SordNode** const nodes =
+    (const SordNode**)realloc(table, n_nodes * sizeof(const SordNode*));
+
+  store->nodes   = nodes ? nodes : table;
+  store->n_nodes = n_nodes;
+  if (!lilv_store_index_nodes(store)) {
+    free(quads);
+    free(refs);
+    lilv_store_free(world, store);
+    return NULL;
+  }
+
+  // Replace node references with IDs to make the rows of both indices
+  for (size_t r = 0U; r < n; ++r) {
+    quads[r] = refs[r] ? lilv_store_find_id(store, refs[r]) : 0U;
+  }
+  free(refs);
+
+  uint32_t* objects  = NULL;
+  uint32_t* subjects = NULL;
+
+  store->ops      = lilv_store_index(store, quads, ops_columns, &objects);
+  store->spo      = lilv_store_index(store, quads, spo_columns, &subjects);
+  store->objects  = objects;
+  store->subjects = subjects;
+  free(quads);
+
+  if (!store->ops || !store->spo) {
+    lilv_store_free(world, store);
+    return NULL;
+  }
+
+  return store;
+}
+
+LilvStore*
+lilv_store_new_from_tables(SordWorld* world, const LilvStoreTables* tables)
+{
+  LilvStore* const store = (LilvStore*)calloc(1, sizeof(LilvStore));
+  if (!store) {
+    return NULL;
+  }
+
+  const size_t nodes_size = tables->n_nodes * sizeof(const SordNode*);
+
+  store->nodes    = (const SordNode**)malloc(nodes_size);
+  store->spo      = tables->spo;
+  store->ops      = tables->ops;
+  store->subjects = tables->subjects;
+  store->objects  = tables->objects;
+  store->n_nodes  = tables->n_nodes;
+  store->n_quads  = tables->n_quads;
+  store->borrowed = true;
+  if (!store->nodes) {
+    lilv_store_free(world, store);
+    return NULL;
+  }
+
+  memcpy(store->nodes, tables->nodes, nodes_size);
+  if (!lilv_store_index_nodes(store)) {
+    lilv_store_free(world, store);
+    return NULL;
+  }
+
+  return store;
+}
+
+void
+lilv_store_get_tables(const LilvStore* store, LilvStoreTables* tables)
+{
+  tables->nodes    = store->nodes;
+  tables->spo      = store->spo;
+  tables->ops      = store->ops;
+  tables->subjects = store->subjects;
+  tables->objects  = store->objects;
+  tables->n_nodes  = store->n_nodes;
+  tables->n_quads  = store->n_quads;
+}
+
+void
+lilv_store_free(SordWorld* world, LilvStore* store)
+{
+  if (!store) {
+    return;
+  }
+
+  if (store->keys) {
+    for (uint32_t k = 0U; k + 1U < store->n_nodes; ++k) {
+      sord_node_free(world, (SordNode*)store->keys[k].node);
+    }
+  }
+
+  if (!store->borrowed) {
+    free((void*)store->objects);
+    free((void*)store->subjects);
+    free((void*)store->ops);
+    free((void*)store->spo);
+  }
+
+  free(store->keys);
+  free(store->nodes);
+  free(store);
+}
+
+size_t
+lilv_store_num_quads(const LilvStore* store)
+{
+  return store->n_quads;
+}
+
+/**
+   Return the first row in a sorted range with at least `id` in `column`.
+
+   The rows in the range must already all have equal values in every earlier
+   column.  If `after` is true, then this returns the first row with a
+   greater value instead.
+*/
+static const uint32_t*
+lilv_store_bound(const uint32_t* begin,
+                 const uint32_t* end,
+                 const unsigned  column,
+                 const uint32_t  id,
+                 const bool      after)
+{
+  size_t n_rows = (size_t)(end - begin) / LILV_STORE_ROW;
+  while (n_rows > 0U) {
+    const size_t          half = n_rows / 2U;
+    const uint32_t* const mid  = begin + (half * LILV_STORE_ROW);
+    if (mid[column] < id || (after && mid[column] == id)) {
+      begin = mid + LILV_STORE_ROW;
+      n_rows -= half + 1U;
+    } else {
+      n_rows = half;
+    }
+  }
+
+  return begin;
+}
+
+static bool
+lilv_matches_row_matches(const LilvMatches* matches)
+{
+  for (unsigned c = 0U; c < 3U; ++c) {
+    if (matches->key[c] && matches->row[c] != matches->key[c]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/** Move to the first matching row from the current one, or to the end. */
+static void
+lilv_matches_seek(LilvMatches* matches)
+{
+  while (matches->row != matches->end && !lilv_matches_row_matches(matches)) {
+    matches->row += LILV_STORE_ROW;
+  }
+}
+
+LilvMatches*
+lilv_store_search(const LilvStore* store,
+                  const SordNode*  subject,
+                  const SordNode*  predicate,
+                  const SordNode*  object,
+                  LilvMatches*     matches)
+{
+  memset(matches, 0, sizeof(LilvMatches));
+
+  const uint32_t s = subject ? lilv_store_find_id(store, subject) : 0U;
+  const uint32_t p = predicate ? lilv_store_find_id(store, predicate) : 0U;
+  const uint32_t o = object ? lilv_store_find_id(store, object) : 0U;
+
+  matches->store = store;
+  if ((subject && !s) || (predicate && !p) || (object && !o)) {
+    return matches; // Something isn't in the store, so nothing matches
+  }
+
+  // Use the index where the given nodes are a prefix, if there is one
+  const bool      by_object = !s && o;
+  const uint32_t* rows      = by_object ? store->ops : store->spo;
+  const uint32_t* offsets   = by_object ? store->objects : store->subjects;
+  const uint32_t  first     = by_object ? o : s;
+  const uint32_t  last      = by_object ? s : o;
+  const uint32_t* begin     = rows;
+  const uint32_t* end       = rows + ((size_t)store->n_quads * LILV_STORE_ROW);
+
+  if (first) {
+    begin = rows + ((size_t)offsets[first] * LILV_STORE_ROW);
+    end   = rows + ((size_t)offsets[first + 1U] * LILV_STORE_ROW);
+    if (p) {
+      const uint32_t* const p_end = lilv_store_bound(begin, end, 1U, p, true);
+
+      begin = lilv_store_bound(begin, p_end, 1U, p, false);
+      end   = p_end;
+      if (last) {
+        const uint32_t* const l_end =
+          lilv_store_bound(begin, end, 2U, last, true);
+
+        begin = lilv_store_bound(begin, l_end, 2U, last, false);
+        end   = l_end;
+      }
+    }
+  }
+
+  matches->row     = begin;
+  matches->end     = end;
+  matches->columns = by_object ? ops_columns : spo_columns;
+  matches->key[0]  = first;
+  matches->key[1]  = p;
+  matches->key[2]  = last;
+  lilv_matches_seek(matches);
+  return matches;
+}
+
+bool
+lilv_store_ask(const LilvStore* store,
+               const SordNode*  subject,
+               const SordNode*  predicate,
+               const SordNode*  object)
+{
+  LilvMatches matches;
+  lilv_store_search(store, subject, predicate, object, &matches);
+
+  const bool found = !lilv_matches_end(&matches);
+
+  lilv_matches_close(&matches);
+  return found;
+}
+
+LilvMatches*
+lilv_matches_init(LilvMatches* matches, SordIter* iter)
+{
+  memset(matches, 0, sizeof(LilvMatches));
+  matches->iter = iter;
+  return matches;
+}
+
+bool
+lilv_matches_end(const LilvMatches* matches)
+{
+  if (!matches) {
+    return true;
+  }
+
+  return matches->iter ? sord_iter_end(matches->iter)
+                       : matches->row == matches->end;
+}
+
+bool
+lilv_matches_next(LilvMatches* matches)
+{
+  if (matches->iter) {
+    return sord_iter_next(matches->iter);
+  }
+
+  if (matches->row != matches->end) {
+    matches->row += LILV_STORE_ROW;
+    lilv_matches_seek(matches);
+  }
+
+  return matches->row == matches->end;
+}
+
+const SordNode*
+lilv_matches_get_node(const LilvMatches* matches, SordQuadIndex index)
+{
+  if (matches->iter) {
+    return sord_iter_get_node(matches->iter, index);
+  }
+
+  return matches->store->nodes[matches->row[matches->columns[index]]];
+}
+
+void
+lilv_matches_get(const LilvMatches* matches, SordQuad quad)
+{
+  if (matches->iter) {
+    sord_iter_get(matches->iter, quad);
+    return;
+  }
+
+  for (unsigned f = 0U; f < LILV_STORE_ROW; ++f) {
+    quad[f] = matches->store->nodes[matches->row[matches->columns[f]]];
+  }
+}
+
+void
+lilv_matches_write(LilvMatches* matches, SerdWriter* writer)
+{
+  if (!matches) {
+    return;
+  }
+
+  if (matches->iter) {
+    sord_write_iter(matches->iter, writer); // Frees iter
+    matches->iter = NULL;
+    return;
+  }
+
+  // Without a model to check references, blank nodes are written with labels
+  FOREACH_MATCHES (matches) {
+    SordQuad quad;
+    lilv_matches_get(matches, quad);
+
+    const SordNode* const datatype = sord_node_get_datatype(quad[2]);
+    const char* const     lang     = sord_node_get_language(quad[2]);
+    const SerdNode        language =
+      serd_node_from_string(SERD_LITERAL, (const uint8_t*)lang);
+
+    serd_writer_write_statement(
+      writer,
+      0U,
+      NULL,
+      sord_node_to_serd_node(quad[SORD_SUBJECT]),
+      sord_node_to_serd_node(quad[SORD_PREDICATE]),
+      sord_node_to_serd_node(quad[SORD_OBJECT]),
+      datatype ? sord_node_to_serd_node(datatype) : NULL,
+      lang ? &language : NULL);
+  }
+
+  lilv_matches_close(matches);
+}
+
+void
+lilv_matches_close(LilvMatches* matches)
+{
+  if (matches) {
+    sord_iter_free(matches->iter);
+    matches->iter = NULL;
+  }
+}
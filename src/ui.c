@@ -4,7 +4,6 @@
 #include "lilv_internal.h"
 
 #include "lilv/lilv.h"
-#include "zix/tree.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -34,7 +33,7 @@ lilv_ui_new(LilvWorld* world,
   free(bundle);
 
   ui->classes = lilv_nodes_new();
-  zix_tree_insert((ZixTree*)ui->classes, type_uri, NULL);
+  lilv_collection_insert(ui->classes, type_uri);
 
   return ui;
 }
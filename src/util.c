@@ -1,6 +1,7 @@
 // Copyright 2007-2019 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "lilv_config.h" // IWYU pragma: keep
 #include "lilv_internal.h"
 
 #include "lilv/lilv.h"
@@ -10,6 +11,12 @@
 #include "zix/path.h"
 #include "zix/string_view.h"
 
+#if USE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
 #include <sys/stat.h>
 
 #include <ctype.h>
@@ -257,6 +264,29 @@ update_latest(const char* path, const char* name, void* data)
   }
 }
 
+/** Return the modification time and size of the file at `path`. */
+LilvFileStamp
+lilv_file_stamp(const char* path)
+{
+  LilvFileStamp stamp = {-1, 0};
+
+  struct stat st;
+  if (!stat(path, &st)) {
+#if defined(__APPLE__)
+    stamp.time = ((int64_t)st.st_mtimespec.tv_sec * 1000000000LL) +
+                 (int64_t)st.st_mtimespec.tv_nsec;
+#elif defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L
+    stamp.time = ((int64_t)st.st_mtim.tv_sec * 1000000000LL) +
+                 (int64_t)st.st_mtim.tv_nsec;
+#else
+    stamp.time = (int64_t)st.st_mtime * 1000000000LL;
+#endif
+    stamp.size = (int64_t)st.st_size;
+  }
+
+  return stamp;
+}
+
 /** Return the latest copy of the file at `path` that is newer. */
 char*
 lilv_get_latest_copy(const char* path, const char* copy_path)
@@ -278,3 +308,89 @@ lilv_get_latest_copy(const char* path, const char* copy_path)
   zix_free(NULL, copy_dir);
   return latest.latest;
 }
+
+#if USE_MMAP
+
+#  define LILV_READ_PAGE_SIZE 4096U
+
+/** A file mapped into memory, read by serd like a stream. */
+typedef struct {
+  const uint8_t* buf;
+  size_t         size;
+  size_t         offset;
+} MappedFile;
+
+static size_t
+mapped_file_read(void* buf, size_t size, size_t nmemb, void* stream)
+{
+  MappedFile* const file  = (MappedFile*)stream;
+  const size_t      avail = (file->size - file->offset) / size;
+  const size_t      n     = nmemb < avail ? nmemb : avail;
+
+  memcpy(buf, file->buf + file->offset, n * size);
+  file->offset += n * size;
+  return n;
+}
+
+static int
+mapped_file_error(void* stream)
+{
+  (void)stream;
+  return 0;
+}
+
+#endif
+
+/**
+   Read the file at `uri` (or a local path) with `reader`.
+
+   Where possible, the file is mapped into memory and read sequentially from
+   there, which avoids the system calls and extra copy of buffered stdio.
+   Otherwise, for example with empty or special files, this falls back to
+   serd_reader_read_file().
+*/
+SerdStatus
+lilv_reader_read_file(SerdReader* reader, const uint8_t* uri)
+{
+#if USE_MMAP
+  char* const path = lilv_file_uri_parse((const char*)uri, NULL);
+  if (!path) {
+    return SERD_ERR_BAD_ARG;
+  }
+
+  void*       map  = MAP_FAILED;
+  size_t      size = 0U;
+  struct stat st;
+  const int   fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+      size = (size_t)st.st_size;
+      map  = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd); // The mapping holds its own reference to the file
+  }
+
+  if (map == MAP_FAILED) {
+    lilv_free(path);
+    return serd_reader_read_file(reader, uri);
+  }
+
+  posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+
+  MappedFile       file = {(const uint8_t*)map, size, 0U};
+  const SerdStatus rst  = serd_reader_read_source(reader,
+                                                 mapped_file_read,
+                                                 mapped_file_error,
+                                                 &file,
+                                                 (const uint8_t*)path,
+                                                 LILV_READ_PAGE_SIZE);
+
+  munmap(map, size);
+  lilv_free(path);
+  return rst;
+
+#else
+  return serd_reader_read_file(reader, uri);
+#endif
+}
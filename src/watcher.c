@@ -0,0 +1,650 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "lilv_config.h" // IWYU pragma: keep
+#include "lilv_internal.h"
+
+#include "lilv/lilv.h"
+
+#if USE_INOTIFY
+
+#  include "serd/serd.h"
+#  include "zix/filesystem.h"
+#  include "zix/path.h"
+#  include "zix/string_view.h"
+
+#  include <sys/inotify.h>
+#  include <time.h>
+#  include <unistd.h>
+
+#  include <stdbool.h>
+#  include <stddef.h>
+#  include <stdint.h>
+#  include <stdlib.h>
+#  include <string.h>
+
+#  define LILV_WATCH_MASK                                                  \
+    (IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_DELETE_SELF | \
+     IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO)
+
+#  define LILV_PARENT_MASK \
+    (IN_CREATE | IN_DELETE_SELF | IN_MOVE_SELF | IN_MOVED_TO)
+
+/** A watched directory. */
+typedef struct {
+  int   wd;     ///< Watch descriptor
+  char* path;   ///< Directory path, without a trailing slash
+  char* bundle; ///< Path of containing bundle, or NULL for LV2_PATH entries
+  bool  parent; ///< Watched only for a missing LV2_PATH entry to appear
+} LilvWatch;
+
+/** Closure for watching every directory within a bundle. */
+typedef struct {
+  LilvWatcher* watcher;
+  const char*  bundle;
+} LilvWatchTree;
+
+/** A bundle that has changed recently and may still be changing. */
+typedef struct {
+  char*    path;     ///< Bundle directory path
+  uint64_t deadline; ///< Time when the bundle is considered settled
+} LilvPendingBundle;
+
+typedef struct {
+  LilvBundleChange change;
+  LilvNode*        bundle_uri;
+} LilvWatcherEvent;
+
+struct LilvWatcherImpl {
+  LilvWorld*         world;
+  int                fd;         ///< Inotify instance
+  uint64_t           debounce;   ///< Quiet period in nanoseconds
+  LilvWatch*         watches;    ///< Watched directories
+  size_t             n_watches;  ///< Number of watched directories
+  LilvPendingBundle* pending;    ///< Bundles waiting to settle
+  size_t             n_pending;  ///< Number of bundles waiting to settle
+  char**             missing;    ///< LV2_PATH entries that don't exist
+  size_t             n_missing;  ///< Number of missing LV2_PATH entries
+  LilvWatcherEvent*  events;     ///< Queue of events for the host
+  size_t             n_events;   ///< Number of events in queue
+  size_t             next_event; ///< Index of next event to return
+};
+
+static uint64_t
+lilv_watcher_now(void)
+{
+  struct timespec now = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec;
+}
+
+static LilvWatch*
+lilv_watcher_find_watch(LilvWatcher* watcher, const int wd)
+{
+  for (size_t i = 0U; i < watcher->n_watches; ++i) {
+    if (watcher->watches[i].wd == wd) {
+      return &watcher->watches[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   Watch the directory at `path`.
+
+   @return True if the directory is now watched by this path, or false if it
+   is inaccessible or already watched by another path (through a link).
+*/
+static bool
+lilv_watcher_add_watch(LilvWatcher* watcher,
+                       const char*  path,
+                       const char*  bundle)
+{
+  const int wd = inotify_add_watch(watcher->fd, path, LILV_WATCH_MASK);
+  if (wd < 0) {
+    return false;
+  }
+
+  const LilvWatch* const existing = lilv_watcher_find_watch(watcher, wd);
+  if (existing) {
+    return !strcmp(existing->path, path);
+  }
+
+  watcher->watches = (LilvWatch*)realloc(
+    watcher->watches, (watcher->n_watches + 1U) * sizeof(LilvWatch));
+
+  LilvWatch* const watch = &watcher->watches[watcher->n_watches++];
+
+  watch->wd     = wd;
+  watch->path   = lilv_strdup(path);
+  watch->bundle = bundle ? lilv_strdup(bundle) : NULL;
+  watch->parent = false;
+  return true;
+}
+
+static void
+lilv_watcher_remove_watch(LilvWatcher* watcher, LilvWatch* watch)
+{
+  free(watch->bundle);
+  free(watch->path);
+  *watch = watcher->watches[--watcher->n_watches];
+}
+
+static void
+watch_tree_dir(const char* dir, const char* name, void* data);
+
+/** Watch the directory at `path` and every directory within it. */
+static void
+lilv_watcher_add_tree(LilvWatcher* watcher,
+                      const char*  path,
+                      const char*  bundle)
+{
+  // Directories already reached through a link are skipped to avoid cycles
+  if (lilv_watcher_add_watch(watcher, path, bundle)) {
+    LilvWatchTree tree = {watcher, bundle};
+    zix_dir_for_each(path, &tree, watch_tree_dir);
+  }
+}
+
+static void
+watch_tree_dir(const char* dir, const char* name, void* data)
+{
+  const LilvWatchTree* const tree = (const LilvWatchTree*)data;
+  char* const                path = lilv_strjoin(dir, "/", name, NULL);
+
+  if (zix_file_type(path) == ZIX_FILE_TYPE_DIRECTORY) {
+    lilv_watcher_add_tree(tree->watcher, path, tree->bundle);
+  }
+
+  free(path);
+}
+
+static void
+watch_bundle_dir(const char* dir, const char* name, void* data)
+{
+  LilvWatcher* const watcher = (LilvWatcher*)data;
+  char* const        path    = lilv_strjoin(dir, "/", name, NULL);
+
+  if (zix_file_type(path) == ZIX_FILE_TYPE_DIRECTORY) {
+    lilv_watcher_add_tree(watcher, path, path);
+  }
+
+  free(path);
+}
+
+/** Note an LV2_PATH entry that doesn't exist, to watch it once it does. */
+static void
+lilv_watcher_add_missing(LilvWatcher* watcher, const char* path)
+{
+  watcher->missing = (char**)realloc(
+    watcher->missing, (watcher->n_missing + 1U) * sizeof(char*));
+
+  watcher->missing[watcher->n_missing++] = lilv_strdup(path);
+}
+
+/** Return the nearest existing ancestor of `path`, or NULL. */
+static char*
+lilv_watcher_existing_parent(const char* path)
+{
+  char* const dir = lilv_strdup(path);
+  size_t      len = strlen(dir);
+  do {
+    // The parent is a prefix of the path, so shorten it in place
+    const size_t parent_len = zix_path_parent_path(dir).length;
+    len                     = parent_len < len ? parent_len : 0U;
+    dir[len]                = '\0';
+  } while (len && zix_file_type(dir) != ZIX_FILE_TYPE_DIRECTORY);
+
+  if (!len) {
+    free(dir);
+    return NULL;
+  }
+
+  return dir;
+}
+
+/** Watch the nearest existing ancestor of `path` for it being created. */
+static void
+lilv_watcher_watch_parent(LilvWatcher* watcher, const char* path)
+{
+  char* dir = lilv_watcher_existing_parent(path);
+  while (dir) {
+    // Add to the mask of any existing watch, rather than replacing it
+    const int wd =
+      inotify_add_watch(watcher->fd, dir, LILV_PARENT_MASK | IN_MASK_ADD);
+
+    if (wd >= 0 && !lilv_watcher_find_watch(watcher, wd)) {
+      watcher->watches = (LilvWatch*)realloc(
+        watcher->watches, (watcher->n_watches + 1U) * sizeof(LilvWatch));
+
+      LilvWatch* const watch = &watcher->watches[watcher->n_watches++];
+
+      watch->wd     = wd;
+      watch->path   = lilv_strdup(dir);
+      watch->bundle = NULL;
+      watch->parent = true;
+    }
+
+    // Watch again if a directory was created before the watch was added
+    char* const next = lilv_watcher_existing_parent(path);
+    if (next && !strcmp(next, dir)) {
+      free(next);
+      free(dir);
+      dir = NULL;
+    } else {
+      free(dir);
+      dir = next;
+    }
+  }
+}
+
+static void
+watch_path_dir(const char* dir_path, void* data)
+{
+  LilvWatcher* const watcher = (LilvWatcher*)data;
+  char* const        path    = lilv_expand(dir_path);
+
+  if (path && zix_file_type(path) != ZIX_FILE_TYPE_DIRECTORY) {
+    lilv_watcher_add_missing(watcher, path);
+  } else if (path) {
+    lilv_watcher_add_watch(watcher, path, NULL);
+    zix_dir_for_each(path, watcher, watch_bundle_dir);
+  }
+
+  free(path);
+}
+
+/** Note a change to a bundle, which delays any event for it. */
+static void
+lilv_watcher_touch(LilvWatcher* watcher, const char* path, const uint64_t now)
+{
+  const uint64_t deadline = now + watcher->debounce;
+
+  for (size_t i = 0U; i < watcher->n_pending; ++i) {
+    if (!strcmp(watcher->pending[i].path, path)) {
+      watcher->pending[i].deadline = deadline;
+      return;
+    }
+  }
+
+  watcher->pending = (LilvPendingBundle*)realloc(
+    watcher->pending, (watcher->n_pending + 1U) * sizeof(LilvPendingBundle));
+
+  LilvPendingBundle* const pending = &watcher->pending[watcher->n_pending++];
+
+  pending->path     = lilv_strdup(path);
+  pending->deadline = deadline;
+}
+
+/** Closure for rescanning an LV2_PATH directory after lost events. */
+typedef struct {
+  LilvWatcher* watcher;
+  uint64_t     now;
+} LilvRescan;
+
+static void
+rescan_bundle_dir(const char* dir, const char* name, void* data)
+{
+  const LilvRescan* const rescan = (const LilvRescan*)data;
+  char* const             path   = lilv_strjoin(dir, "/", name, NULL);
+
+  if (zix_file_type(path) == ZIX_FILE_TYPE_DIRECTORY) {
+    lilv_watcher_add_tree(rescan->watcher, path, path);
+    lilv_watcher_touch(rescan->watcher, path, rescan->now);
+  }
+
+  free(path);
+}
+
+/** Consider every bundle changed, after events have been lost. */
+static void
+lilv_watcher_rescan(LilvWatcher* watcher, const uint64_t now)
+{
+  // Touch every watched bundle, to catch changes and removals
+  const size_t n_watches = watcher->n_watches;
+  for (size_t i = 0U; i < n_watches; ++i) {
+    if (watcher->watches[i].bundle) {
+      lilv_watcher_touch(watcher, watcher->watches[i].bundle, now);
+    }
+  }
+
+  // Scan every root for bundles that appeared while events were lost
+  LilvRescan rescan = {watcher, now};
+  for (size_t i = 0U; i < n_watches; ++i) {
+    if (!watcher->watches[i].bundle) {
+      char* const root = lilv_strdup(watcher->watches[i].path);
+      zix_dir_for_each(root, &rescan, rescan_bundle_dir);
+      free(root);
+    }
+  }
+}
+
+/** Watch any missing LV2_PATH entries that exist now, or their parents. */
+static void
+lilv_watcher_retry_missing(LilvWatcher* watcher, const uint64_t now)
+{
+  // Remove watches on parents, which are added again for entries still missing
+  for (size_t i = 0U; i < watcher->n_watches;) {
+    LilvWatch* const watch = &watcher->watches[i];
+    if (watch->parent) {
+      inotify_rm_watch(watcher->fd, watch->wd);
+      lilv_watcher_remove_watch(watcher, watch);
+    } else {
+      ++i;
+    }
+  }
+
+  LilvRescan rescan = {watcher, now};
+  for (size_t i = 0U; i < watcher->n_missing;) {
+    char* const path = watcher->missing[i];
+    if (zix_file_type(path) != ZIX_FILE_TYPE_DIRECTORY) {
+      // Watch a parent, then check again in case it was created meanwhile
+      lilv_watcher_watch_parent(watcher, path);
+    }
+
+    if (zix_file_type(path) == ZIX_FILE_TYPE_DIRECTORY) {
+      // Watch the new directory, and report any bundles already inside it
+      lilv_watcher_add_watch(watcher, path, NULL);
+      zix_dir_for_each(path, &rescan, rescan_bundle_dir);
+      free(path);
+      watcher->missing[i] = watcher->missing[--watcher->n_missing];
+    } else {
+      ++i;
+    }
+  }
+}
+
+/** Queue an event for a settled bundle, based on its state now. */
+static void
+lilv_watcher_settle(LilvWatcher* watcher, const char* path)
+{
+  char* const dir_path = lilv_strjoin(path, "/", NULL);
+  SerdNode    suri =
+    serd_node_new_file_uri((const uint8_t*)dir_path, NULL, NULL, true);
+
+  LilvNode* const uri    = lilv_new_uri(watcher->world, (const char*)suri.buf);
+  const bool      exists = zix_file_type(path) == ZIX_FILE_TYPE_DIRECTORY;
+  lilv_world_lock(watcher->world);
+  const bool loaded =
+    !!lilv_collection_get_by_uri(watcher->world->bundles, uri);
+  lilv_world_unlock(watcher->world);
+
+  serd_node_free(&suri);
+  free(dir_path);
+
+  if (!exists && !loaded) {
+    lilv_node_free(uri); // Appeared and disappeared, or not a bundle
+    return;
+  }
+
+  watcher->events = (LilvWatcherEvent*)realloc(
+    watcher->events, (watcher->n_events + 1U) * sizeof(LilvWatcherEvent));
+
+  LilvWatcherEvent* const event = &watcher->events[watcher->n_events++];
+
+  event->change     = !loaded  ? LILV_BUNDLE_ADDED
+                      : exists ? LILV_BUNDLE_CHANGED
+                               : LILV_BUNDLE_REMOVED;
+  event->bundle_uri = uri;
+}
+
+/** Handle a single notification. */
+static void
+lilv_watcher_handle(LilvWatcher*                watcher,
+                    const struct inotify_event* event,
+                    const char*                 name,
+                    const uint64_t              now)
+{
+  if (event->mask & IN_Q_OVERFLOW) {
+    lilv_watcher_rescan(watcher, now);
+    return;
+  }
+
+  LilvWatch* const watch = lilv_watcher_find_watch(watcher, event->wd);
+  if (!watch) {
+    return;
+  }
+
+  if (event->mask & IN_IGNORED) {
+    if (!watch->bundle && !watch->parent) {
+      lilv_watcher_add_missing(watcher, watch->path); // Watch if it returns
+    }
+
+    lilv_watcher_remove_watch(watcher, watch); // Directory is gone
+    return;
+  }
+
+  if (watch->parent) {
+    return; // Missing entries are checked after reading every notification
+  }
+
+  const bool new_dir = (event->mask & IN_ISDIR) &&
+                       (event->mask & (IN_CREATE | IN_MOVED_TO)) &&
+                       event->len && name[0];
+
+  if (watch->bundle) {
+    // Watches may be reallocated, so copy the bundle path first
+    char* const bundle = lilv_strdup(watch->bundle);
+    if (new_dir) {
+      char* const path = lilv_strjoin(watch->path, "/", name, NULL);
+      lilv_watcher_add_tree(watcher, path, bundle);
+      free(path);
+    }
+
+    lilv_watcher_touch(watcher, bundle, now);
+    free(bundle);
+  } else if (event->len && name[0]) {
+    char* const path = lilv_strjoin(watch->path, "/", name, NULL);
+
+    if (new_dir) {
+      lilv_watcher_add_tree(watcher, path, path);
+    }
+
+    lilv_watcher_touch(watcher, path, now);
+    free(path);
+  }
+}
+
+LilvWatcher*
+lilv_watcher_new(LilvWorld* world, const unsigned debounce_ms)
+{
+  const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    LILV_ERROR("Failed to initialize inotify\n");
+    return NULL;
+  }
+
+  LilvWatcher* const watcher = (LilvWatcher*)calloc(1, sizeof(LilvWatcher));
+
+  watcher->world    = world;
+  watcher->fd       = fd;
+  watcher->debounce = (uint64_t)debounce_ms * 1000000U;
+
+  lilv_world_lock(world);
+  lilv_for_each_path_dir(
+    lilv_world_get_lv2_path(world), watcher, watch_path_dir);
+  lilv_world_unlock(world);
+
+  lilv_watcher_retry_missing(watcher, lilv_watcher_now());
+
+  return watcher;
+}
+
+void
+lilv_watcher_free(LilvWatcher* watcher)
+{
+  if (!watcher) {
+    return;
+  }
+
+  for (size_t i = watcher->next_event; i < watcher->n_events; ++i) {
+    lilv_node_free(watcher->events[i].bundle_uri);
+  }
+
+  for (size_t i = 0U; i < watcher->n_pending; ++i) {
+    free(watcher->pending[i].path);
+  }
+
+  for (size_t i = 0U; i < watcher->n_missing; ++i) {
+    free(watcher->missing[i]);
+  }
+
+  for (size_t i = 0U; i < watcher->n_watches; ++i) {
+    free(watcher->watches[i].bundle);
+    free(watcher->watches[i].path);
+  }
+
+  close(watcher->fd);
+  free(watcher->events);
+  free(watcher->missing);
+  free(watcher->pending);
+  free(watcher->watches);
+  free(watcher);
+}
+
+int
+lilv_watcher_get_fd(const LilvWatcher* watcher)
+{
+  return watcher->fd;
+}
+
+int
+lilv_watcher_get_timeout(const LilvWatcher* watcher)
+{
+  if (!watcher->n_pending) {
+    return -1;
+  }
+
+  uint64_t deadline = watcher->pending[0].deadline;
+  for (size_t i = 1U; i < watcher->n_pending; ++i) {
+    if (watcher->pending[i].deadline < deadline) {
+      deadline = watcher->pending[i].deadline;
+    }
+  }
+
+  const uint64_t now = lilv_watcher_now();
+  if (deadline <= now) {
+    return 0;
+  }
+
+  // Round up so the deadline has passed when the timeout expires
+  const uint64_t ms = (deadline - now + 999999U) / 1000000U;
+  return ms > INT32_MAX ? INT32_MAX : (int)ms;
+}
+
+unsigned
+lilv_watcher_process(LilvWatcher* watcher)
+{
+  const uint64_t now = lilv_watcher_now();
+
+  // Read all available notifications
+  char    buf[4096];
+  ssize_t n_read   = 0;
+  bool    notified = false;
+  while ((n_read = read(watcher->fd, buf, sizeof(buf))) > 0) {
+    notified = true;
+
+    size_t offset = 0U;
+    while (offset + sizeof(struct inotify_event) <= (size_t)n_read) {
+      // Copy the header, since the buffer may not be aligned
+      struct inotify_event event;
+      memcpy(&event, buf + offset, sizeof(event));
+
+      const char* const name = buf + offset + sizeof(event);
+      lilv_watcher_handle(watcher, &event, name, now);
+      offset += sizeof(event) + event.len;
+    }
+  }
+
+  // Check for missing LV2_PATH entries after any change to their parents
+  if (notified && watcher->n_missing) {
+    lilv_watcher_retry_missing(watcher, now);
+  }
+
+  // Queue events for bundles that have settled
+  for (size_t i = 0U; i < watcher->n_pending;) {
+    LilvPendingBundle* const pending = &watcher->pending[i];
+    if (pending->deadline <= now) {
+      lilv_watcher_settle(watcher, pending->path);
+      free(pending->path);
+      *pending = watcher->pending[--watcher->n_pending];
+    } else {
+      ++i;
+    }
+  }
+
+  return (unsigned)(watcher->n_events - watcher->next_event);
+}
+
+bool
+lilv_watcher_next_event(LilvWatcher*      watcher,
+                        LilvBundleChange* change,
+                        LilvNode**        bundle_uri)
+{
+  if (watcher->next_event == watcher->n_events) {
+    return false;
+  }
+
+  const LilvWatcherEvent* const event =
+    &watcher->events[watcher->next_event++];
+
+  *change     = event->change;
+  *bundle_uri = event->bundle_uri;
+
+  if (watcher->next_event == watcher->n_events) {
+    watcher->next_event = watcher->n_events = 0U;
+  }
+
+  return true;
+}
+
+#else // USE_INOTIFY
+
+LilvWatcher*
+lilv_watcher_new(LilvWorld* world, const unsigned debounce_ms)
+{
+  (void)world;
+  (void)debounce_ms;
+  return NULL;
+}
+
+void
+lilv_watcher_free(LilvWatcher* watcher)
+{
+  (void)watcher;
+}
+
+int
+lilv_watcher_get_fd(const LilvWatcher* watcher)
+{
+  (void)watcher;
+  return -1;
+}
+
+int
+lilv_watcher_get_timeout(const LilvWatcher* watcher)
+{
+  (void)watcher;
+  return -1;
+}
+
+unsigned
+lilv_watcher_process(LilvWatcher* watcher)
+{
+  (void)watcher;
+  return 0U;
+}
+
+bool
+lilv_watcher_next_event(LilvWatcher*      watcher,
+                        LilvBundleChange* change,
+                        LilvNode**        bundle_uri)
+{
+  (void)watcher;
+  (void)change;
+  (void)bundle_uri;
+  return false;
+}
+
+#endif // USE_INOTIFY
@@ -8,10 +8,16 @@
 #include "serd/serd.h"
 #include "sord/sord.h"
 #include "zix/filesystem.h"
+#include "zix/status.h"
+#include "zix/thread.h"
 #include "zix/tree.h"
 
+#include "lv2/atom/atom.h"
 #include "lv2/core/lv2.h"
+#include "lv2/event/event.h"
 #include "lv2/presets/presets.h"
+#include "lv2/state/state.h"
+#include "lv2/ui/ui.h"
 
 #ifdef LILV_DYN_MANIFEST
 #  include "lv2/dynmanifest/dynmanifest.h"
@@ -19,6 +25,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,11 +34,126 @@
 static int
 lilv_world_drop_graph(LilvWorld* world, const SordNode* graph);
 
+static int
+lilv_world_unload_bundle_data(LilvWorld* world, const LilvNode* bundle_uri);
+
 static void
-destroy_node(void* const ptr, const void* const user_data)
+destroy_bundle(void* const ptr)
 {
-  (void)user_data;
-  lilv_node_free((LilvNode*)ptr);
+  LilvBundle* const bundle = (LilvBundle*)ptr;
+  for (unsigned i = 0U; i < bundle->n_files; ++i) {
+    free(bundle->files[i].path);
+  }
+
+  for (unsigned i = 0U; i < bundle->n_versions; ++i) {
+    lilv_node_free(bundle->versions[i].plugin_uri);
+  }
+
+  free(bundle->versions);
+  free(bundle->files);
+  lilv_collection_free(bundle->plugins);
+  lilv_collection_free(bundle->loaded_files);
+  lilv_node_free(bundle->uri);
+  free(bundle);
+}
+
+static void
+destroy_replacement(void* const ptr)
+{
+  LilvReplacement* const replacement = (LilvReplacement*)ptr;
+  lilv_node_free(replacement->replacement);
+  lilv_node_free(replacement->uri);
+  free(replacement);
+}
+
+static void
+lilv_mutex_init(LilvMutex* const mutex)
+{
+#ifdef _WIN32
+  InitializeCriticalSection(mutex);
+#else
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+#endif
+}
+
+static void
+lilv_mutex_destroy(LilvMutex* const mutex)
+{
+#ifdef _WIN32
+  DeleteCriticalSection(mutex);
+#else
+  pthread_mutex_destroy(mutex);
+#endif
+}
+
+static void
+lilv_mutex_lock(const LilvMutex* const mutex)
+{
+#ifdef _WIN32
+  EnterCriticalSection((LilvMutex*)mutex);
+#else
+  pthread_mutex_lock((LilvMutex*)mutex);
+#endif
+}
+
+/** Lock `mutex` if no other thread holds it, and return true on success. */
+static bool
+lilv_mutex_try_lock(LilvMutex* const mutex)
+{
+#ifdef _WIN32
+  return TryEnterCriticalSection(mutex);
+#else
+  return !pthread_mutex_trylock(mutex);
+#endif
+}
+
+static void
+lilv_mutex_unlock(const LilvMutex* const mutex)
+{
+#ifdef _WIN32
+  LeaveCriticalSection((LilvMutex*)mutex);
+#else
+  pthread_mutex_unlock((LilvMutex*)mutex);
+#endif
+}
+
+bool
+lilv_world_is_immutable(const LilvWorld* const world)
+{
+  // Frozen sord models still count iterators, so only a store is immutable
+  return world->frozen && world->store;
+}
+
+void
+lilv_world_lock(const LilvWorld* const world)
+{
+  if (!lilv_world_is_immutable(world)) {
+    lilv_mutex_lock(&world->mutex);
+  }
+}
+
+void
+lilv_world_unlock(const LilvWorld* const world)
+{
+  if (!lilv_world_is_immutable(world)) {
+    lilv_mutex_unlock(&world->mutex);
+  }
+}
+
+void
+lilv_world_lock_caches(const LilvWorld* const world)
+{
+  lilv_mutex_lock(&world->caches_mutex);
+}
+
+void
+lilv_world_unlock_caches(const LilvWorld* const world)
+{
+  lilv_mutex_unlock(&world->caches_mutex);
 }
 
 LilvWorld*
@@ -39,70 +161,49 @@ lilv_world_new(void)
 {
   LilvWorld* world = (LilvWorld*)calloc(1, sizeof(LilvWorld));
 
+  // Nodes are made below, which locks the world
+  lilv_mutex_init(&world->mutex);
+  lilv_mutex_init(&world->caches_mutex);
+
   world->world = sord_world_new();
   if (!world->world) {
     goto fail;
   }
 
+  // With graphs enabled, sord also keeps graph-first GSPO and GOPS indices
   world->model = sord_new(world->world, SORD_SPO | SORD_OPS, true);
   if (!world->model) {
     goto fail;
   }
 
+  world->nodes = zix_tree_new(NULL, false, lilv_node_key_cmp, NULL, NULL, NULL);
+
   world->specs          = NULL;
   world->plugin_classes = lilv_plugin_classes_new();
   world->plugins        = lilv_plugins_new();
   world->zombies        = lilv_plugins_new();
 
-  world->loaded_files =
-    zix_tree_new(NULL, false, lilv_resource_node_cmp, NULL, destroy_node, NULL);
+  world->loaded_files = lilv_collection_new(lilv_resource_node_cmp,
+                                            (LilvFreeFunc)lilv_node_free);
+  world->orphan_files = lilv_collection_new(lilv_resource_node_cmp,
+                                            (LilvFreeFunc)lilv_node_free);
 
   world->libs = zix_tree_new(NULL, false, lilv_lib_compare, NULL, NULL, NULL);
 
+  world->bundles =
+    lilv_collection_new(lilv_header_compare_by_uri, destroy_bundle);
+
+  world->replacements =
+    lilv_collection_new(lilv_header_compare_by_uri, destroy_replacement);
+
 #define NS_DCTERMS "http://purl.org/dc/terms/"
 #define NS_DYNMAN "http://lv2plug.in/ns/ext/dynmanifest#"
 #define NS_OWL "http://www.w3.org/2002/07/owl#"
 
-#define NEW_URI(uri) sord_new_uri(world->world, (const uint8_t*)(uri))
-
-  world->uris.dc_replaces         = NEW_URI(NS_DCTERMS "replaces");
-  world->uris.dman_DynManifest    = NEW_URI(NS_DYNMAN "DynManifest");
-  world->uris.doap_name           = NEW_URI(LILV_NS_DOAP "name");
-  world->uris.lv2_Plugin          = NEW_URI(LV2_CORE__Plugin);
-  world->uris.lv2_Specification   = NEW_URI(LV2_CORE__Specification);
-  world->uris.lv2_appliesTo       = NEW_URI(LV2_CORE__appliesTo);
-  world->uris.lv2_binary          = NEW_URI(LV2_CORE__binary);
-  world->uris.lv2_default         = NEW_URI(LV2_CORE__default);
-  world->uris.lv2_designation     = NEW_URI(LV2_CORE__designation);
-  world->uris.lv2_extensionData   = NEW_URI(LV2_CORE__extensionData);
-  world->uris.lv2_index           = NEW_URI(LV2_CORE__index);
-  world->uris.lv2_latency         = NEW_URI(LV2_CORE__latency);
-  world->uris.lv2_maximum         = NEW_URI(LV2_CORE__maximum);
-  world->uris.lv2_microVersion    = NEW_URI(LV2_CORE__microVersion);
-  world->uris.lv2_minimum         = NEW_URI(LV2_CORE__minimum);
-  world->uris.lv2_minorVersion    = NEW_URI(LV2_CORE__minorVersion);
-  world->uris.lv2_name            = NEW_URI(LV2_CORE__name);
-  world->uris.lv2_optionalFeature = NEW_URI(LV2_CORE__optionalFeature);
-  world->uris.lv2_port            = NEW_URI(LV2_CORE__port);
-  world->uris.lv2_portProperty    = NEW_URI(LV2_CORE__portProperty);
-  world->uris.lv2_reportsLatency  = NEW_URI(LV2_CORE__reportsLatency);
-  world->uris.lv2_requiredFeature = NEW_URI(LV2_CORE__requiredFeature);
-  world->uris.lv2_symbol          = NEW_URI(LV2_CORE__symbol);
-  world->uris.lv2_prototype       = NEW_URI(LV2_CORE__prototype);
-  world->uris.owl_Ontology        = NEW_URI(NS_OWL "Ontology");
-  world->uris.pset_value          = NEW_URI(LV2_PRESETS__value);
-  world->uris.rdf_a               = NEW_URI(LILV_NS_RDF "type");
-  world->uris.rdf_value           = NEW_URI(LILV_NS_RDF "value");
-  world->uris.rdfs_Class          = NEW_URI(LILV_NS_RDFS "Class");
-  world->uris.rdfs_label          = NEW_URI(LILV_NS_RDFS "label");
-  world->uris.rdfs_seeAlso        = NEW_URI(LILV_NS_RDFS "seeAlso");
-  world->uris.rdfs_subClassOf     = NEW_URI(LILV_NS_RDFS "subClassOf");
-  world->uris.xsd_base64Binary    = NEW_URI(LILV_NS_XSD "base64Binary");
-  world->uris.xsd_boolean         = NEW_URI(LILV_NS_XSD "boolean");
-  world->uris.xsd_decimal         = NEW_URI(LILV_NS_XSD "decimal");
-  world->uris.xsd_double          = NEW_URI(LILV_NS_XSD "double");
-  world->uris.xsd_integer         = NEW_URI(LILV_NS_XSD "integer");
-  world->uris.null_uri            = NULL;
+#define NEW_URI(field, uri)                                                    \
+  world->uris.field = sord_new_uri(world->world, (const uint8_t*)(uri));
+
+  LILV_WORLD_URIS(NEW_URI)
 
   world->lv2_plugin_class =
     lilv_plugin_class_new(world, NULL, world->uris.lv2_Plugin, "Plugin");
@@ -115,6 +216,8 @@ lilv_world_new(void)
   return world;
 
 fail:
+  lilv_mutex_destroy(&world->caches_mutex);
+  lilv_mutex_destroy(&world->mutex);
   /* keep on rockin' in the */ free(world);
   return NULL;
 }
@@ -126,12 +229,15 @@ lilv_world_free(LilvWorld* world)
     return;
   }
 
+  zix_tree_free(world->queries);
+  world->queries = NULL;
+
   lilv_plugin_class_free(world->lv2_plugin_class);
   world->lv2_plugin_class = NULL;
 
-  for (SordNode** n = (SordNode**)&world->uris; *n; ++n) {
-    sord_node_free(world->world, *n);
-  }
+#define FREE_URI(field, uri) sord_node_free(world->world, world->uris.field);
+
+  LILV_WORLD_URIS(FREE_URI)
 
   for (LilvSpec* spec = world->specs; spec;) {
     LilvSpec* next = spec->next;
@@ -147,55 +253,203 @@ lilv_world_free(LilvWorld* world)
     const LilvPlugin* p = lilv_plugins_get(world->plugins, i);
     lilv_plugin_free((LilvPlugin*)p);
   }
-  zix_tree_free((ZixTree*)world->plugins);
+  lilv_collection_free(world->plugins);
   world->plugins = NULL;
 
   LILV_FOREACH (plugins, i, world->zombies) {
     const LilvPlugin* p = lilv_plugins_get(world->zombies, i);
     lilv_plugin_free((LilvPlugin*)p);
   }
-  zix_tree_free((ZixTree*)world->zombies);
+  lilv_collection_free(world->zombies);
   world->zombies = NULL;
 
-  zix_tree_free((ZixTree*)world->loaded_files);
+  lilv_collection_free(world->loaded_files);
   world->loaded_files = NULL;
 
+  lilv_collection_free(world->orphan_files);
+  world->orphan_files = NULL;
+
   zix_tree_free(world->libs);
   world->libs = NULL;
 
-  zix_tree_free((ZixTree*)world->plugin_classes);
+  lilv_collection_free(world->bundles);
+  world->bundles = NULL;
+
+  lilv_collection_free(world->replacements);
+  world->replacements = NULL;
+
+  if (world->cache) {
+    lilv_cache_save(world->cache, false);
+    lilv_cache_free(world->cache);
+    world->cache = NULL;
+  }
+
+  lilv_collection_free(world->plugin_classes);
   world->plugin_classes = NULL;
 
   sord_free(world->model);
   world->model = NULL;
 
+  lilv_store_free(world->world, world->store);
+  world->store = NULL;
+
+  lilv_image_free(world->image);
+  world->image = NULL;
+
+  zix_tree_free((ZixTree*)world->nodes);
+  world->nodes = NULL;
+
   sord_world_free(world->world);
   world->world = NULL;
 
+  for (size_t i = 0U; i < world->n_langs; ++i) {
+    free(world->langs[i]);
+  }
+
+  free(world->langs);
+  free(world->lang_env);
   free(world->opt.lv2_path);
+  lilv_mutex_destroy(&world->caches_mutex);
+  lilv_mutex_destroy(&world->mutex);
   free(world);
 }
 
+/** Load the data of every plugin in a collection, including its ports. */
+static void
+lilv_world_load_plugins_data(const LilvPlugins* plugins)
+{
+  LILV_FOREACH (plugins, i, plugins) {
+    const LilvPlugin* const plugin = lilv_plugins_get(plugins, i);
+
+    lilv_plugin_load_if_necessary(plugin);
+    lilv_plugin_get_port_infos(plugin);
+    lilv_plugin_get_library_uri(plugin);
+    lilv_plugin_get_class(plugin);
+  }
+}
+
+/** Load everything that queries would otherwise load on demand. */
+static void
+lilv_world_load_pending(LilvWorld* world)
+{
+  lilv_world_load_specifications(world);
+  lilv_world_load_classes_if_necessary(world);
+  lilv_plugin_class_update_index(world);
+  lilv_world_load_plugins_data(world->plugins);
+}
+
 void
-lilv_world_set_option(LilvWorld* world, const char* uri, const LilvNode* value)
+lilv_world_freeze(LilvWorld* world)
+{
+  // Freezing changes whether calls lock, so no other thread may be in one,
+  // and the mutex is locked directly since lilv_world_unlock() may not
+  if (!lilv_mutex_try_lock(&world->mutex)) {
+    LILV_ERROR("Attempt to freeze a world in use by another thread\n");
+    return;
+  }
+
+  // Load everything that queries would otherwise load on demand
+  lilv_world_get_lang(world);
+  lilv_world_load_pending(world);
+  lilv_world_load_plugins_data(world->zombies);
+
+  if (world->opt.compact && !world->store) {
+    // Replace the model with a compact copy, and an empty model for anything
+    // that still refers to it
+    LilvStore* const store = lilv_store_new(world->world, world->model);
+    SordModel* const empty =
+      store ? sord_new(world->world, SORD_SPO, false) : NULL;
+    if (empty) {
+      sord_free(world->model);
+      world->model = empty;
+      world->store = store;
+    } else {
+      LILV_ERROR("Failed to compact world\n");
+      lilv_store_free(world->world, store);
+    }
+  }
+
+  world->frozen = true;
+  lilv_mutex_unlock(&world->mutex);
+}
+
+/** Set an option, or return false if it is unrecognized or invalid. */
+static bool
+lilv_world_apply_option(LilvWorld*      world,
+                        const char*     uri,
+                        const LilvNode* value)
 {
-  if (!strcmp(uri, LILV_OPTION_DYN_MANIFEST)) {
+  if (!strcmp(uri, LILV_OPTION_COMPACT)) {
+    if (lilv_node_is_bool(value)) {
+      world->opt.compact = lilv_node_as_bool(value);
+      return true;
+    }
+  } else if (!strcmp(uri, LILV_OPTION_DYN_MANIFEST)) {
     if (lilv_node_is_bool(value)) {
       world->opt.dyn_manifest = lilv_node_as_bool(value);
-      return;
+      return true;
     }
   } else if (!strcmp(uri, LILV_OPTION_FILTER_LANG)) {
     if (lilv_node_is_bool(value)) {
       world->opt.filter_language = lilv_node_as_bool(value);
-      return;
+      ++world->epoch;
+      return true;
     }
   } else if (!strcmp(uri, LILV_OPTION_LV2_PATH)) {
     if (lilv_node_is_string(value)) {
       world->opt.lv2_path = lilv_strdup(lilv_node_as_string(value));
-      return;
+      return true;
+    }
+  } else if (!strcmp(uri, LILV_OPTION_DISCOVERY_THREADS)) {
+    if (lilv_node_is_int(value) && lilv_node_as_int(value) >= 0) {
+      world->opt.discovery_threads = (unsigned)lilv_node_as_int(value);
+      return true;
+    }
+  } else if (!strcmp(uri, LILV_OPTION_LAZY_SPECS)) {
+    if (lilv_node_is_bool(value)) {
+      world->opt.lazy_specs = lilv_node_as_bool(value);
+      return true;
+    }
+  } else if (!strcmp(uri, LILV_OPTION_QUERY_CACHE)) {
+    if (lilv_node_is_bool(value) ||
+        (lilv_node_is_int(value) && lilv_node_as_int(value) >= 0)) {
+      world->max_queries =
+        lilv_node_is_int(value)    ? (size_t)lilv_node_as_int(value)
+        : lilv_node_as_bool(value) ? LILV_DEFAULT_MAX_QUERIES
+                                   : 0U;
+
+      if (!world->max_queries) {
+        zix_tree_free(world->queries);
+        world->queries = NULL;
+      } else if (!world->queries) {
+        world->queries       = lilv_query_cache_new(world);
+        world->queries_epoch = world->epoch;
+      }
+      return true;
+    }
+  } else if (!strcmp(uri, LILV_OPTION_CACHE_PATH)) {
+    if (lilv_node_is_string(value)) {
+      if (world->cache) {
+        lilv_cache_save(world->cache, false);
+        lilv_cache_free(world->cache);
+      }
+      world->cache = lilv_cache_new(lilv_node_as_string(value));
+      return true;
     }
   }
-  LILV_WARNF("Unrecognized or invalid option `%s'\n", uri);
+  return false;
+}
+
+void
+lilv_world_set_option(LilvWorld* world, const char* uri, const LilvNode* value)
+{
+  lilv_world_lock(world);
+  lilv_world_lock_caches(world);
+  if (!lilv_world_apply_option(world, uri, value)) {
+    LILV_WARNF("Unrecognized or invalid option `%s'\n", uri);
+  }
+  lilv_world_unlock_caches(world);
+  lilv_world_unlock(world);
 }
 
 LilvNodes*
@@ -226,10 +480,26 @@ lilv_world_find_nodes(LilvWorld*      world,
     return NULL;
   }
 
-  return lilv_world_find_nodes_internal(world,
-                                        subject ? subject->node : NULL,
-                                        predicate->node,
-                                        object ? object->node : NULL);
+  lilv_world_lock(world);
+  lilv_world_load_specs_for(world, subject ? subject->node : NULL);
+  lilv_world_load_specs_for(world, object ? object->node : NULL);
+
+  LilvQueryResult query = {LILV_QUERY_FIND,
+                           subject ? subject->node : NULL,
+                           predicate->node,
+                           object ? object->node : NULL,
+                           NULL,
+                           NULL,
+                           false};
+
+  if (!lilv_world_find_query(world, &query)) {
+    query.nodes = lilv_world_find_nodes_internal(
+      world, query.subject, query.predicate, query.object);
+    lilv_world_add_query(world, &query);
+  }
+
+  lilv_world_unlock(world);
+  return query.nodes;
 }
 
 LilvNode*
@@ -238,43 +508,126 @@ lilv_world_get(LilvWorld*      world,
                const LilvNode* predicate,
                const LilvNode* object)
 {
-  if (!object) {
-    // TODO: Improve performance (see lilv_plugin_get_one)
-    SordIter* stream = sord_search(world->model,
-                                   subject ? subject->node : NULL,
-                                   predicate ? predicate->node : NULL,
-                                   NULL,
-                                   NULL);
-
-    LilvNodes* nodes =
-      lilv_nodes_from_stream_objects(world, stream, SORD_OBJECT);
-
-    if (nodes) {
-      LilvNode* value = lilv_node_duplicate(lilv_nodes_get_first(nodes));
-      lilv_nodes_free(nodes);
-      return value;
+  lilv_world_lock(world);
+  lilv_world_load_specs_for(world, subject ? subject->node : NULL);
+  lilv_world_load_specs_for(world, object ? object->node : NULL);
+
+  LilvQueryResult query = {LILV_QUERY_GET,
+                           subject ? subject->node : NULL,
+                           predicate ? predicate->node : NULL,
+                           object ? object->node : NULL,
+                           NULL,
+                           NULL,
+                           false};
+
+  if (!lilv_world_find_query(world, &query)) {
+    if (!object) {
+      query.node = lilv_node_new_from_node(
+        world,
+        lilv_world_get_translated(world, query.subject, query.predicate));
+    } else {
+      query.node = lilv_node_new_from_node(
+        world,
+        lilv_world_get_internal(
+          world, query.subject, query.predicate, query.object));
     }
 
-    return NULL;
+    lilv_world_add_query(world, &query);
   }
 
-  SordNode* snode = sord_get(world->model,
-                             subject ? subject->node : NULL,
-                             predicate ? predicate->node : NULL,
-                             object ? object->node : NULL,
-                             NULL);
-  LilvNode* lnode = lilv_node_new_from_node(world, snode);
-  sord_node_free(world->world, snode);
-  return lnode;
+  lilv_world_unlock(world);
+  return query.node;
 }
 
-SordIter*
+LilvMatches*
 lilv_world_query_internal(LilvWorld*      world,
                           const SordNode* subject,
                           const SordNode* predicate,
-                          const SordNode* object)
+                          const SordNode* object,
+                          LilvMatches*    matches)
+{
+  if (world->store) {
+    return lilv_store_search(
+      world->store, subject, predicate, object, matches);
+  }
+
+  return lilv_matches_init(
+    matches, sord_search(world->model, subject, predicate, object, NULL));
+}
+
+const SordNode*
+lilv_world_get_internal(LilvWorld*      world,
+                        const SordNode* subject,
+                        const SordNode* predicate,
+                        const SordNode* object)
+{
+  if ((!subject + !predicate + !object) != 1) {
+    return NULL;
+  }
+
+  const SordQuadIndex field = !subject     ? SORD_SUBJECT
+                              : !predicate ? SORD_PREDICATE
+                                           : SORD_OBJECT;
+
+  LilvMatches matches;
+  lilv_world_query_internal(world, subject, predicate, object, &matches);
+
+  const SordNode* const result =
+    lilv_matches_end(&matches) ? NULL : lilv_matches_get_node(&matches, field);
+
+  lilv_matches_close(&matches);
+  return result;
+}
+
+/**
+   Return the interned copy of the language string `lang`, which is consumed.
+
+   Languages are never freed before the world, since other threads may still
+   be using one returned by lilv_world_get_lang() when LANG changes.
+*/
+static const char*
+lilv_world_intern_lang(LilvWorld* world, char* lang)
+{
+  if (!lang) {
+    return NULL;
+  }
+
+  for (size_t i = 0U; i < world->n_langs; ++i) {
+    if (!strcmp(world->langs[i], lang)) {
+      free(lang);
+      return world->langs[i];
+    }
+  }
+
+  char** const langs =
+    (char**)realloc(world->langs, (world->n_langs + 1U) * sizeof(char*));
+  if (!langs) {
+    free(lang);
+    return NULL;
+  }
+
+  world->langs                 = langs;
+  world->langs[world->n_langs] = lang;
+  return world->langs[world->n_langs++];
+}
+
+const char*
+lilv_world_get_lang(LilvWorld* world)
 {
-  return sord_search(world->model, subject, predicate, object, NULL);
+  // Parse LANG again only if it has changed since the last call
+  lilv_world_lock_caches(world);
+  const char* const env_lang = getenv("LANG");
+  if (!env_lang != !world->lang_env ||
+      (env_lang && strcmp(env_lang, world->lang_env))) {
+    free(world->lang_env);
+    world->lang     = lilv_world_intern_lang(world, lilv_get_lang());
+    world->lang_env = env_lang ? lilv_strdup(env_lang) : NULL;
+    ++world->epoch; // Translated query results may have changed
+  }
+
+  const char* const lang = world->lang;
+  lilv_world_unlock_caches(world);
+  return lang;
 }
 
 bool
@@ -283,6 +636,10 @@ lilv_world_ask_internal(LilvWorld*      world,
                         const SordNode* predicate,
                         const SordNode* object)
 {
+  if (world->store) {
+    return lilv_store_ask(world->store, subject, predicate, object);
+  }
+
   return sord_ask(world->model, subject, predicate, object, NULL);
 }
 
@@ -292,11 +649,62 @@ lilv_world_ask(LilvWorld*      world,
                const LilvNode* predicate,
                const LilvNode* object)
 {
-  return sord_ask(world->model,
-                  subject ? subject->node : NULL,
-                  predicate ? predicate->node : NULL,
-                  object ? object->node : NULL,
-                  NULL);
+  lilv_world_lock(world);
+  lilv_world_load_specs_for(world, subject ? subject->node : NULL);
+  lilv_world_load_specs_for(world, object ? object->node : NULL);
+
+  LilvQueryResult query = {LILV_QUERY_ASK,
+                           subject ? subject->node : NULL,
+                           predicate ? predicate->node : NULL,
+                           object ? object->node : NULL,
+                           NULL,
+                           NULL,
+                           false};
+
+  if (!lilv_world_find_query(world, &query)) {
+    query.found = lilv_world_ask_internal(
+      world, query.subject, query.predicate, query.object);
+    lilv_world_add_query(world, &query);
+  }
+
+  lilv_world_unlock(world);
+  return query.found;
+}
+
+unsigned
+lilv_world_foreach_match(LilvWorld*      world,
+                         const LilvNode* subject,
+                         const LilvNode* predicate,
+                         const LilvNode* object,
+                         LilvMatchFunc   func,
+                         void*           data)
+{
+  lilv_world_lock(world);
+  lilv_world_load_specs_for(world, subject ? subject->node : NULL);
+  lilv_world_load_specs_for(world, object ? object->node : NULL);
+
+  const unsigned n_matches = lilv_world_foreach_internal(
+    world,
+    subject ? subject->node : NULL,
+    predicate ? predicate->node : NULL,
+    object ? object->node : NULL,
+    world->opt.filter_language && subject && predicate && !object,
+    func,
+    data);
+
+  lilv_world_unlock(world);
+  return n_matches;
+}
+
+void
+lilv_world_get_query_cache_stats(const LilvWorld* world,
+                                 uint64_t*        hits,
+                                 uint64_t*        misses)
+{
+  lilv_world_lock_caches(world);
+  *hits   = world->n_query_hits;
+  *misses = world->n_query_misses;
+  lilv_world_unlock_caches(world);
 }
 
 SordModel*
@@ -324,9 +732,10 @@ lilv_world_find_nodes_internal(LilvWorld*      world,
                                const SordNode* predicate,
                                const SordNode* object)
 {
+  LilvMatches matches;
   return lilv_nodes_from_stream_objects(
     world,
-    lilv_world_query_internal(world, subject, predicate, object),
+    lilv_world_query_internal(world, subject, predicate, object, &matches),
     (object == NULL) ? SORD_OBJECT : SORD_SUBJECT);
 }
 
@@ -342,9 +751,12 @@ lilv_new_uri_relative_to_base(const uint8_t* uri_str,
 const uint8_t*
 lilv_world_blank_node_prefix(LilvWorld* world)
 {
-  static char str[32];
-  snprintf(str, sizeof(str), "%u", world->n_read_files++);
-  return (const uint8_t*)str;
+  snprintf(world->blank_prefix,
+           sizeof(world->blank_prefix),
+           "%u",
+           world->n_read_files++);
+
+  return (const uint8_t*)world->blank_prefix;
 }
 
 /** Comparator for sequences (e.g. world->plugins). */
@@ -381,27 +793,6 @@ lilv_lib_compare(const void* a, const void* b, const void* user_data)
   return cmp ? cmp : strcmp(lib_a->bundle_path, lib_b->bundle_path);
 }
 
-/** Get an element of a collection of any object with an LilvHeader by URI. */
-static ZixTreeIter*
-lilv_collection_find_by_uri(const ZixTree* seq, const LilvNode* uri)
-{
-  ZixTreeIter* i = NULL;
-  if (lilv_node_is_uri(uri)) {
-    struct LilvHeader key = {NULL, (LilvNode*)uri};
-    zix_tree_find(seq, &key, &i);
-  }
-  return i;
-}
-
-/** Get an element of a collection of any object with an LilvHeader by URI. */
-struct LilvHeader*
-lilv_collection_get_by_uri(const ZixTree* seq, const LilvNode* uri)
-{
-  ZixTreeIter* const i = lilv_collection_find_by_uri(seq, uri);
-
-  return i ? (struct LilvHeader*)zix_tree_get(i) : NULL;
-}
-
 static void
 lilv_world_add_spec(LilvWorld*      world,
                     const SordNode* specification_node,
@@ -411,21 +802,22 @@ lilv_world_add_spec(LilvWorld*      world,
   spec->spec      = sord_node_copy(specification_node);
   spec->bundle    = sord_node_copy(bundle_node);
   spec->data_uris = lilv_nodes_new();
+  spec->loaded    = false;
 
   // Add all data files (rdfs:seeAlso)
   SordIter* files = sord_search(
     world->model, specification_node, world->uris.rdfs_seeAlso, NULL, NULL);
   FOREACH_MATCH (files) {
     const SordNode* file_node = sord_iter_get_node(files, SORD_OBJECT);
-    zix_tree_insert((ZixTree*)spec->data_uris,
-                    lilv_node_new_from_node(world, file_node),
-                    NULL);
+    lilv_collection_insert(spec->data_uris,
+                           lilv_node_new_from_node(world, file_node));
   }
   sord_iter_free(files);
 
   // Add specification to world specification list
   spec->next   = world->specs;
   world->specs = spec;
+  ++world->n_unloaded_specs;
 }
 
 static void
@@ -437,9 +829,9 @@ lilv_world_add_plugin(LilvWorld*      world,
 {
   (void)dynmanifest;
 
-  LilvNode*    plugin_uri = lilv_node_new_from_node(world, plugin_node);
-  ZixTreeIter* z          = NULL;
-  LilvPlugin*  plugin =
+  LilvNode*   plugin_uri = lilv_node_new_from_node(world, plugin_node);
+  LilvIter*   z          = NULL;
+  LilvPlugin* plugin =
     (LilvPlugin*)lilv_plugins_get_by_uri(world->plugins, plugin_uri);
 
   if (plugin) {
@@ -458,12 +850,11 @@ lilv_world_add_plugin(LilvWorld*      world,
       lilv_node_free(plugin_uri);
       return;
     }
-  } else if ((z = lilv_collection_find_by_uri((const ZixTree*)world->zombies,
-                                              plugin_uri))) {
+  } else if ((z = lilv_collection_find_by_uri(world->zombies, plugin_uri))) {
     // Plugin bundle has been re-loaded, move from zombies to plugins
-    plugin = (LilvPlugin*)zix_tree_get(z);
-    zix_tree_remove((ZixTree*)world->zombies, z);
-    zix_tree_insert((ZixTree*)world->plugins, plugin, NULL);
+    plugin = (LilvPlugin*)lilv_collection_get(world->zombies, z);
+    lilv_collection_remove(world->zombies, z);
+    lilv_collection_insert(world->plugins, plugin);
     lilv_node_free(plugin_uri);
     lilv_plugin_clear(plugin, lilv_node_new_from_node(world, bundle));
   } else {
@@ -472,11 +863,11 @@ lilv_world_add_plugin(LilvWorld*      world,
       world, plugin_uri, lilv_node_new_from_node(world, bundle));
 
     // Add manifest as plugin data file (as if it were rdfs:seeAlso)
-    zix_tree_insert(
-      (ZixTree*)plugin->data_uris, lilv_node_duplicate(manifest_uri), NULL);
+    lilv_collection_insert(plugin->data_uris,
+                           lilv_node_duplicate(manifest_uri));
 
     // Add plugin to world plugin sequence
-    zix_tree_insert((ZixTree*)world->plugins, plugin, NULL);
+    lilv_collection_insert(world->plugins, plugin);
   }
 
 #ifdef LILV_DYN_MANIFEST
@@ -487,14 +878,20 @@ lilv_world_add_plugin(LilvWorld*      world,
   }
 #endif
 
+  // Add plugin to the record of its bundle, so it can be unloaded quickly
+  LilvBundle* const record = (LilvBundle*)lilv_collection_get_by_uri(
+    world->bundles, lilv_plugin_get_bundle_uri(plugin));
+  if (record) {
+    lilv_collection_insert(record->plugins, plugin);
+  }
+
   // Add all plugin data files (rdfs:seeAlso)
   SordIter* files = sord_search(
     world->model, plugin_node, world->uris.rdfs_seeAlso, NULL, NULL);
   FOREACH_MATCH (files) {
     const SordNode* file_node = sord_iter_get_node(files, SORD_OBJECT);
-    zix_tree_insert((ZixTree*)plugin->data_uris,
-                    lilv_node_new_from_node(world, file_node),
-                    NULL);
+    lilv_collection_insert(plugin->data_uris,
+                           lilv_node_new_from_node(world, file_node));
   }
   sord_iter_free(files);
 }
@@ -614,6 +1011,7 @@ lilv_world_load_dyn_manifest(LilvWorld*      world,
     serd_reader_read_file_handle(reader, fd, (const uint8_t*)"(dyn-manifest)");
     serd_reader_free(reader);
     serd_env_free(env);
+    ++world->epoch;
 
     // Close (and automatically delete) temporary data file
     fclose(fd);
@@ -688,7 +1086,7 @@ load_plugin_model(LilvWorld*      world,
   // Load manifest
   LilvNode* manifest_uri = lilv_world_get_manifest_uri(world, bundle_uri);
   serd_reader_add_blank_prefix(reader, lilv_world_blank_node_prefix(world));
-  serd_reader_read_file(reader,
+  lilv_reader_read_file(reader,
                         (const uint8_t*)lilv_node_as_string(manifest_uri));
 
   // Load any seeAlso files
@@ -701,7 +1099,7 @@ load_plugin_model(LilvWorld*      world,
     const uint8_t*  file_str = sord_node_get_string(file);
     if (sord_node_get_type(file) == SORD_URI) {
       serd_reader_add_blank_prefix(reader, lilv_world_blank_node_prefix(world));
-      serd_reader_read_file(reader, file_str);
+      lilv_reader_read_file(reader, file_str);
     }
   }
 
@@ -714,99 +1112,400 @@ load_plugin_model(LilvWorld*      world,
   return model;
 }
 
+/**
+   Get the version of `subject` in `graph` of `model`.
+
+   @return True if both the minor and micro version were found.
+*/
+static bool
+get_version(LilvWorld*      world,
+            SordModel*      model,
+            const LilvNode* subject,
+            const SordNode* graph,
+            LilvVersion*    version)
+{
+  SordNode* minor_node = sord_get(
+    model, subject->node, world->uris.lv2_minorVersion, NULL, graph);
+  SordNode* micro_node = sord_get(
+    model, subject->node, world->uris.lv2_microVersion, NULL, graph);
+
+  const bool found = minor_node && micro_node;
+  if (found) {
+    version->minor = atoi((const char*)sord_node_get_string(minor_node));
+    version->micro = atoi((const char*)sord_node_get_string(micro_node));
+  }
+
+  sord_node_free(world->world, micro_node);
+  sord_node_free(world->world, minor_node);
+  return found;
+}
+
+/**
+   Get the version of a plugin in a bundle.
+
+   The version is taken from the statements that are already loaded from the
+   bundle if possible, like those in the manifest, and otherwise the bundle
+   files are read into a temporary model.  The result is cached in the bundle
+   record, so this happens at most once per plugin while the bundle is loaded.
+*/
 static LilvVersion
-get_version(LilvWorld* world, SordModel* model, const LilvNode* subject)
+lilv_world_get_plugin_version(LilvWorld*      world,
+                              const LilvNode* bundle_uri,
+                              const LilvNode* plugin_uri)
 {
-  const SordNode* minor_node =
-    sord_get(model, subject->node, world->uris.lv2_minorVersion, NULL, NULL);
-  const SordNode* micro_node =
-    sord_get(model, subject->node, world->uris.lv2_microVersion, NULL, NULL);
+  LilvBundle* const bundle =
+    (LilvBundle*)lilv_collection_get_by_uri(world->bundles, bundle_uri);
+
+  if (bundle) {
+    for (unsigned i = 0U; i < bundle->n_versions; ++i) {
+      if (lilv_node_equals(bundle->versions[i].plugin_uri, plugin_uri)) {
+        return bundle->versions[i].version;
+      }
+    }
+  }
 
   LilvVersion version = {0, 0};
-  if (minor_node && micro_node) {
-    version.minor = atoi((const char*)sord_node_get_string(minor_node));
-    version.micro = atoi((const char*)sord_node_get_string(micro_node));
+  if (!get_version(
+        world, world->model, plugin_uri, bundle_uri->node, &version)) {
+    SordModel* const model = load_plugin_model(world, bundle_uri, plugin_uri);
+    get_version(world, model, plugin_uri, NULL, &version);
+    sord_free(model);
+  }
+
+  if (bundle) {
+    bundle->versions = (LilvBundleVersion*)realloc(
+      bundle->versions, (bundle->n_versions + 1U) * sizeof(LilvBundleVersion));
+
+    LilvBundleVersion* const entry = &bundle->versions[bundle->n_versions++];
+
+    entry->plugin_uri = lilv_node_duplicate(plugin_uri);
+    entry->version    = version;
   }
 
   return version;
 }
 
-void
-lilv_world_load_bundle(LilvWorld* world, const LilvNode* bundle_uri)
+/** Stamp the local file at `path` and record it in `bundle`. */
+static void
+lilv_bundle_add_file(LilvBundle* const bundle, const char* const path)
 {
-  if (!lilv_node_is_uri(bundle_uri)) {
-    LILV_ERRORF("Bundle URI `%s' is not a URI\n",
-                sord_node_get_string(bundle_uri->node));
-    return;
+  for (unsigned i = 0U; i < bundle->n_files; ++i) {
+    if (!strcmp(bundle->files[i].path, path)) {
+      return;
+    }
   }
 
-  SordNode* bundle_node = bundle_uri->node;
-  LilvNode* manifest    = lilv_world_get_manifest_uri(world, bundle_uri);
+  bundle->files = (LilvBundleFile*)realloc(
+    bundle->files, (bundle->n_files + 1U) * sizeof(LilvBundleFile));
 
-  // Read manifest into model with graph = bundle_node
-  SerdStatus st = lilv_world_load_graph(world, bundle_node, manifest);
-  if (st > SERD_FAILURE) {
-    LILV_ERRORF("Error reading %s\n", lilv_node_as_string(manifest));
-    lilv_node_free(manifest);
-    return;
-  }
+  LilvBundleFile* const file = &bundle->files[bundle->n_files++];
 
-  // ?plugin a lv2:Plugin
-  SordIter* plug_results = sord_search(
-    world->model, NULL, world->uris.rdf_a, world->uris.lv2_Plugin, bundle_node);
+  file->path  = lilv_strdup(path);
+  file->stamp = lilv_file_stamp(path);
+}
 
-  // Find any loaded plugins that will be replaced with a newer version
-  LilvNodes* unload_uris = lilv_nodes_new();
-  FOREACH_MATCH (plug_results) {
-    const SordNode* plug = sord_iter_get_node(plug_results, SORD_SUBJECT);
+/** Record `node` in `bundle` if it is the URI of a local file. */
+static void
+lilv_bundle_add_file_uri(LilvBundle* const bundle, const SordNode* const node)
+{
+  if (sord_node_get_type(node) == SORD_URI) {
+    char* const path =
+      lilv_file_uri_parse((const char*)sord_node_get_string(node), NULL);
 
-    LilvNode*         plugin_uri = lilv_node_new_from_node(world, plug);
-    const LilvPlugin* plugin =
-      lilv_plugins_get_by_uri(world->plugins, plugin_uri);
-    const LilvNode* last_bundle =
-      plugin ? lilv_plugin_get_bundle_uri(plugin) : NULL;
-    if (!plugin || sord_node_equals(bundle_node, last_bundle->node)) {
-      // No previously loaded version, or it's from the same bundle
-      lilv_node_free(plugin_uri);
-      continue;
+    if (path) {
+      lilv_bundle_add_file(bundle, path);
+      lilv_free(path);
     }
+  }
+}
 
-    // Compare versions
-    SordModel*  this_model   = load_plugin_model(world, bundle_uri, plugin_uri);
-    LilvVersion this_version = get_version(world, this_model, plugin_uri);
-    SordModel*  last_model = load_plugin_model(world, last_bundle, plugin_uri);
-    LilvVersion last_version = get_version(world, last_model, plugin_uri);
-    sord_free(this_model);
-    sord_free(last_model);
-    const int cmp = lilv_version_cmp(&this_version, &last_version);
-    if (cmp > 0) {
-      zix_tree_insert(
-        (ZixTree*)unload_uris, lilv_node_duplicate(plugin_uri), NULL);
-      LILV_WARNF("Replacing version %d.%d of <%s> from <%s>\n",
-                 last_version.minor,
-                 last_version.micro,
-                 sord_node_get_string(plug),
-                 sord_node_get_string(last_bundle->node));
-      LILV_NOTEF("New version %d.%d found in <%s>\n",
-                 this_version.minor,
-                 this_version.micro,
-                 sord_node_get_string(bundle_node));
-    } else if (cmp < 0) {
-      LILV_WARNF("Ignoring bundle <%s>\n", sord_node_get_string(bundle_node));
-      LILV_NOTEF("Newer version of <%s> loaded from <%s>\n",
-                 sord_node_get_string(plug),
-                 sord_node_get_string(last_bundle->node));
-      lilv_node_free(plugin_uri);
-      sord_iter_free(plug_results);
-      lilv_world_drop_graph(world, bundle_node);
-      lilv_node_free(manifest);
-      lilv_nodes_free(unload_uris);
-      return;
+/** Record the data files and binaries listed in the manifest of `bundle`. */
+static void
+lilv_bundle_add_data_files(LilvBundle* const bundle)
+{
+  LilvWorld* const world   = bundle->world;
+  const SordNode*  preds[] = {
+    world->uris.rdfs_seeAlso, world->uris.lv2_binary, NULL};
+
+  for (const SordNode** p = preds; *p; ++p) {
+    SordIter* i = sord_search(world->model, NULL, *p, NULL, bundle->uri->node);
+    FOREACH_MATCH (i) {
+      lilv_bundle_add_file_uri(bundle, sord_iter_get_node(i, SORD_OBJECT));
     }
-    lilv_node_free(plugin_uri);
+    sord_iter_free(i);
   }
+}
 
-  sord_iter_free(plug_results);
+/** Return true if the directory of `bundle` no longer exists. */
+static bool
+lilv_bundle_is_removed(const LilvBundle* const bundle)
+{
+  // The bundle directory is always the first file, if the URI is local
+  return bundle->n_files && lilv_file_stamp(bundle->files[0].path).time < 0;
+}
+
+/** Return true if any file in `bundle` has changed since it was recorded. */
+static bool
+lilv_bundle_is_modified(const LilvBundle* const bundle)
+{
+  for (unsigned i = 0U; i < bundle->n_files; ++i) {
+    const LilvBundleFile* const file  = &bundle->files[i];
+    const LilvFileStamp         stamp = lilv_file_stamp(file->path);
+    if (stamp.time != file->stamp.time || stamp.size != file->stamp.size) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/** Remove the record of a loaded bundle, if there is one. */
+static void
+lilv_world_forget_bundle(LilvWorld* world, const LilvNode* bundle_uri)
+{
+  LilvIter* const i = lilv_collection_find_by_uri(world->bundles, bundle_uri);
+  if (i) {
+    lilv_collection_remove(world->bundles, i);
+  }
+}
+
+/** Return true if the file at `uri` is within the bundle at `bundle_uri`. */
+static bool
+lilv_uri_is_in_bundle(const LilvNode* uri, const LilvNode* bundle_uri)
+{
+  size_t            len    = 0U;
+  const char* const prefix = (const char*)sord_node_get_string_counted(
+    bundle_uri->node, &len);
+
+  return !strncmp(lilv_node_as_uri(uri), prefix, len);
+}
+
+/**
+   Record a bundle that is about to be loaded, replacing any previous record.
+
+   The bundle directory and manifest are stamped before anything is read, so
+   that changes made while loading are seen by the next rescan.
+*/
+static LilvBundle*
+lilv_world_add_bundle(LilvWorld*      world,
+                      const LilvNode* bundle_uri,
+                      const LilvNode* manifest)
+{
+  LilvBundle* const bundle = (LilvBundle*)calloc(1, sizeof(LilvBundle));
+
+  bundle->world = world;
+  bundle->uri   = lilv_node_duplicate(bundle_uri);
+
+  LilvBundle* const old =
+    (LilvBundle*)lilv_collection_get_by_uri(world->bundles, bundle_uri);
+  if (old) {
+    // Keep what has already been loaded from the bundle
+    bundle->loaded_files = old->loaded_files;
+    bundle->plugins      = old->plugins;
+    old->loaded_files    = NULL;
+    old->plugins         = NULL;
+    lilv_world_forget_bundle(world, bundle_uri);
+  } else {
+    bundle->loaded_files = lilv_collection_new(lilv_resource_node_cmp,
+                                               (LilvFreeFunc)lilv_node_free);
+    bundle->plugins      = lilv_plugins_new();
+
+    // Adopt any files in the bundle that were loaded before it
+    LilvCollection* const orphans = world->orphan_files;
+    for (size_t i = 0U; i < orphans->size;) {
+      LilvNode* const file = (LilvNode*)orphans->elems[i];
+      if (lilv_uri_is_in_bundle(file, bundle_uri)) {
+        lilv_collection_insert(bundle->loaded_files, lilv_node_duplicate(file));
+        lilv_collection_remove(orphans, (LilvIter*)&orphans->elems[i]);
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  lilv_bundle_add_file_uri(bundle, bundle_uri->node);
+  lilv_bundle_add_file_uri(bundle, manifest->node);
+
+  lilv_collection_insert(world->bundles, bundle);
+  return bundle;
+}
+
+/** Return the record of the bundle with URI `uri[0:len]`, or NULL. */
+static LilvBundle*
+lilv_world_find_bundle_by_prefix(LilvWorld*   world,
+                                 const char*  uri,
+                                 const size_t len)
+{
+  // Binary search, since bundles are sorted by URI
+  size_t lo = 0U;
+  size_t hi = world->bundles->size;
+  while (lo < hi) {
+    const size_t      mid    = lo + ((hi - lo) / 2U);
+    LilvBundle* const bundle = (LilvBundle*)world->bundles->elems[mid];
+    const char* const str    = lilv_node_as_uri(bundle->uri);
+
+    int cmp = strncmp(str, uri, len);
+    if (!cmp) {
+      cmp = str[len] ? 1 : 0;
+    }
+
+    if (!cmp) {
+      return bundle;
+    }
+
+    if (cmp < 0) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return NULL;
+}
+
+/** Return the record of the loaded bundle that contains `uri`, or NULL. */
+static LilvBundle*
+lilv_world_find_bundle_for_uri(LilvWorld* world, const LilvNode* uri)
+{
+  // Try each parent directory, starting with the deepest
+  const char* const str = lilv_node_as_uri(uri);
+  for (size_t len = strlen(str); len > 0U; --len) {
+    if (str[len - 1U] == '/') {
+      LilvBundle* const bundle =
+        lilv_world_find_bundle_by_prefix(world, str, len);
+      if (bundle) {
+        return bundle;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/** Add a file to the set of loaded files, and the record of its bundle. */
+static void
+lilv_world_add_loaded_file(LilvWorld* world, const LilvNode* uri)
+{
+  lilv_collection_insert(world->loaded_files, lilv_node_duplicate(uri));
+
+  LilvBundle* const bundle = lilv_world_find_bundle_for_uri(world, uri);
+  LilvNodes* const  files =
+    bundle ? bundle->loaded_files : world->orphan_files;
+
+  LilvNode* const copy = lilv_node_duplicate(uri);
+  if (lilv_collection_insert(files, copy)) {
+    lilv_node_free(copy);
+  }
+}
+
+/** Read a bundle manifest into the model, from the cache if possible. */
+static SerdStatus
+lilv_world_load_manifest(LilvWorld*      world,
+                         SordNode*       bundle_node,
+                         const LilvNode* manifest)
+{
+  if (!world->cache) {
+    return lilv_world_load_graph(world, bundle_node, manifest);
+  }
+
+  if (lilv_collection_find(world->loaded_files, manifest)) {
+    return SERD_FAILURE; // File has already been loaded
+  }
+
+  char* const path = lilv_file_uri_parse(lilv_node_as_uri(manifest), NULL);
+  if (!path) {
+    return lilv_world_load_graph(world, bundle_node, manifest);
+  }
+
+  SerdStatus st = SERD_SUCCESS;
+  if (!lilv_cache_replay(world->cache, world, bundle_node)) {
+    lilv_world_add_loaded_file(world, manifest);
+  } else {
+    // Stamp before parsing so that concurrent changes invalidate the entry
+    const LilvFileStamp stamp = lilv_file_stamp(path);
+
+    st = lilv_world_load_graph(world, bundle_node, manifest);
+    if (!st) {
+      lilv_cache_update(world->cache, world, bundle_node, path, stamp);
+    }
+  }
+
+  lilv_free(path);
+  return st;
+}
+
+/** Load a bundle while the world is locked. */
+static void
+lilv_world_load_bundle_locked(LilvWorld* world, const LilvNode* bundle_uri)
+{
+  SordNode*   bundle_node = bundle_uri->node;
+  LilvNode*   manifest    = lilv_world_get_manifest_uri(world, bundle_uri);
+  LilvBundle* record      = lilv_world_add_bundle(world, bundle_uri, manifest);
+
+  // Read manifest into model with graph = bundle_node
+  SerdStatus st = lilv_world_load_manifest(world, bundle_node, manifest);
+  if (st > SERD_FAILURE) {
+    LILV_ERRORF("Error reading %s\n", lilv_node_as_string(manifest));
+    lilv_node_free(manifest);
+    return;
+  }
+
+  lilv_bundle_add_data_files(record);
+
+  // ?plugin a lv2:Plugin
+  SordIter* plug_results = sord_search(
+    world->model, NULL, world->uris.rdf_a, world->uris.lv2_Plugin, bundle_node);
+
+  // Find any loaded plugins that will be replaced with a newer version
+  LilvNodes* unload_uris = lilv_nodes_new();
+  FOREACH_MATCH (plug_results) {
+    const SordNode* plug = sord_iter_get_node(plug_results, SORD_SUBJECT);
+
+    LilvNode*         plugin_uri = lilv_node_new_from_node(world, plug);
+    const LilvPlugin* plugin =
+      lilv_plugins_get_by_uri(world->plugins, plugin_uri);
+    const LilvNode* last_bundle =
+      plugin ? lilv_plugin_get_bundle_uri(plugin) : NULL;
+    if (!plugin || sord_node_equals(bundle_node, last_bundle->node)) {
+      // No previously loaded version, or it's from the same bundle
+      lilv_node_free(plugin_uri);
+      continue;
+    }
+
+    // Compare versions
+    const LilvVersion this_version =
+      lilv_world_get_plugin_version(world, bundle_uri, plugin_uri);
+    const LilvVersion last_version =
+      lilv_world_get_plugin_version(world, last_bundle, plugin_uri);
+    const int cmp = lilv_version_cmp(&this_version, &last_version);
+    if (cmp > 0) {
+      lilv_collection_insert(unload_uris, lilv_node_duplicate(plugin_uri));
+      LILV_WARNF("Replacing version %d.%d of <%s> from <%s>\n",
+                 last_version.minor,
+                 last_version.micro,
+                 sord_node_get_string(plug),
+                 sord_node_get_string(last_bundle->node));
+      LILV_NOTEF("New version %d.%d found in <%s>\n",
+                 this_version.minor,
+                 this_version.micro,
+                 sord_node_get_string(bundle_node));
+    } else if (cmp < 0) {
+      LILV_WARNF("Ignoring bundle <%s>\n", sord_node_get_string(bundle_node));
+      LILV_NOTEF("Newer version of <%s> loaded from <%s>\n",
+                 sord_node_get_string(plug),
+                 sord_node_get_string(last_bundle->node));
+      lilv_node_free(plugin_uri);
+      sord_iter_free(plug_results);
+      lilv_world_unload_bundle_data(world, bundle_uri);
+      record->displaced = true;
+      lilv_node_free(manifest);
+      lilv_nodes_free(unload_uris);
+      return;
+    }
+    lilv_node_free(plugin_uri);
+  }
+
+  sord_iter_free(plug_results);
 
   // Unload any old conflicting plugins
   LilvNodes* unload_bundles = lilv_nodes_new();
@@ -817,15 +1516,22 @@ lilv_world_load_bundle(LilvWorld* world, const LilvNode* bundle_uri)
 
     // Unload plugin and record bundle for later unloading
     lilv_world_unload_resource(world, uri);
-    zix_tree_insert(
-      (ZixTree*)unload_bundles, lilv_node_duplicate(bundle), NULL);
+    lilv_collection_insert(unload_bundles, lilv_node_duplicate(bundle));
   }
   lilv_nodes_free(unload_uris);
 
   // Now unload the associated bundles
   // This must be done last since several plugins could be in the same bundle
+  // Their records are kept, so they are reconsidered if this one is removed
   LILV_FOREACH (nodes, i, unload_bundles) {
-    lilv_world_unload_bundle(world, lilv_nodes_get(unload_bundles, i));
+    const LilvNode* const old_uri = lilv_nodes_get(unload_bundles, i);
+    LilvBundle* const     old_bundle =
+      (LilvBundle*)lilv_collection_get_by_uri(world->bundles, old_uri);
+
+    lilv_world_unload_bundle_data(world, old_uri);
+    if (old_bundle) {
+      old_bundle->displaced = true;
+    }
   }
   lilv_nodes_free(unload_bundles);
 
@@ -858,43 +1564,89 @@ lilv_world_load_bundle(LilvWorld* world, const LilvNode* bundle_uri)
   lilv_node_free(manifest);
 }
 
+void
+lilv_world_load_bundle(LilvWorld* world, const LilvNode* bundle_uri)
+{
+  if (!lilv_node_is_uri(bundle_uri)) {
+    LILV_ERRORF("Bundle URI `%s' is not a URI\n",
+                sord_node_get_string(bundle_uri->node));
+    return;
+  }
+
+  lilv_world_lock(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to load a bundle into a frozen world\n");
+  } else {
+    lilv_world_load_bundle_locked(world, bundle_uri);
+  }
+  lilv_world_unlock(world);
+}
+
+/**
+   Remove every statement in `graph` from the model.
+
+   The model has graph-first indices, so this is a range scan over only the
+   statements in the graph, and each statement is erased in place without
+   searching again.
+*/
 static int
 lilv_world_drop_graph(LilvWorld* world, const SordNode* graph)
 {
-  SordIter* i = sord_search(world->model, NULL, NULL, NULL, graph);
-  while (!sord_iter_end(i)) {
-    const SerdStatus st = sord_erase(world->model, i);
-    if (st) {
+  SerdStatus st = SERD_SUCCESS;
+  SordIter*  i  = sord_search(world->model, NULL, NULL, NULL, graph);
+  while (!st && !sord_iter_end(i)) {
+    if ((st = sord_erase(world->model, i))) {
       LILV_ERRORF("Error removing statement from <%s> (%s)\n",
                   sord_node_get_string(graph),
                   serd_strerror(st));
-      return st;
     }
   }
   sord_iter_free(i);
 
-  return 0;
+  ++world->epoch;
+  return (int)st;
 }
 
 /** Remove loaded_files entry so file will be reloaded if requested. */
 static int
 lilv_world_unload_file(LilvWorld* world, const LilvNode* file)
 {
-  ZixTreeIter* iter = NULL;
-  if (!zix_tree_find((ZixTree*)world->loaded_files, file, &iter)) {
-    zix_tree_remove((ZixTree*)world->loaded_files, iter);
+  LilvIter* const orphan = lilv_collection_find(world->orphan_files, file);
+  if (orphan) {
+    lilv_collection_remove(world->orphan_files, orphan);
+  }
+
+  LilvIter* const iter = lilv_collection_find(world->loaded_files, file);
+  if (iter) {
+    lilv_collection_remove(world->loaded_files, iter);
     return 0;
   }
   return 1;
 }
 
-int
-lilv_world_unload_bundle(LilvWorld* world, const LilvNode* bundle_uri)
+/** Remove the specifications that were found in a bundle. */
+static void
+lilv_world_remove_specs(LilvWorld* world, const SordNode* bundle_node)
 {
-  if (!bundle_uri) {
-    return 0;
+  for (LilvSpec** s = &world->specs; *s;) {
+    LilvSpec* const spec = *s;
+    if (sord_node_equals(spec->bundle, bundle_node)) {
+      world->n_unloaded_specs -= spec->loaded ? 0U : 1U;
+      *s = spec->next;
+      sord_node_free(world->world, spec->spec);
+      sord_node_free(world->world, spec->bundle);
+      lilv_nodes_free(spec->data_uris);
+      free(spec);
+    } else {
+      s = &spec->next;
+    }
   }
+}
 
+/** Unload all loaded files with URIs that start with `bundle_uri`. */
+static void
+lilv_world_unload_files_in(LilvWorld* world, const LilvNode* bundle_uri)
+{
   // Find all loaded files that are inside the bundle
   LilvNodes* files = lilv_nodes_new();
   LILV_FOREACH (nodes, i, world->loaded_files) {
@@ -902,17 +1654,26 @@ lilv_world_unload_bundle(LilvWorld* world, const LilvNode* bundle_uri)
     if (!strncmp(lilv_node_as_string(file),
                  lilv_node_as_string(bundle_uri),
                  strlen(lilv_node_as_string(bundle_uri)))) {
-      zix_tree_insert((ZixTree*)files, lilv_node_duplicate(file), NULL);
+      lilv_collection_insert(files, lilv_node_duplicate(file));
     }
   }
 
   // Unload all loaded files in the bundle
   LILV_FOREACH (nodes, i, files) {
-    const LilvNode* file = lilv_nodes_get(world->plugins, i);
+    const LilvNode* file = lilv_nodes_get(files, i);
     lilv_world_unload_file(world, file);
   }
 
   lilv_nodes_free(files);
+}
+
+/** Unload the files and plugins recorded for a bundle, and clear them. */
+static void
+lilv_world_unload_bundle_contents(LilvWorld* world, LilvBundle* bundle)
+{
+  LILV_FOREACH (nodes, i, bundle->loaded_files) {
+    lilv_world_unload_file(world, lilv_nodes_get(bundle->loaded_files, i));
+  }
 
   /* Remove any plugins in the bundle from the plugin list.  Since the
      application may still have a pointer to the LilvPlugin, it can not be
@@ -920,23 +1681,64 @@ lilv_world_unload_bundle(LilvWorld* world, const LilvNode* bundle_uri)
      will not be in the list returned by lilv_world_get_all_plugins() but can
      still be used.
   */
-  ZixTreeIter* i = zix_tree_begin((ZixTree*)world->plugins);
-  while (i && i != zix_tree_end((ZixTree*)world->plugins)) {
-    LilvPlugin*  p    = (LilvPlugin*)zix_tree_get(i);
-    ZixTreeIter* next = zix_tree_iter_next(i);
-
-    if (lilv_node_equals(lilv_plugin_get_bundle_uri(p), bundle_uri)) {
-      zix_tree_remove((ZixTree*)world->plugins, i);
-      zix_tree_insert((ZixTree*)world->zombies, p, NULL);
+  LILV_FOREACH (plugins, i, bundle->plugins) {
+    LilvPlugin* const p = (LilvPlugin*)lilv_plugins_get(bundle->plugins, i);
+    LilvIter* const   z =
+      lilv_collection_find_by_uri(world->plugins, p->plugin_uri);
+
+    if (lilv_collection_get(world->plugins, z) == p) {
+      lilv_collection_remove(world->plugins, z);
+      lilv_collection_insert(world->zombies, p);
     }
+  }
 
-    i = next;
+  lilv_collection_free(bundle->plugins);
+  lilv_collection_free(bundle->loaded_files);
+  bundle->loaded_files = lilv_collection_new(lilv_resource_node_cmp,
+                                             (LilvFreeFunc)lilv_node_free);
+  bundle->plugins      = lilv_plugins_new();
+}
+
+/** Unload everything loaded from a bundle, but keep its record. */
+static int
+lilv_world_unload_bundle_data(LilvWorld* world, const LilvNode* bundle_uri)
+{
+  LilvBundle* const bundle =
+    (LilvBundle*)lilv_collection_get_by_uri(world->bundles, bundle_uri);
+
+  if (bundle) {
+    lilv_world_unload_bundle_contents(world, bundle);
+  } else {
+    // Not loaded as a bundle, but files in it may have been loaded directly
+    lilv_world_unload_files_in(world, bundle_uri);
   }
 
   // Drop everything in bundle graph
   return lilv_world_drop_graph(world, bundle_uri->node);
 }
 
+int
+lilv_world_unload_bundle(LilvWorld* world, const LilvNode* bundle_uri)
+{
+  if (!bundle_uri) {
+    return 0;
+  }
+
+  lilv_world_lock(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to unload a bundle from a frozen world\n");
+    lilv_world_unlock(world);
+    return -1;
+  }
+
+  const int st = lilv_world_unload_bundle_data(world, bundle_uri);
+
+  lilv_world_forget_bundle(world, bundle_uri);
+  lilv_world_remove_specs(world, bundle_uri->node);
+  lilv_world_unlock(world);
+  return st;
+}
+
 static void
 load_dir_entry(const char* dir, const char* name, void* data)
 {
@@ -951,13 +1753,158 @@ load_dir_entry(const char* dir, const char* name, void* data)
   free(path);
 }
 
+/** A bundle to be parsed during parallel discovery. */
+typedef struct {
+  char*           bundle_uri;    ///< Bundle directory URI
+  char*           manifest_uri;  ///< Manifest file URI
+  char*           manifest_path; ///< Manifest file path
+  LilvCacheEntry* entry;         ///< Parsed manifest, or NULL
+} DiscoveryJob;
+
+typedef struct {
+  DiscoveryJob* jobs;
+  size_t        n_jobs;
+} DiscoveryJobs;
+
+typedef struct {
+  const LilvCache* cache;  ///< Cache to check before parsing
+  DiscoveryJobs*   jobs;   ///< All jobs
+  size_t           offset; ///< Index of first job for this worker
+  size_t           stride; ///< Number of workers
+  ZixThread        thread; ///< Thread, if one was launched
+  bool             active; ///< True if `thread` must be joined
+} DiscoveryWorker;
+
+static void
+add_discovery_job(const char* dir, const char* name, void* data)
+{
+  DiscoveryJobs* const jobs = (DiscoveryJobs*)data;
+  char* const          path = lilv_strjoin(dir, "/", name, "/", NULL);
+  SerdNode suri = serd_node_new_file_uri((const uint8_t*)path, 0, 0, true);
+
+  jobs->jobs = (DiscoveryJob*)realloc(
+    jobs->jobs, (jobs->n_jobs + 1U) * sizeof(DiscoveryJob));
+
+  DiscoveryJob* const job = &jobs->jobs[jobs->n_jobs++];
+
+  job->bundle_uri    = lilv_strdup((const char*)suri.buf);
+  job->manifest_uri  = lilv_strjoin(job->bundle_uri, "manifest.ttl", NULL);
+  job->manifest_path = lilv_strjoin(path, "manifest.ttl", NULL);
+  job->entry         = NULL;
+
+  serd_node_free(&suri);
+  free(path);
+}
+
+static ZIX_THREAD_FUNC ZixThreadResult
+discovery_thread(void* data)
+{
+  const DiscoveryWorker* const worker = (const DiscoveryWorker*)data;
+  DiscoveryJobs* const         jobs   = worker->jobs;
+
+  for (size_t i = worker->offset; i < jobs->n_jobs; i += worker->stride) {
+    DiscoveryJob* const job = &jobs->jobs[i];
+    if (!lilv_cache_is_fresh(worker->cache, job->bundle_uri)) {
+      job->entry = lilv_cache_parse(
+        job->bundle_uri, job->manifest_uri, job->manifest_path);
+    }
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+/**
+   Load all bundles in the directory at `path`, parsing manifests in parallel.
+
+   Worker threads parse manifests into cache entries without touching the
+   world, then bundles are loaded as usual in directory order, which replays
+   the parsed manifests.  The result is the same as loading serially, since
+   any manifest that fails to parse here is parsed again by
+   lilv_world_load_bundle(), which reports errors as usual.
+*/
+static void
+lilv_world_load_directory_parallel(LilvWorld* world, const char* path)
+{
+  DiscoveryJobs jobs = {NULL, 0U};
+  zix_dir_for_each(path, &jobs, add_discovery_job);
+  if (!jobs.n_jobs) {
+    return;
+  }
+
+  // Use a temporary cache to pass parsed manifests to lilv_world_load_bundle()
+  const bool temporary_cache = !world->cache;
+  if (temporary_cache) {
+    world->cache = lilv_cache_new(NULL);
+  }
+
+  // Parse manifests, with the calling thread acting as the first worker
+  const size_t n_workers = world->opt.discovery_threads < jobs.n_jobs
+                             ? world->opt.discovery_threads
+                             : jobs.n_jobs;
+
+  DiscoveryWorker* const workers =
+    (DiscoveryWorker*)calloc(n_workers, sizeof(DiscoveryWorker));
+
+  for (size_t i = 0U; i < n_workers; ++i) {
+    workers[i].cache  = world->cache;
+    workers[i].jobs   = &jobs;
+    workers[i].offset = i;
+    workers[i].stride = n_workers;
+  }
+
+  for (size_t i = 1U; i < n_workers; ++i) {
+    workers[i].active =
+      !zix_thread_create(&workers[i].thread, 0U, discovery_thread, &workers[i]);
+  }
+
+  discovery_thread(&workers[0]);
+
+  for (size_t i = 1U; i < n_workers; ++i) {
+    if (workers[i].active) {
+      zix_thread_join(workers[i].thread);
+    } else {
+      discovery_thread(&workers[i]); // Failed to launch, do the work here
+    }
+  }
+
+  free(workers);
+
+  // Load bundles in order, replaying parsed manifests
+  for (size_t i = 0U; i < jobs.n_jobs; ++i) {
+    DiscoveryJob* const job = &jobs.jobs[i];
+    if (job->entry) {
+      lilv_cache_insert(world->cache, job->entry);
+    }
+
+    LilvNode* const node = lilv_new_uri(world, job->bundle_uri);
+    lilv_world_load_bundle(world, node);
+    lilv_node_free(node);
+
+    free(job->manifest_path);
+    free(job->manifest_uri);
+    free(job->bundle_uri);
+  }
+
+  free(jobs.jobs);
+
+  if (temporary_cache) {
+    lilv_cache_free(world->cache);
+    world->cache = NULL;
+  }
+}
+
 /** Load all bundles in the directory at `dir_path`. */
 static void
-lilv_world_load_directory(LilvWorld* world, const char* dir_path)
+lilv_world_load_directory(const char* dir_path, void* data)
 {
-  char* path = lilv_expand(dir_path);
+  LilvWorld* const world = (LilvWorld*)data;
+  char*            path  = lilv_expand(dir_path);
   if (path) {
-    zix_dir_for_each(path, world, load_dir_entry);
+    if (world->opt.discovery_threads > 1U) {
+      lilv_world_load_directory_parallel(world, path);
+    } else {
+      zix_dir_for_each(path, world, load_dir_entry);
+    }
     free(path);
   }
 }
@@ -973,13 +1920,15 @@ first_path_sep(const char* path)
   return NULL;
 }
 
-/** Load all bundles found in `lv2_path`.
+/** Call `f` with every directory in `lv2_path`.
  * @param lv2_path A colon-delimited list of directories.  These directories
  * should contain LV2 bundle directories (ie the search path is a list of
  * parent directories of bundles, not a list of bundle directories).
  */
-static void
-lilv_world_load_path(LilvWorld* world, const char* lv2_path)
+void
+lilv_for_each_path_dir(const char* lv2_path,
+                       void*       data,
+                       void (*f)(const char* dir, void* data))
 {
   while (lv2_path[0] != '\0') {
     const char* const sep = first_path_sep(lv2_path);
@@ -988,25 +1937,120 @@ lilv_world_load_path(LilvWorld* world, const char* lv2_path)
       char* const  dir     = (char*)malloc(dir_len + 1);
       memcpy(dir, lv2_path, dir_len);
       dir[dir_len] = '\0';
-      lilv_world_load_directory(world, dir);
+      f(dir, data);
       free(dir);
       lv2_path += dir_len + 1;
     } else {
-      lilv_world_load_directory(world, lv2_path);
+      f(lv2_path, data);
       lv2_path = "\0";
     }
   }
 }
 
+/** Return the LV2 search path from the world options or the environment. */
+const char*
+lilv_world_get_lv2_path(const LilvWorld* world)
+{
+  const char* lv2_path = world->opt.lv2_path;
+  if (!lv2_path) {
+    lv2_path = getenv("LV2_PATH");
+  }
+  if (!lv2_path) {
+    lv2_path = LILV_DEFAULT_LV2_PATH;
+  }
+
+  return lv2_path;
+}
+
+/** Load the data files of a specification. */
+static void
+lilv_world_load_spec(LilvWorld* world, LilvSpec* spec)
+{
+  spec->loaded = true;
+  --world->n_unloaded_specs;
+
+  LILV_FOREACH (nodes, f, spec->data_uris) {
+    LilvNode* file = (LilvNode*)lilv_collection_get(spec->data_uris, f);
+    lilv_world_load_graph(world, NULL, file);
+  }
+}
+
 void
 lilv_world_load_specifications(LilvWorld* world)
 {
+  lilv_world_lock(world);
   for (LilvSpec* spec = world->specs; spec; spec = spec->next) {
-    LILV_FOREACH (nodes, f, spec->data_uris) {
-      LilvNode* file = (LilvNode*)lilv_collection_get(spec->data_uris, f);
-      lilv_world_load_graph(world, NULL, file);
+    if (!spec->loaded) {
+      lilv_world_load_spec(world, spec);
     }
   }
+  lilv_world_unlock(world);
+}
+
+/**
+   Load any unloaded specification that `node` is within.
+
+   A node is within a specification if the specification URI is a prefix of
+   it, followed by a separator (or nothing).  This must not be called while
+   iterating over the model, since it may add statements to it.
+*/
+void
+lilv_world_load_specs_for(LilvWorld* world, const SordNode* node)
+{
+  if (!world->n_unloaded_specs || !node ||
+      sord_node_get_type(node) != SORD_URI) {
+    return;
+  }
+
+  size_t            len = 0U;
+  const char* const str =
+    (const char*)sord_node_get_string_counted(node, &len);
+
+  for (LilvSpec* spec = world->specs; spec; spec = spec->next) {
+    size_t            spec_len = 0U;
+    const char* const spec_str =
+      (const char*)sord_node_get_string_counted(spec->spec, &spec_len);
+
+    if (!spec->loaded && spec_len && len >= spec_len &&
+        !strncmp(str, spec_str, spec_len) &&
+        (spec_str[spec_len - 1] == '#' || spec_str[spec_len - 1] == '/' ||
+         str[spec_len] == '\0' || str[spec_len] == '#' ||
+         str[spec_len] == '/')) {
+      lilv_world_load_spec(world, spec);
+    }
+  }
+}
+
+/** Add `class_node` to the plugin classes if it is fully described. */
+static void
+lilv_world_add_plugin_class(LilvWorld* world, const SordNode* class_node)
+{
+  SordNode* parent = sord_get(
+    world->model, class_node, world->uris.rdfs_subClassOf, NULL, NULL);
+  if (!parent || sord_node_get_type(parent) != SORD_URI) {
+    sord_node_free(world->world, parent);
+    return;
+  }
+
+  SordNode* label =
+    sord_get(world->model, class_node, world->uris.rdfs_label, NULL, NULL);
+  if (!label) {
+    sord_node_free(world->world, parent);
+    return;
+  }
+
+  LilvPluginClass* pclass = lilv_plugin_class_new(
+    world, parent, class_node, (const char*)sord_node_get_string(label));
+  if (pclass) {
+    if (lilv_collection_insert(world->plugin_classes, pclass)) {
+      lilv_plugin_class_free(pclass); // Already loaded
+    } else {
+      world->class_index_stale = true;
+    }
+  }
+
+  sord_node_free(world->world, label);
+  sord_node_free(world->world, parent);
 }
 
 void
@@ -1018,75 +2062,361 @@ lilv_world_load_plugin_classes(LilvWorld* world)
      is e.g. how a host would build a menu), they won't be seen anyway...
   */
 
+  lilv_world_lock(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to reload plugin classes of a frozen world\n");
+    lilv_world_unlock(world);
+    return;
+  }
+
+  if (world->opt.lazy_specs) {
+    // Classes may be defined by any specification, so load them all
+    lilv_world_load_specifications(world);
+  }
+
   SordIter* classes = sord_search(
     world->model, NULL, world->uris.rdf_a, world->uris.rdfs_Class, NULL);
   FOREACH_MATCH (classes) {
-    const SordNode* class_node = sord_iter_get_node(classes, SORD_SUBJECT);
+    lilv_world_add_plugin_class(
+      world, sord_iter_get_node(classes, SORD_SUBJECT));
+  }
+  sord_iter_free(classes);
+
+  world->classes_pending = false;
+  lilv_world_unlock(world);
+}
+
+/** Load all plugin classes if that was deferred by lazy loading. */
+void
+lilv_world_load_classes_if_necessary(LilvWorld* world)
+{
+  if (world->classes_pending) {
+    lilv_world_load_plugin_classes(world);
+  }
+}
+
+/**
+   Return the plugin class with the given URI.
+
+   If loading is deferred, then this only loads the specifications that the
+   class is within, rather than every plugin class.
+*/
+const LilvPluginClass*
+lilv_world_get_plugin_class_by_uri(LilvWorld* world, const LilvNode* uri)
+{
+  const LilvPluginClass* pclass =
+    lilv_plugin_classes_get_by_uri(world->plugin_classes, uri);
+
+  if (!pclass && world->classes_pending) {
+    lilv_world_load_specs_for(world, uri->node);
+    if (sord_ask(world->model,
+                 uri->node,
+                 world->uris.rdf_a,
+                 world->uris.rdfs_Class,
+                 NULL)) {
+      lilv_world_add_plugin_class(world, uri->node);
+      pclass = lilv_plugin_classes_get_by_uri(world->plugin_classes, uri);
+    }
+  }
+
+  return pclass;
+}
+
+/** Load specifications and plugin classes, unless they are loaded lazily. */
+static void
+lilv_world_load_specs_and_classes(LilvWorld* world)
+{
+  if (world->opt.lazy_specs) {
+    world->classes_pending = true;
+  } else {
+    lilv_world_load_specifications(world);
+    lilv_world_load_plugin_classes(world);
+  }
+}
 
-    SordNode* parent = sord_get(
-      world->model, class_node, world->uris.rdfs_subClassOf, NULL, NULL);
-    if (!parent || sord_node_get_type(parent) != SORD_URI) {
+/**
+   Update the replacements and flag every replaced plugin.
+
+   This makes a single pass over every ?new dc:replaces ?old statement, and
+   only considers those where ?new is a known plugin.
+*/
+static void
+lilv_world_update_replaced(LilvWorld* world)
+{
+  LILV_FOREACH (plugins, p, world->plugins) {
+    LilvPlugin* plugin = (LilvPlugin*)lilv_collection_get(world->plugins, p);
+
+    plugin->replaced = false;
+  }
+
+  lilv_collection_free(world->replacements);
+  world->replacements =
+    lilv_collection_new(lilv_header_compare_by_uri, destroy_replacement);
+
+  LilvMatches  matches;
+  LilvMatches* r = lilv_world_query_internal(
+    world, NULL, world->uris.dc_replaces, NULL, &matches);
+  FOREACH_MATCHES (r) {
+    const SordNode* new_node = lilv_matches_get_node(r, SORD_SUBJECT);
+    const SordNode* old_node = lilv_matches_get_node(r, SORD_OBJECT);
+    if (sord_node_get_type(new_node) != SORD_URI ||
+        sord_node_get_type(old_node) != SORD_URI) {
       continue;
     }
 
-    SordNode* label =
-      sord_get(world->model, class_node, world->uris.rdfs_label, NULL, NULL);
-    if (!label) {
-      sord_node_free(world->world, parent);
+    LilvNode* const new_uri = lilv_node_new_from_node(world, new_node);
+    if (!lilv_plugins_get_by_uri(world->plugins, new_uri)) {
+      lilv_node_free(new_uri); // Replacement is not a known plugin
       continue;
     }
 
-    LilvPluginClass* pclass = lilv_plugin_class_new(
-      world, parent, class_node, (const char*)sord_node_get_string(label));
-    if (pclass) {
-      zix_tree_insert((ZixTree*)world->plugin_classes, pclass, NULL);
+    LilvReplacement* const replacement =
+      (LilvReplacement*)malloc(sizeof(LilvReplacement));
+
+    replacement->world       = world;
+    replacement->uri         = lilv_node_new_from_node(world, old_node);
+    replacement->replacement = new_uri;
+
+    LilvPlugin* const old = (LilvPlugin*)lilv_plugins_get_by_uri(
+      world->plugins, replacement->uri);
+    if (old) {
+      old->replaced = true;
     }
 
-    sord_node_free(world->world, label);
-    sord_node_free(world->world, parent);
+    if (lilv_collection_insert(world->replacements, replacement)) {
+      destroy_replacement(replacement); // Already replaced by another
+    }
   }
-  sord_iter_free(classes);
+  lilv_matches_close(r);
 }
 
 void
 lilv_world_load_all(LilvWorld* world)
 {
-  const char* lv2_path = world->opt.lv2_path;
-  if (!lv2_path) {
-    lv2_path = getenv("LV2_PATH");
-  }
-  if (!lv2_path) {
-    lv2_path = LILV_DEFAULT_LV2_PATH;
+  lilv_world_lock(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to load bundles into a frozen world\n");
+    lilv_world_unlock(world);
+    return;
   }
 
   // Discover bundles and read all manifest files into model
-  lilv_world_load_path(world, lv2_path);
+  lilv_for_each_path_dir(
+    lilv_world_get_lv2_path(world), world, lilv_world_load_directory);
 
-  LILV_FOREACH (plugins, p, world->plugins) {
-    const LilvPlugin* plugin =
-      (const LilvPlugin*)lilv_collection_get((ZixTree*)world->plugins, p);
+  lilv_world_update_replaced(world);
 
-    // ?new dc:replaces plugin
-    if (sord_ask(world->model,
-                 NULL,
-                 world->uris.dc_replaces,
-                 lilv_plugin_get_uri(plugin)->node,
-                 NULL)) {
-      // TODO: Check if replacement is a known plugin? (expensive)
-      ((LilvPlugin*)plugin)->replaced = true;
+  // Query out things to cache
+  lilv_world_load_specs_and_classes(world);
+
+  // Save discovered manifests, dropping any bundles that have disappeared
+  if (world->cache) {
+    lilv_cache_save(world->cache, true);
+  }
+
+  lilv_world_unlock(world);
+}
+
+int
+lilv_world_save_image(LilvWorld* world, const char* path)
+{
+  // Load everything the image should contain, but leave the world changeable
+  lilv_world_lock(world);
+  lilv_world_load_pending(world);
+
+  const int st = lilv_image_write(world, path);
+
+  lilv_world_unlock(world);
+  return st;
+}
+
+LilvWorld*
+lilv_world_new_from_image(const char* path)
+{
+  LilvImage* const image = lilv_image_open(path);
+  if (!image) {
+    return NULL;
+  }
+
+  LilvWorld* const world = lilv_world_new();
+  if (!world) {
+    lilv_image_free(image);
+    return NULL;
+  }
+
+  // Lock directly, since lilv_world_unlock() does nothing once this is done
+  lilv_mutex_lock(&world->mutex);
+  world->image = image;
+  if (lilv_image_load(image, world)) {
+    LILV_ERRORF("Failed to load world image `%s'\n", path);
+    lilv_mutex_unlock(&world->mutex);
+    lilv_world_free(world);
+    return NULL;
+  }
+
+  lilv_world_update_replaced(world);
+  lilv_plugin_class_update_index(world);
+
+  // Everything is already loaded, except ports, which are made on demand
+  world->opt.compact = true;
+  world->frozen      = true;
+  lilv_mutex_unlock(&world->mutex);
+  return world;
+}
+
+/** Bundle URIs found in the search path, in discovery order. */
+typedef struct {
+  LilvWorld* world;
+  LilvNode** uris;
+  size_t     n_uris;
+} FoundBundles;
+
+static void
+add_found_bundle(const char* dir, const char* name, void* data)
+{
+  FoundBundles* const found = (FoundBundles*)data;
+  char* const         path  = lilv_strjoin(dir, "/", name, "/", NULL);
+  SerdNode suri = serd_node_new_file_uri((const uint8_t*)path, 0, 0, true);
+
+  found->uris = (LilvNode**)realloc(found->uris,
+                                    (found->n_uris + 1U) * sizeof(LilvNode*));
+
+  found->uris[found->n_uris++] =
+    lilv_new_uri(found->world, (const char*)suri.buf);
+
+  serd_node_free(&suri);
+  free(path);
+}
+
+static void
+find_directory_bundles(const char* dir_path, void* data)
+{
+  char* const path = lilv_expand(dir_path);
+  if (path) {
+    zix_dir_for_each(path, data, add_found_bundle);
+    free(path);
+  }
+}
+
+/** Add `uri` to `*nodes` if the caller asked for it, creating it if needed. */
+static void
+report_bundle(LilvNodes** nodes, const LilvNode* uri)
+{
+  if (nodes) {
+    if (!*nodes) {
+      *nodes = lilv_nodes_new();
     }
+
+    lilv_collection_insert(*nodes, lilv_node_duplicate(uri));
   }
+}
 
-  // Query out things to cache
-  lilv_world_load_specifications(world);
-  lilv_world_load_plugin_classes(world);
+int
+lilv_world_rescan(LilvWorld*  world,
+                  LilvNodes** added,
+                  LilvNodes** removed,
+                  LilvNodes** changed)
+{
+  LilvNodes** const outputs[] = {added, removed, changed};
+  for (size_t i = 0U; i < sizeof(outputs) / sizeof(outputs[0]); ++i) {
+    if (outputs[i]) {
+      *outputs[i] = NULL;
+    }
+  }
+
+  lilv_world_lock(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to rescan a frozen world\n");
+    lilv_world_unlock(world);
+    return 0;
+  }
+
+  // Find every bundle that is currently in the search path
+  FoundBundles found = {world, NULL, 0U};
+  lilv_for_each_path_dir(
+    lilv_world_get_lv2_path(world), &found, find_directory_bundles);
+
+  // Find loaded bundles that have since been removed or modified
+  LilvNodes* const gone      = lilv_nodes_new();
+  LilvNodes* const modified  = lilv_nodes_new();
+  LilvNodes* const displaced = lilv_nodes_new();
+  for (size_t i = 0U; i < world->bundles->size; ++i) {
+    const LilvBundle* const bundle =
+      (const LilvBundle*)world->bundles->elems[i];
+    if (lilv_bundle_is_removed(bundle)) {
+      lilv_collection_insert(gone, lilv_node_duplicate(bundle->uri));
+    } else if (lilv_bundle_is_modified(bundle)) {
+      lilv_collection_insert(modified, lilv_node_duplicate(bundle->uri));
+    } else if (bundle->displaced) {
+      lilv_collection_insert(displaced, lilv_node_duplicate(bundle->uri));
+    }
+  }
+
+  int n_changes = 0;
+
+  LILV_FOREACH (nodes, i, gone) {
+    const LilvNode* const uri = lilv_nodes_get(gone, i);
+    lilv_world_unload_bundle(world, uri);
+    report_bundle(removed, uri);
+    ++n_changes;
+  }
+
+  LILV_FOREACH (nodes, i, modified) {
+    const LilvNode* const uri = lilv_nodes_get(modified, i);
+    lilv_world_unload_bundle(world, uri);
+    lilv_world_load_bundle(world, uri);
+    report_bundle(changed, uri);
+    ++n_changes;
+  }
+
+  // Load new bundles in the same order as lilv_world_load_all()
+  for (size_t i = 0U; i < found.n_uris; ++i) {
+    LilvNode* const uri = found.uris[i];
+    if (!lilv_collection_find_by_uri(world->bundles, uri)) {
+      lilv_world_load_bundle(world, uri);
+      report_bundle(added, uri);
+      ++n_changes;
+    }
+    lilv_node_free(uri);
+  }
+
+  // Give displaced bundles another chance if the bundles that won changed
+  if (n_changes) {
+    LILV_FOREACH (nodes, i, displaced) {
+      const LilvNode* const uri = lilv_nodes_get(displaced, i);
+      lilv_world_load_bundle(world, uri);
+
+      const LilvBundle* const bundle = (const LilvBundle*)
+        lilv_collection_get_by_uri(world->bundles, uri);
+      if (bundle && !bundle->displaced) {
+        report_bundle(changed, uri);
+        ++n_changes;
+      }
+    }
+  }
+
+  free(found.uris);
+  lilv_nodes_free(displaced);
+  lilv_nodes_free(modified);
+  lilv_nodes_free(gone);
+
+  if (n_changes) {
+    lilv_world_update_replaced(world);
+    lilv_world_load_specs_and_classes(world);
+
+    if (world->cache) {
+      lilv_cache_save(world->cache, false);
+    }
+  }
+
+  lilv_world_unlock(world);
+  return n_changes;
 }
 
 SerdStatus
 lilv_world_load_file(LilvWorld* world, SerdReader* reader, const LilvNode* uri)
 {
-  ZixTreeIter* iter = NULL;
-  if (!zix_tree_find((ZixTree*)world->loaded_files, uri, &iter)) {
+  if (lilv_collection_find(world->loaded_files, uri)) {
     return SERD_FAILURE; // File has already been loaded
   }
 
@@ -1102,14 +2432,14 @@ lilv_world_load_file(LilvWorld* world, SerdReader* reader, const LilvNode* uri)
   }
 
   serd_reader_add_blank_prefix(reader, lilv_world_blank_node_prefix(world));
-  const SerdStatus st = serd_reader_read_file(reader, uri_str);
+  const SerdStatus st = lilv_reader_read_file(reader, uri_str);
+  ++world->epoch;
   if (st) {
     LILV_ERRORF("Error loading file `%s'\n", lilv_node_as_string(uri));
     return st;
   }
 
-  zix_tree_insert(
-    (ZixTree*)world->loaded_files, lilv_node_duplicate(uri), NULL);
+  lilv_world_add_loaded_file(world, uri);
   return SERD_SUCCESS;
 }
 
@@ -1122,6 +2452,13 @@ lilv_world_load_resource(LilvWorld* world, const LilvNode* resource)
     return -1;
   }
 
+  lilv_world_lock(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to load a resource into a frozen world\n");
+    lilv_world_unlock(world);
+    return -1;
+  }
+
   SordModel* files = lilv_world_filter_model(
     world, world->model, resource->node, world->uris.rdfs_seeAlso, NULL, NULL);
 
@@ -1141,6 +2478,7 @@ lilv_world_load_resource(LilvWorld* world, const LilvNode* resource)
   sord_iter_free(f);
 
   sord_free(files);
+  lilv_world_unlock(world);
   return n_read;
 }
 
@@ -1153,29 +2491,47 @@ lilv_world_unload_resource(LilvWorld* world, const LilvNode* resource)
     return -1;
   }
 
-  SordModel* files = lilv_world_filter_model(
-    world, world->model, resource->node, world->uris.rdfs_seeAlso, NULL, NULL);
+  lilv_world_lock(world);
+  if (world->frozen) {
+    LILV_ERROR("Attempt to unload a resource from a frozen world\n");
+    lilv_world_unlock(world);
+    return -1;
+  }
 
-  SordIter* f         = sord_begin(files);
-  int       n_dropped = 0;
-  FOREACH_MATCH (f) {
-    const SordNode* file      = sord_iter_get_node(f, SORD_OBJECT);
-    LilvNode*       file_node = lilv_node_new_from_node(world, file);
-    if (sord_node_get_type(file) != SORD_URI) {
+  // Copy the file list, since dropping graphs may erase the links to them
+  LilvNodes* const files = lilv_world_find_nodes_internal(
+    world, resource->node, world->uris.rdfs_seeAlso, NULL);
+
+  int n_dropped = 0;
+  LILV_FOREACH (nodes, f, files) {
+    const LilvNode* const file_node = lilv_nodes_get(files, f);
+    if (!lilv_node_is_uri(file_node)) {
       LILV_ERRORF("rdfs:seeAlso node `%s' is not a URI\n",
-                  sord_node_get_string(file));
+                  sord_node_get_string(file_node->node));
     } else if (!lilv_world_drop_graph(world, file_node->node)) {
       lilv_world_unload_file(world, file_node);
       ++n_dropped;
     }
-    lilv_node_free(file_node);
   }
-  sord_iter_free(f);
 
-  sord_free(files);
+  lilv_nodes_free(files);
+  lilv_world_unlock(world);
   return n_dropped;
 }
 
+const LilvNode*
+lilv_world_get_replacement(const LilvWorld* world, const LilvNode* plugin_uri)
+{
+  lilv_world_lock(world);
+
+  const LilvReplacement* const replacement =
+    (const LilvReplacement*)lilv_collection_get_by_uri(world->replacements,
+                                                       plugin_uri);
+
+  lilv_world_unlock(world);
+  return replacement ? replacement->replacement : NULL;
+}
+
 const LilvPluginClass*
 lilv_world_get_plugin_class(const LilvWorld* world)
 {
@@ -1185,27 +2541,35 @@ lilv_world_get_plugin_class(const LilvWorld* world)
 const LilvPluginClasses*
 lilv_world_get_plugin_classes(const LilvWorld* world)
 {
+  lilv_world_lock(world);
+  lilv_world_load_classes_if_necessary((LilvWorld*)world);
+  lilv_world_unlock(world);
   return world->plugin_classes;
 }
 
 const LilvPlugins*
 lilv_world_get_all_plugins(const LilvWorld* world)
 {
-  return world->plugins;
+  lilv_world_lock(world);
+  const LilvPlugins* const plugins = world->plugins;
+  lilv_world_unlock(world);
+  return plugins;
 }
 
 LilvNode*
 lilv_world_get_symbol(LilvWorld* world, const LilvNode* subject)
 {
   // Check for explicitly given symbol
-  SordNode* snode =
-    sord_get(world->model, subject->node, world->uris.lv2_symbol, NULL, NULL);
+  lilv_world_lock(world);
+  const SordNode* snode = lilv_world_get_internal(
+    world, subject->node, world->uris.lv2_symbol, NULL);
 
   if (snode) {
     LilvNode* ret = lilv_node_new_from_node(world, snode);
-    sord_node_free(world->world, snode);
+    lilv_world_unlock(world);
     return ret;
   }
+  lilv_world_unlock(world);
 
   if (!lilv_node_is_uri(subject)) {
     return NULL;
@@ -1,6 +1,8 @@
 // Copyright 2020 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#undef NDEBUG
+
 #include "lilv_test_utils.h"
 
 #include "lilv/lilv.h"
@@ -9,6 +11,7 @@
 #include "zix/filesystem.h"
 #include "zix/path.h"
 
+#include <assert.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -162,6 +165,52 @@ delete_bundle(LilvTestEnv* env)
   env->test_bundle_path   = NULL;
 }
 
+void
+write_file(const char* dir, const char* name, const char* content)
+{
+  char* const path = zix_path_join(NULL, dir, name);
+  FILE* const file = fopen(path, "w");
+  assert(file);
+  fprintf(file, "%s", content);
+  fclose(file);
+  zix_free(NULL, path);
+}
+
+void
+write_bundle_file(const char* lv2_dir,
+                  const char* bundle_name,
+                  const char* file_name,
+                  const char* content)
+{
+  char* const dir = zix_path_join(NULL, lv2_dir, bundle_name);
+
+  zix_create_directories(NULL, dir);
+  write_file(dir, file_name, content);
+
+  zix_free(NULL, dir);
+}
+
+static void
+remove_bundle_file(const char* path, const char* name, void* data)
+{
+  (void)data;
+
+  char* const file_path = zix_path_join(NULL, path, name);
+  assert(!zix_remove(file_path));
+  zix_free(NULL, file_path);
+}
+
+void
+remove_bundle_dir(const char* lv2_dir, const char* bundle_name)
+{
+  char* const dir = zix_path_join(NULL, lv2_dir, bundle_name);
+
+  zix_dir_for_each(dir, NULL, remove_bundle_file);
+  assert(!zix_remove(dir));
+
+  zix_free(NULL, dir);
+}
+
 void
 set_env(const char* name, const char* value)
 {
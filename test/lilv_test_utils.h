@@ -75,6 +75,21 @@ start_bundle(LilvTestEnv* env,
 void
 delete_bundle(LilvTestEnv* env);
 
+// Write a file with the given content into a directory
+void
+write_file(const char* dir, const char* name, const char* content);
+
+// Write a file into a bundle directory in `lv2_dir`, creating it if necessary
+void
+write_bundle_file(const char* lv2_dir,
+                  const char* bundle_name,
+                  const char* file_name,
+                  const char* content);
+
+// Remove a bundle directory in `lv2_dir` and every file in it
+void
+remove_bundle_dir(const char* lv2_dir, const char* bundle_name);
+
 // Set an environment variable so it is immediately visible in this process
 void
 set_env(const char* name, const char* value);
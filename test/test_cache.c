@@ -0,0 +1,180 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/allocator.h"
+#include "zix/filesystem.h"
+#include "zix/path.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NS_RDFS "http://www.w3.org/2000/01/rdf-schema#"
+
+static LilvWorld*
+new_cached_world(const char* cache_path)
+{
+  LilvWorld* const world = lilv_world_new();
+  LilvNode* const  value = lilv_new_string(world, cache_path);
+
+  lilv_world_set_option(world, LILV_OPTION_CACHE_PATH, value);
+  lilv_node_free(value);
+  return world;
+}
+
+static void
+load_bundle(LilvWorld* world, const LilvNode* bundle_uri)
+{
+  LilvNode* const uri = lilv_new_uri(world, lilv_node_as_uri(bundle_uri));
+
+  lilv_world_load_bundle(world, uri);
+  lilv_node_free(uri);
+}
+
+static void
+unload_bundle(LilvWorld* world, const LilvNode* bundle_uri)
+{
+  LilvNode* const uri = lilv_new_uri(world, lilv_node_as_uri(bundle_uri));
+
+  lilv_world_unload_bundle(world, uri);
+  lilv_node_free(uri);
+}
+
+static void
+check_plugin(LilvWorld* world, const char* label_str)
+{
+  LilvNode* plug_uri = lilv_new_uri(world, "http://example.org/plug");
+  LilvNode* comment  = lilv_new_uri(world, NS_RDFS "comment");
+  LilvNode* label    = lilv_new_uri(world, NS_RDFS "label");
+
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  plug    = lilv_plugins_get_by_uri(plugins, plug_uri);
+  assert(plug);
+
+  // Check that plugin data is loaded from the bundle as usual
+  LilvNode* name = lilv_plugin_get_name(plug);
+  assert(!strcmp(lilv_node_as_string(name), "Cached"));
+  lilv_node_free(name);
+
+  // Check that blank nodes and their properties are restored
+  LilvNode* blank = lilv_world_get(world, plug_uri, comment, NULL);
+  assert(blank);
+  assert(lilv_node_is_blank(blank));
+
+  LilvNode* value = lilv_world_get(world, blank, label, NULL);
+  assert(value);
+  assert(!strcmp(lilv_node_as_string(value), label_str));
+
+  lilv_node_free(value);
+  lilv_node_free(blank);
+  lilv_node_free(label);
+  lilv_node_free(comment);
+  lilv_node_free(plug_uri);
+}
+
+int
+main(void)
+{
+  LilvTestEnv* const env = lilv_test_env_new();
+
+  char* const temp_dir   = lilv_create_temporary_directory("lilv_XXXXXX");
+  char* const cache_path = zix_path_join(NULL, temp_dir, "cache");
+
+  create_bundle(env,
+                "cache.lv2",
+                ":plug a lv2:Plugin ; lv2:binary <foo" SHLIB_EXT "> ; "
+                "rdfs:seeAlso <plugin.ttl> ; "
+                "rdfs:comment [ rdfs:label \"first\" ] .\n",
+                ":plug a lv2:Plugin ; doap:name \"Cached\" .");
+
+  // Parse bundle and write cache
+  LilvWorld* world = new_cached_world(cache_path);
+  load_bundle(world, env->test_bundle_uri);
+  check_plugin(world, "first");
+  lilv_world_free(world);
+  assert(zix_file_type(cache_path) == ZIX_FILE_TYPE_REGULAR);
+
+  // Load bundle in a new world, from the cache
+  world = new_cached_world(cache_path);
+  load_bundle(world, env->test_bundle_uri);
+  check_plugin(world, "first");
+
+  // Unload and reload bundle, from the cache again
+  unload_bundle(world, env->test_bundle_uri);
+  load_bundle(world, env->test_bundle_uri);
+  check_plugin(world, "first");
+
+  // Change manifest so the cache entry is stale and the manifest is parsed
+  unload_bundle(world, env->test_bundle_uri);
+  FILE* const manifest = fopen(env->test_manifest_path, "w");
+  assert(manifest);
+  fprintf(manifest,
+          "%s:plug a lv2:Plugin ; lv2:binary <foo" SHLIB_EXT "> ; "
+          "rdfs:seeAlso <plugin.ttl> ; "
+          "rdfs:comment [ rdfs:label \"second\" ] .\n",
+          MANIFEST_PREFIXES);
+  fclose(manifest);
+
+  load_bundle(world, env->test_bundle_uri);
+  check_plugin(world, "second");
+  lilv_world_free(world);
+
+  // Load updated entry from the cache
+  world = new_cached_world(cache_path);
+  load_bundle(world, env->test_bundle_uri);
+  check_plugin(world, "second");
+  lilv_world_free(world);
+
+  // Loading everything drops entries for bundles that were not found
+  FILE* cache_file = fopen(cache_path, "rb");
+  assert(cache_file);
+  fseek(cache_file, 0, SEEK_END);
+  const long full_size = ftell(cache_file);
+  fclose(cache_file);
+
+  world = new_cached_world(cache_path);
+
+  char* const     lv2_dir  = zix_path_join(NULL, temp_dir, "lv2");
+  LilvNode* const lv2_path = lilv_new_string(world, lv2_dir);
+  lilv_world_set_option(world, LILV_OPTION_LV2_PATH, lv2_path);
+  lilv_world_load_all(world);
+  lilv_node_free(lv2_path);
+  lilv_world_free(world);
+  zix_free(NULL, lv2_dir);
+
+  cache_file = fopen(cache_path, "rb");
+  assert(cache_file);
+  fseek(cache_file, 0, SEEK_END);
+  assert(ftell(cache_file) < full_size);
+  fclose(cache_file);
+
+  // Invalid cache files are ignored and replaced
+  cache_file = fopen(cache_path, "wb");
+  assert(cache_file);
+  fprintf(cache_file, "LILVCACHjunk");
+  fclose(cache_file);
+
+  world = new_cached_world(cache_path);
+  load_bundle(world, env->test_bundle_uri);
+  check_plugin(world, "second");
+  lilv_world_free(world);
+
+  world = new_cached_world(cache_path);
+  load_bundle(world, env->test_bundle_uri);
+  check_plugin(world, "second");
+  lilv_world_free(world);
+
+  delete_bundle(env);
+  assert(!zix_remove(cache_path));
+  assert(!zix_remove(temp_dir));
+
+  zix_free(NULL, cache_path);
+  zix_free(NULL, temp_dir);
+  lilv_test_env_free(env);
+  return 0;
+}
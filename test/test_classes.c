@@ -55,6 +55,48 @@ main(void)
       lilv_plugin_class_get_uri(plugin)));
   }
 
+  // Descendants include children and their subclasses, like CompressorPlugin
+  LilvPluginClasses* descendants = lilv_plugin_class_get_descendants(plugin);
+  LilvNode*          dynamics_uri =
+    lilv_new_uri(world, "http://lv2plug.in/ns/lv2core#DynamicsPlugin");
+  LilvNode* compressor_uri =
+    lilv_new_uri(world, "http://lv2plug.in/ns/lv2core#CompressorPlugin");
+  LilvNode* generator_uri =
+    lilv_new_uri(world, "http://lv2plug.in/ns/lv2core#GeneratorPlugin");
+
+  assert(lilv_plugin_classes_size(descendants) >
+         lilv_plugin_classes_size(children));
+  LILV_FOREACH (plugin_classes, i, children) {
+    assert(lilv_plugin_classes_get_by_uri(
+      descendants,
+      lilv_plugin_class_get_uri(lilv_plugin_classes_get(children, i))));
+  }
+
+  const LilvPluginClass* const dynamics =
+    lilv_plugin_classes_get_by_uri(classes, dynamics_uri);
+  const LilvPluginClass* const generator =
+    lilv_plugin_classes_get_by_uri(classes, generator_uri);
+  assert(dynamics);
+  assert(generator);
+  assert(lilv_plugin_classes_get_by_uri(descendants, compressor_uri));
+  lilv_plugin_classes_free(descendants);
+
+  // Plugins in a class subtree include those in subclasses
+  LilvPlugins* plugins = lilv_plugin_class_get_plugins(dynamics);
+  assert(lilv_plugins_size(plugins) == 1);
+  assert(lilv_node_equals(
+    lilv_plugin_get_uri(lilv_plugins_get(plugins, lilv_plugins_begin(plugins))),
+    env->plugin1_uri));
+  lilv_plugins_free(plugins);
+
+  plugins = lilv_plugin_class_get_plugins(generator);
+  assert(lilv_plugins_size(plugins) == 0);
+  lilv_plugins_free(plugins);
+
+  lilv_node_free(generator_uri);
+  lilv_node_free(compressor_uri);
+  lilv_node_free(dynamics_uri);
+
   LilvNode* some_uri = lilv_new_uri(world, "http://example.org/whatever");
   assert(lilv_plugin_classes_get_by_uri(classes, some_uri) == NULL);
   lilv_node_free(some_uri);
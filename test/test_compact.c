@@ -0,0 +1,249 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_uri_map.h"
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "lv2/urid/urid.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NS_LV2 "http://lv2plug.in/ns/lv2core#"
+#define NS_RDF "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
+
+static const char* const plugin_ttl = "\
+:plug\n\
+	a lv2:Plugin ;\n\
+	doap:name \"Test plugin\" ;\n\
+	lv2:project [\n\
+		doap:name \"Test project\"\n\
+	] ;\n\
+	lv2:port [\n\
+		a lv2:ControlPort , lv2:InputPort ;\n\
+		lv2:index 0 ;\n\
+		lv2:symbol \"gain\" ;\n\
+		lv2:name \"Gain\" ;\n\
+		lv2:minimum 0.0 ;\n\
+		lv2:maximum 2.0 ;\n\
+		lv2:default 1.0 ;\n\
+		lv2:scalePoint [\n\
+			rdfs:label \"Off\" ;\n\
+			rdf:value 0.0\n\
+		] , [\n\
+			rdfs:label \"Full\" ;\n\
+			rdf:value 1.0\n\
+		]\n\
+	] , [\n\
+		a lv2:ControlPort , lv2:OutputPort ;\n\
+		lv2:index 1 ;\n\
+		lv2:symbol \"latency\" ;\n\
+		lv2:name \"Latency\" ;\n\
+		lv2:designation lv2:latency\n\
+	] .\n\
+\n\
+<http://example.org/preset>\n\
+	a pset:Preset ;\n\
+	lv2:appliesTo :plug ;\n\
+	rdfs:label \"Quiet\" ;\n\
+	lv2:port [\n\
+		lv2:symbol \"gain\" ;\n\
+		pset:value 0.25\n\
+	] .\n";
+
+typedef struct {
+  unsigned n_rows;
+  char     symbols[64];
+} Results;
+
+static int
+append_symbol(void* handle, const LilvNode* const* row)
+{
+  Results* const results = (Results*)handle;
+  const size_t   len     = strlen(results->symbols);
+  const size_t   size    = sizeof(results->symbols) - len;
+
+  const int n = snprintf(
+    results->symbols + len, size, "%s ", lilv_node_as_string(row[1]));
+
+  assert(n > 0 && (size_t)n < size);
+  ++results->n_rows;
+  return 0;
+}
+
+static int
+count_match(void*           data,
+            const LilvNode* subject,
+            const LilvNode* predicate,
+            const LilvNode* object)
+{
+  (void)subject;
+  (void)predicate;
+  (void)object;
+
+  ++*(unsigned*)data;
+  return 0;
+}
+
+static void
+check_port_value(const char* port_symbol,
+                 void*       user_data,
+                 const void* value,
+                 uint32_t    size,
+                 uint32_t    type)
+{
+  (void)value;
+  (void)size;
+  (void)type;
+
+  assert(!strcmp(port_symbol, "gain"));
+  ++*(unsigned*)user_data;
+}
+
+static LilvQueryTerm
+node_term(const LilvNode* const value)
+{
+  const LilvQueryTerm term = {value, 0U};
+  return term;
+}
+
+static LilvQueryTerm
+var_term(const uint32_t index)
+{
+  const LilvQueryTerm term = {NULL, index};
+  return term;
+}
+
+int
+main(void)
+{
+  LilvTestEnv* const env   = lilv_test_env_new();
+  LilvWorld* const   world = env->world;
+
+  if (create_bundle(env, "compact.lv2", SIMPLE_MANIFEST_TTL, plugin_ttl)) {
+    return 1;
+  }
+
+  lilv_world_load_specifications(world);
+  lilv_world_load_bundle(world, env->test_bundle_uri);
+
+  LilvNode* const enabled = lilv_new_bool(world, true);
+  lilv_world_set_option(world, LILV_OPTION_COMPACT, enabled);
+  lilv_node_free(enabled);
+
+  // Freezing compacts the world, and everything is still found afterwards
+  lilv_world_freeze(world);
+
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  plugin =
+    lilv_plugins_get_by_uri(plugins, env->plugin1_uri);
+  assert(plugin);
+
+  LilvNode* const name = lilv_plugin_get_name(plugin);
+  assert(!strcmp(lilv_node_as_string(name), "Test plugin"));
+  lilv_node_free(name);
+
+  assert(lilv_plugin_get_num_ports(plugin) == 2U);
+  assert(lilv_plugin_get_latency_port_index(plugin) == 1U);
+
+  LilvNode* const project = lilv_plugin_get_project(plugin);
+  assert(lilv_node_is_blank(project));
+  lilv_node_free(project);
+
+  // Port ranges and scale points
+  float min[2] = {0.0f, 0.0f};
+  float max[2] = {0.0f, 0.0f};
+  float def[2] = {0.0f, 0.0f};
+  lilv_plugin_get_port_ranges_float(plugin, min, max, def);
+  assert(min[0] == 0.0f);
+  assert(max[0] == 2.0f);
+  assert(def[0] == 1.0f);
+
+  const LilvPort* const  gain   = lilv_plugin_get_port_by_index(plugin, 0U);
+  LilvScalePoints* const points = lilv_port_get_scale_points(plugin, gain);
+  assert(lilv_scale_points_size(points) == 2U);
+  lilv_scale_points_free(points);
+
+  // Searching by subject, by object, and for missing nodes
+  LilvNode* const lv2_port   = lilv_new_uri(world, NS_LV2 "port");
+  LilvNode* const lv2_plugin = lilv_new_uri(world, NS_LV2 "Plugin");
+  LilvNode* const lv2_symbol = lilv_new_uri(world, NS_LV2 "symbol");
+  LilvNode* const rdf_type   = lilv_new_uri(world, NS_RDF "type");
+
+  LilvNode* const latency = lilv_new_string(world, "latency");
+  LilvNode* const missing = lilv_new_uri(world, "http://example.org/missing");
+
+  LilvNodes* const ports =
+    lilv_world_find_nodes(world, env->plugin1_uri, lv2_port, NULL);
+  assert(lilv_nodes_size(ports) == 2U);
+  lilv_nodes_free(ports);
+
+  LilvNodes* const all_plugins =
+    lilv_world_find_nodes(world, NULL, rdf_type, lv2_plugin);
+  assert(lilv_nodes_contains(all_plugins, env->plugin1_uri));
+  lilv_nodes_free(all_plugins);
+
+  assert(lilv_world_ask(world, env->plugin1_uri, rdf_type, lv2_plugin));
+  assert(!lilv_world_ask(world, missing, NULL, NULL));
+  assert(!lilv_world_ask(world, env->plugin1_uri, rdf_type, missing));
+
+  LilvNode* const latency_port =
+    lilv_world_get(world, NULL, lv2_symbol, latency);
+  assert(lilv_node_is_blank(latency_port));
+  lilv_node_free(latency_port);
+
+  unsigned n_symbols = 0U;
+  assert(lilv_world_foreach_match(
+           world, NULL, lv2_symbol, NULL, count_match, &n_symbols) == 3U);
+  assert(n_symbols == 3U);
+
+  // Joins
+  Results          results = {0U, {0}};
+  LilvQuery* const query   = lilv_query_new(world);
+  assert(!lilv_query_add_pattern(
+    query, node_term(env->plugin1_uri), node_term(lv2_port), var_term(0)));
+  assert(!lilv_query_add_pattern(
+    query, var_term(0), node_term(lv2_symbol), var_term(1)));
+  assert(lilv_query_run(query, append_symbol, &results) == 2U);
+  assert(!strcmp(results.symbols, "gain latency ") ||
+         !strcmp(results.symbols, "latency gain "));
+  lilv_query_free(query);
+
+  // States described in the world
+  LilvTestUriMap uri_map;
+  lilv_test_uri_map_init(&uri_map);
+
+  LV2_URID_Map    map    = {&uri_map, map_uri};
+  LilvNode* const preset = lilv_new_uri(world, "http://example.org/preset");
+  LilvState*      state  = lilv_state_new_from_world(world, &map, preset);
+  assert(state);
+  assert(!strcmp(lilv_state_get_label(state), "Quiet"));
+  assert(lilv_node_equals(lilv_state_get_plugin_uri(state), env->plugin1_uri));
+
+  unsigned n_values = 0U;
+  lilv_state_emit_port_values(state, check_port_value, &n_values);
+  assert(n_values == 1U);
+
+  lilv_state_free(state);
+  lilv_node_free(preset);
+  lilv_test_uri_map_clear(&uri_map);
+
+  lilv_node_free(latency);
+  lilv_node_free(missing);
+  lilv_node_free(rdf_type);
+  lilv_node_free(lv2_symbol);
+  lilv_node_free(lv2_plugin);
+  lilv_node_free(lv2_port);
+
+  delete_bundle(env);
+  lilv_test_env_free(env);
+
+  return 0;
+}
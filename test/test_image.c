@@ -0,0 +1,191 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/allocator.h"
+#include "zix/filesystem.h"
+#include "zix/path.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NS_EX "http://example.org/"
+#define NS_LV2 "http://lv2plug.in/ns/lv2core#"
+
+static const char* const plugin_ttl = "\
+:plug\n\
+	a lv2:Plugin , lv2:CompressorPlugin ;\n\
+	doap:name \"Test plugin\" , \"Testmodul\"@de ;\n\
+	<http://purl.org/dc/terms/replaces> :old ;\n\
+	lv2:port [\n\
+		a lv2:ControlPort , lv2:InputPort ;\n\
+		lv2:index 0 ;\n\
+		lv2:symbol \"gain\" ;\n\
+		lv2:name \"Gain\" ;\n\
+		lv2:minimum 0.0 ;\n\
+		lv2:maximum 2.0 ;\n\
+		lv2:default 1.0\n\
+	] , [\n\
+		a lv2:ControlPort , lv2:OutputPort ;\n\
+		lv2:index 1 ;\n\
+		lv2:symbol \"latency\" ;\n\
+		lv2:name \"Latency\" ;\n\
+		lv2:designation lv2:latency\n\
+	] .\n";
+
+static void
+check_world(LilvWorld* const world, const char* const bundle_uri)
+{
+  LilvNode* const plug_uri   = lilv_new_uri(world, NS_EX "plug");
+  LilvNode* const lv2_port   = lilv_new_uri(world, NS_LV2 "port");
+  LilvNode* const compressor = lilv_new_uri(world, NS_LV2 "CompressorPlugin");
+  LilvNode* const dynamics   = lilv_new_uri(world, NS_LV2 "DynamicsPlugin");
+
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  plugin  = lilv_plugins_get_by_uri(plugins, plug_uri);
+  assert(plugin);
+
+  // Plugin records
+  assert(!strcmp(lilv_node_as_uri(lilv_plugin_get_bundle_uri(plugin)),
+                 bundle_uri));
+  assert(lilv_nodes_size(lilv_plugin_get_data_uris(plugin)) == 2U);
+
+  // Plugin data
+  set_env("LANG", "C");
+  LilvNode* name = lilv_plugin_get_name(plugin);
+  assert(!strcmp(lilv_node_as_string(name), "Test plugin"));
+  lilv_node_free(name);
+
+  set_env("LANG", "de_DE");
+  name = lilv_plugin_get_name(plugin);
+  assert(!strcmp(lilv_node_as_string(name), "Testmodul"));
+  lilv_node_free(name);
+
+  // Ports
+  assert(lilv_plugin_get_num_ports(plugin) == 2U);
+  assert(lilv_plugin_get_latency_port_index(plugin) == 1U);
+
+  float max[2] = {0.0f, 0.0f};
+  lilv_plugin_get_port_ranges_float(plugin, NULL, max, NULL);
+  assert(max[0] == 2.0f);
+
+  LilvNodes* const ports =
+    lilv_world_find_nodes(world, plug_uri, lv2_port, NULL);
+  assert(lilv_nodes_size(ports) == 2U);
+  lilv_nodes_free(ports);
+
+  // Plugin classes
+  const LilvPluginClass* const pclass = lilv_plugin_get_class(plugin);
+  assert(lilv_node_equals(lilv_plugin_class_get_uri(pclass), compressor));
+  assert(lilv_node_equals(lilv_plugin_class_get_parent_uri(pclass), dynamics));
+
+  LilvPluginClasses* const descendants =
+    lilv_plugin_class_get_descendants(lilv_world_get_plugin_class(world));
+  assert(lilv_plugin_classes_get_by_uri(descendants, compressor));
+  lilv_plugin_classes_free(descendants);
+
+  lilv_node_free(dynamics);
+  lilv_node_free(compressor);
+  lilv_node_free(lv2_port);
+  lilv_node_free(plug_uri);
+}
+
+int
+main(void)
+{
+  LilvTestEnv* const env   = lilv_test_env_new();
+  LilvWorld* const   world = env->world;
+
+  lilv_world_load_all(world);
+
+  if (create_bundle(env, "image.lv2", SIMPLE_MANIFEST_TTL, plugin_ttl)) {
+    return 1;
+  }
+
+  lilv_world_load_specifications(world);
+  lilv_world_load_bundle(world, env->test_bundle_uri);
+
+  char* const temp_dir    = lilv_create_temporary_directory("lilv_XXXXXX");
+  char* const image_path  = zix_path_join(NULL, temp_dir, "world.image");
+  char* const image2_path = zix_path_join(NULL, temp_dir, "world2.image");
+
+  const char* const bundle_uri = lilv_node_as_uri(env->test_bundle_uri);
+
+  // Saving an image leaves the world unfrozen, so it can still be changed
+  assert(!lilv_world_save_image(world, image_path));
+  assert(zix_file_type(image_path) == ZIX_FILE_TYPE_REGULAR);
+  check_world(world, bundle_uri);
+
+  LilvNode* const world_plug_uri = lilv_new_uri(world, NS_EX "plug");
+  assert(lilv_world_load_resource(world, world_plug_uri) >= 0);
+  lilv_node_free(world_plug_uri);
+  check_world(world, bundle_uri);
+
+  // A world made from the image has the same plugins, classes, and data
+  LilvWorld* image_world = lilv_world_new_from_image(image_path);
+  assert(image_world);
+  check_world(image_world, bundle_uri);
+
+  // Replacements are found in plugin data, which is all in the image
+  LilvNode* const plug_uri = lilv_new_uri(image_world, NS_EX "plug");
+  LilvNode* const old_uri  = lilv_new_uri(image_world, NS_EX "old");
+  assert(lilv_node_equals(lilv_world_get_replacement(image_world, old_uri),
+                          plug_uri));
+
+  // Nothing can be loaded into it
+  assert(lilv_world_load_resource(image_world, plug_uri) == -1);
+  lilv_node_free(old_uri);
+  lilv_node_free(plug_uri);
+
+  // Saving a world made from an image makes an equivalent image
+  assert(!lilv_world_save_image(image_world, image2_path));
+  lilv_world_free(image_world);
+
+  image_world = lilv_world_new_from_image(image2_path);
+  assert(image_world);
+  check_world(image_world, bundle_uri);
+  lilv_world_free(image_world);
+
+  // Missing, truncated, and invalid images are rejected
+  char* const missing_path = zix_path_join(NULL, temp_dir, "missing.image");
+  assert(!lilv_world_new_from_image(missing_path));
+  zix_free(NULL, missing_path);
+
+  FILE* image_file = fopen(image2_path, "rb");
+  assert(image_file);
+  fseek(image_file, 0, SEEK_END);
+  const size_t image_size = (size_t)ftell(image_file);
+  fseek(image_file, 0, SEEK_SET);
+
+  char* const image = (char*)malloc(image_size);
+  assert(fread(image, 1, image_size, image_file) == image_size);
+  fclose(image_file);
+
+  image_file = fopen(image2_path, "wb");
+  assert(fwrite(image, 1, image_size - 1U, image_file) == image_size - 1U);
+  fclose(image_file);
+  free(image);
+  assert(!lilv_world_new_from_image(image2_path));
+
+  image_file = fopen(image2_path, "wb");
+  fprintf(image_file, "LILVIMAGjunk");
+  fclose(image_file);
+  assert(!lilv_world_new_from_image(image2_path));
+
+  delete_bundle(env);
+  assert(!zix_remove(image2_path));
+  assert(!zix_remove(image_path));
+  assert(!zix_remove(temp_dir));
+
+  zix_free(NULL, image2_path);
+  zix_free(NULL, image_path);
+  zix_free(NULL, temp_dir);
+  lilv_test_env_free(env);
+  return 0;
+}
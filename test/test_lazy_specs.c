@@ -0,0 +1,151 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/allocator.h"
+#include "zix/filesystem.h"
+#include "zix/path.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define NS_EX "http://example.org/"
+#define NS_RDFS "http://www.w3.org/2000/01/rdf-schema#"
+
+static const char* const spec_manifest =
+  MANIFEST_PREFIXES "<http://example.org/spec>\n"
+                    "  a lv2:Specification ;\n"
+                    "  rdfs:seeAlso <spec.ttl> .\n";
+
+static const char* const spec_data =
+  MANIFEST_PREFIXES "<http://example.org/spec#Thing>\n"
+                    "  rdfs:label \"Thing\" .\n"
+                    "<http://example.org/spec#FooPlugin>\n"
+                    "  a rdfs:Class ;\n"
+                    "  rdfs:subClassOf lv2:Plugin ;\n"
+                    "  rdfs:label \"Foo\" .\n";
+
+static const char* const plug_manifest =
+  MANIFEST_PREFIXES "<http://example.org/plug>\n"
+                    "  a lv2:Plugin ;\n"
+                    "  lv2:binary <plug" SHLIB_EXT "> ;\n"
+                    "  rdfs:seeAlso <plug.ttl> .\n";
+
+static const char* const plug_data =
+  PLUGIN_PREFIXES "<http://example.org/plug>\n"
+                  "  a lv2:Plugin , <http://example.org/spec#FooPlugin> ;\n"
+                  "  doap:name \"Plugin\" .\n";
+
+static LilvWorld*
+load_world(const char* lv2_dir, const bool lazy)
+{
+  LilvWorld* const world      = lilv_world_new();
+  LilvNode* const  lv2_path   = lilv_new_string(world, lv2_dir);
+  LilvNode* const  lazy_specs = lilv_new_bool(world, lazy);
+
+  lilv_world_set_option(world, LILV_OPTION_LV2_PATH, lv2_path);
+  lilv_world_set_option(world, LILV_OPTION_LAZY_SPECS, lazy_specs);
+  lilv_world_load_all(world);
+
+  lilv_node_free(lazy_specs);
+  lilv_node_free(lv2_path);
+  return world;
+}
+
+static void
+check_world(const char* lv2_dir, const bool lazy)
+{
+  LilvWorld* const world = load_world(lv2_dir, lazy);
+
+  LilvNode* const label     = lilv_new_uri(world, NS_RDFS "label");
+  LilvNode* const foo       = lilv_new_uri(world, NS_EX "spec#FooPlugin");
+  LilvNode* const plug_uri  = lilv_new_uri(world, NS_EX "plug");
+  LilvNode* const thing_str = lilv_new_string(world, "Thing");
+
+  // Searching for a literal doesn't load any specifications
+  LilvNodes* things = lilv_world_find_nodes(world, NULL, label, thing_str);
+  assert(lilv_nodes_size(things) == (lazy ? 0U : 1U));
+  lilv_nodes_free(things);
+
+  // Plugins are discovered as usual
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  plug = lilv_plugins_get_by_uri(plugins, plug_uri);
+  assert(plug);
+
+  // Getting the class of a plugin loads the specification that defines it
+  const LilvPluginClass* const pclass = lilv_plugin_get_class(plug);
+  assert(lilv_node_equals(lilv_plugin_class_get_uri(pclass), foo));
+  assert(!strcmp(lilv_node_as_string(lilv_plugin_class_get_label(pclass)),
+                 "Foo"));
+
+  // So the specification data is now loaded
+  things = lilv_world_find_nodes(world, NULL, label, thing_str);
+  assert(lilv_nodes_size(things) == 1U);
+  lilv_nodes_free(things);
+
+  // Plugin classes are complete, with no duplicates
+  const LilvPluginClasses* const classes = lilv_world_get_plugin_classes(world);
+  assert(lilv_plugin_classes_get_by_uri(classes, foo) == pclass);
+
+  unsigned n_foo = 0U;
+  LILV_FOREACH (plugin_classes, i, classes) {
+    const LilvPluginClass* c = lilv_plugin_classes_get(classes, i);
+    n_foo += lilv_node_equals(lilv_plugin_class_get_uri(c), foo) ? 1U : 0U;
+  }
+  assert(n_foo == 1U);
+
+  lilv_node_free(thing_str);
+  lilv_node_free(plug_uri);
+  lilv_node_free(foo);
+  lilv_node_free(label);
+  lilv_world_free(world);
+}
+
+static void
+check_query(const char* lv2_dir)
+{
+  LilvWorld* const world = load_world(lv2_dir, true);
+
+  LilvNode* const label = lilv_new_uri(world, NS_RDFS "label");
+  LilvNode* const thing = lilv_new_uri(world, NS_EX "spec#Thing");
+
+  // Querying a resource within a specification loads it
+  LilvNode* const value = lilv_world_get(world, thing, label, NULL);
+  assert(value);
+  assert(!strcmp(lilv_node_as_string(value), "Thing"));
+  assert(lilv_world_ask(world, thing, label, value));
+
+  lilv_node_free(value);
+  lilv_node_free(thing);
+  lilv_node_free(label);
+  lilv_world_free(world);
+}
+
+int
+main(void)
+{
+  char* const temp_dir = lilv_create_temporary_directory("lilv_XXXXXX");
+  char* const lv2_dir  = zix_path_join(NULL, temp_dir, "lv2");
+
+  write_bundle_file(lv2_dir, "spec.lv2", "manifest.ttl", spec_manifest);
+  write_bundle_file(lv2_dir, "spec.lv2", "spec.ttl", spec_data);
+  write_bundle_file(lv2_dir, "plug.lv2", "manifest.ttl", plug_manifest);
+  write_bundle_file(lv2_dir, "plug.lv2", "plug.ttl", plug_data);
+
+  check_world(lv2_dir, false);
+  check_world(lv2_dir, true);
+  check_query(lv2_dir);
+
+  remove_bundle_dir(lv2_dir, "plug.lv2");
+  remove_bundle_dir(lv2_dir, "spec.lv2");
+  assert(!zix_remove(lv2_dir));
+  assert(!zix_remove(temp_dir));
+  zix_free(NULL, lv2_dir);
+  zix_free(NULL, temp_dir);
+  return 0;
+}
@@ -0,0 +1,159 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/allocator.h"
+#include "zix/filesystem.h"
+#include "zix/path.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define N_BUNDLES 16U
+
+static void
+create_bundles(const char* lv2_dir)
+{
+  char name[32];
+  char text[512];
+
+  for (unsigned i = 0U; i < N_BUNDLES; ++i) {
+    snprintf(name, sizeof(name), "b%02u.lv2", i);
+
+    if (i == 3U) {
+      write_bundle_file(lv2_dir, name, "manifest.ttl", "This is not Turtle\n");
+    } else if (i == 5U) {
+      char* const bundle_dir = zix_path_join(NULL, lv2_dir, name);
+      assert(!zix_create_directories(NULL, bundle_dir));
+      zix_free(NULL, bundle_dir);
+    } else {
+      // Bundles 7 and 8 contain the same plugin, so the first one is used
+      const unsigned plug = (i == 8U) ? 7U : i;
+
+      snprintf(text,
+               sizeof(text),
+               "%s<http://example.org/plug%u> a lv2:Plugin ;\n"
+               "  lv2:binary <plug" SHLIB_EXT "> ;\n"
+               "  rdfs:seeAlso <plug.ttl> ;\n"
+               "  rdfs:comment [ rdfs:label \"bundle %u\" ] .\n",
+               MANIFEST_PREFIXES,
+               plug,
+               i);
+      write_bundle_file(lv2_dir, name, "manifest.ttl", text);
+
+      snprintf(text,
+               sizeof(text),
+               "%s<http://example.org/plug%u> a lv2:Plugin ;\n"
+               "  doap:name \"Plugin %u\" .\n",
+               PLUGIN_PREFIXES,
+               plug,
+               plug);
+      write_bundle_file(lv2_dir, name, "plug.ttl", text);
+    }
+  }
+}
+
+static void
+remove_bundles(const char* lv2_dir)
+{
+  char name[32];
+  for (unsigned i = 0U; i < N_BUNDLES; ++i) {
+    snprintf(name, sizeof(name), "b%02u.lv2", i);
+    remove_bundle_dir(lv2_dir, name);
+  }
+}
+
+static LilvWorld*
+load_world(const char* lv2_dir, const int n_threads)
+{
+  LilvWorld* const world    = lilv_world_new();
+  LilvNode* const  lv2_path = lilv_new_string(world, lv2_dir);
+  LilvNode* const  threads  = lilv_new_int(world, n_threads);
+
+  lilv_world_set_option(world, LILV_OPTION_LV2_PATH, lv2_path);
+  lilv_world_set_option(world, LILV_OPTION_DISCOVERY_THREADS, threads);
+  lilv_world_load_all(world);
+
+  lilv_node_free(threads);
+  lilv_node_free(lv2_path);
+  return world;
+}
+
+static void
+check_same(LilvWorld* serial, LilvWorld* parallel)
+{
+  const LilvPlugins* const serial_plugins = lilv_world_get_all_plugins(serial);
+  const LilvPlugins* const parallel_plugins =
+    lilv_world_get_all_plugins(parallel);
+
+  assert(lilv_plugins_size(serial_plugins) == N_BUNDLES - 3U);
+  assert(lilv_plugins_size(parallel_plugins) ==
+         lilv_plugins_size(serial_plugins));
+
+  LilvNode* const comment =
+    lilv_new_uri(parallel, "http://www.w3.org/2000/01/rdf-schema#comment");
+  LilvNode* const label =
+    lilv_new_uri(parallel, "http://www.w3.org/2000/01/rdf-schema#label");
+
+  LILV_FOREACH (plugins, i, serial_plugins) {
+    const LilvPlugin* const s = lilv_plugins_get(serial_plugins, i);
+    LilvNode* const         uri =
+      lilv_new_uri(parallel, lilv_node_as_uri(lilv_plugin_get_uri(s)));
+
+    const LilvPlugin* const p = lilv_plugins_get_by_uri(parallel_plugins, uri);
+    assert(p);
+    assert(!strcmp(lilv_node_as_uri(lilv_plugin_get_bundle_uri(s)),
+                   lilv_node_as_uri(lilv_plugin_get_bundle_uri(p))));
+
+    LilvNode* const s_name = lilv_plugin_get_name(s);
+    LilvNode* const p_name = lilv_plugin_get_name(p);
+    assert(!strcmp(lilv_node_as_string(s_name), lilv_node_as_string(p_name)));
+
+    LilvNode* const blank = lilv_world_get(parallel, uri, comment, NULL);
+    assert(lilv_node_is_blank(blank));
+
+    LilvNode* const value = lilv_world_get(parallel, blank, label, NULL);
+    assert(!strncmp(lilv_node_as_string(value), "bundle ", 7));
+
+    lilv_node_free(value);
+    lilv_node_free(blank);
+    lilv_node_free(p_name);
+    lilv_node_free(s_name);
+    lilv_node_free(uri);
+  }
+
+  lilv_node_free(label);
+  lilv_node_free(comment);
+}
+
+int
+main(void)
+{
+  char* const temp_dir = lilv_create_temporary_directory("lilv_XXXXXX");
+  char* const lv2_dir  = zix_path_join(NULL, temp_dir, "lv2");
+
+  assert(!zix_create_directories(NULL, lv2_dir));
+  create_bundles(lv2_dir);
+
+  LilvWorld* const serial = load_world(lv2_dir, 1);
+
+  for (int n_threads = 2; n_threads <= 32; n_threads *= 4) {
+    LilvWorld* const parallel = load_world(lv2_dir, n_threads);
+    check_same(serial, parallel);
+    lilv_world_free(parallel);
+  }
+
+  lilv_world_free(serial);
+
+  remove_bundles(lv2_dir);
+  assert(!zix_remove(lv2_dir));
+  assert(!zix_remove(temp_dir));
+  zix_free(NULL, lv2_dir);
+  zix_free(NULL, temp_dir);
+  return 0;
+}
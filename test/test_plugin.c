@@ -50,7 +50,8 @@ static const char* const plugin_ttl = "\
 		lv2:name \"Baz\" ;\n\
 		lv2:minimum -2.0 ;\n\
 		lv2:maximum 2.0 ;\n\
-		lv2:default 1.0\n\
+		lv2:default 1.0 ;\n\
+		lv2:designation lv2:enabled\n\
 	] , [\n\
 		a lv2:ControlPort ;\n\
 		a lv2:OutputPort ;\n\
@@ -168,6 +169,19 @@ main(void)
   assert(lilv_port_get_index(plug, latency_port) == 2);
   assert(lilv_node_is_blank(lilv_port_get_node(plug, latency_port)));
 
+  uint32_t                        n_designated = 0U;
+  const LilvDesignatedPort* const designated =
+    lilv_plugin_get_designated_ports(plug, &n_designated);
+  assert(n_designated == 2U);
+  assert(lilv_port_get_index(plug, designated[0].port) == 1);
+  assert(!strcmp(lilv_node_as_uri(designated[0].designation),
+                 "http://lv2plug.in/ns/lv2core#enabled"));
+  assert(designated[1].port == latency_port);
+  assert(lilv_plugin_get_port_by_designation(
+           plug, NULL, designated[0].designation) == designated[0].port);
+  assert(!lilv_plugin_get_port_by_designation(
+    plug, out_class, designated[0].designation));
+
   LilvNode* rt_feature =
     lilv_new_uri(world, "http://lv2plug.in/ns/lv2core#hardRTCapable");
   LilvNode* event_feature =
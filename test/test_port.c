@@ -8,6 +8,7 @@
 #include "lilv/lilv.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
 #include <string.h>
 
@@ -38,6 +39,9 @@ static const char* const plugin_ttl = "\
 		lv2:scalePoint [\n\
 			rdfs:label \"Cos\";\n\
 			rdf:value 4\n\
+		] ;\n\
+		lv2:scalePoint [\n\
+			rdfs:label \"Tan\"\n\
 		]\n\
 	] , [\n\
 		a lv2:EventPort ;\n\
@@ -53,6 +57,7 @@ static const char* const plugin_ttl = "\
 		lv2:index 2 ;\n\
 		lv2:symbol \"audio_in\" ;\n\
 		lv2:name \"Audio Input\" ;\n\
+		lv2:designation <http://example.org/left> ;\n\
 	] , [\n\
 		a lv2:AudioPort ;\n\
 		a lv2:OutputPort ;\n\
@@ -249,7 +254,14 @@ main(void)
   assert(!strcmp(lilv_node_as_string(lilv_nodes_get_first(names)), "store"));
   lilv_nodes_free(names);
 
-  LilvNode* true_val  = lilv_new_bool(world, true);
+  // Single values are translated like lists
+  set_env("LANG", "es_ES");
+  LilvNode* const translated = lilv_port_get(plug, p, name_p);
+  assert(!strcmp(lilv_node_as_string(translated), "tienda"));
+  lilv_node_free(translated);
+  set_env("LANG", "C");
+
+  LilvNode* true_val = lilv_new_bool(world, true);
   LilvNode* false_val = lilv_new_bool(world, false);
 
   assert(!lilv_node_equals(true_val, false_val));
@@ -289,6 +301,60 @@ main(void)
   assert(lilv_plugin_get_num_ports_of_class(
            plug, audio_class, out_class, NULL) == 1);
 
+  // Port summaries match the individual accessors
+  const LilvPortInfo* const infos = lilv_plugin_get_port_infos(plug);
+  assert(infos);
+  assert(lilv_plugin_get_port_infos(plug) == infos);
+
+  LilvNode* const audio_in_sym = lilv_new_string(world, "audio_in");
+  assert(lilv_plugin_get_port_by_symbol(plug, audio_in_sym) == ap_in);
+  lilv_node_free(audio_in_sym);
+
+  assert(infos[0].port == p);
+  assert(infos[0].index == 0U);
+  assert(!strcmp(infos[0].symbol, "foo"));
+  assert(infos[0].flags ==
+         (LILV_PORT_INPUT | LILV_PORT_CONTROL | LILV_PORT_INTEGER));
+  assert(!infos[0].designation);
+  assert(infos[0].min == -1.0f);
+  assert(infos[0].max == 1.0f);
+  assert(infos[0].def == 0.5f);
+
+  assert(infos[2].port == ap_in);
+  assert(infos[2].flags == (LILV_PORT_INPUT | LILV_PORT_AUDIO));
+  assert(!strcmp(lilv_node_as_uri(infos[2].designation),
+                 "http://example.org/left"));
+  assert(isnan(infos[2].min));
+  assert(isnan(infos[2].max));
+  assert(isnan(infos[2].def));
+
+  assert(infos[3].port == ap_out);
+  assert(infos[3].flags == (LILV_PORT_OUTPUT | LILV_PORT_AUDIO));
+
+  // Plain port ranges match the individual accessors
+  LilvPortRange ranges[4];
+  assert(lilv_plugin_get_port_ranges(plug, ranges, NULL, 0U) == 2U);
+  assert(ranges[0].min == -1.0f);
+  assert(ranges[0].max == 1.0f);
+  assert(ranges[0].def == 0.5f);
+  assert(ranges[0].flags == infos[0].flags);
+  assert(ranges[0].scale_points == 0U);
+  assert(ranges[0].n_scale_points == 2U);
+  assert(ranges[0].n_scale_points == lilv_scale_points_size(points));
+  assert(isnan(ranges[2].min));
+  assert(ranges[2].scale_points == 2U);
+  assert(ranges[2].n_scale_points == 0U);
+
+  LilvPortScalePoint plain_points[2];
+  assert(lilv_plugin_get_port_ranges(plug, ranges, plain_points, 1U) == 2U);
+  assert(lilv_plugin_get_port_ranges(plug, ranges, plain_points, 2U) == 2U);
+  for (unsigned i = 0U; i < 2U; ++i) {
+    const LilvPortScalePoint* const sp = &plain_points[i];
+    assert((sp->value == 3.0f && !strcmp(sp->label, "Sin")) ||
+           (sp->value == 4.0f && !strcmp(sp->label, "Cos")));
+  }
+  assert(plain_points[0].value != plain_points[1].value);
+
   lilv_nodes_free(names);
   lilv_node_free(name_p);
 
@@ -0,0 +1,369 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NS_DOAP "http://usefulinc.com/ns/doap#"
+#define NS_LV2 "http://lv2plug.in/ns/lv2core#"
+#define NS_RDF "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
+
+static const char* const plugin_ttl = "\
+:plug\n\
+	a lv2:Plugin ;\n\
+	doap:name \"Test plugin\" ;\n\
+	lv2:port [\n\
+		a lv2:ControlPort , lv2:InputPort ;\n\
+		lv2:index 0 ;\n\
+		lv2:symbol \"foo\" ;\n\
+		lv2:name \"Foo\"\n\
+	] , [\n\
+		a lv2:ControlPort , lv2:InputPort ;\n\
+		lv2:index 1 ;\n\
+		lv2:symbol \"bar\" ;\n\
+		lv2:name \"Bar\"\n\
+	] , [\n\
+		a lv2:ControlPort , lv2:OutputPort ;\n\
+		lv2:index 2 ;\n\
+		lv2:symbol \"latency\" ;\n\
+		lv2:name \"Latency\" , \"Latenz\"@de ;\n\
+		lv2:designation lv2:latency\n\
+	] .\n";
+
+// Values of one column of query rows, each followed by a space
+typedef struct {
+  uint32_t column;
+  unsigned n_rows;
+  char     symbols[64];
+} Results;
+
+static void
+append_result(Results* const results, const LilvNode* const value)
+{
+  const size_t len  = strlen(results->symbols);
+  const size_t size = sizeof(results->symbols) - len;
+
+  const int n = snprintf(
+    results->symbols + len, size, "%s ", lilv_node_as_string(value));
+
+  assert(n > 0 && (size_t)n < size);
+  ++results->n_rows;
+}
+
+static int
+append_column(void* handle, const LilvNode* const* row)
+{
+  Results* const results = (Results*)handle;
+
+  for (uint32_t i = 0U; i <= results->column; ++i) {
+    assert(row[i]);
+  }
+
+  append_result(results, row[results->column]);
+  return 0;
+}
+
+static int
+stop_after_first(void* handle, const LilvNode* const* row)
+{
+  (void)row;
+
+  ++((Results*)handle)->n_rows;
+  return 1;
+}
+
+static int
+append_object(void*           data,
+              const LilvNode* subject,
+              const LilvNode* predicate,
+              const LilvNode* object)
+{
+  assert(subject);
+  assert(lilv_node_is_uri(predicate));
+  append_result((Results*)data, object);
+  return 0;
+}
+
+static int
+keep_first(void*           data,
+           const LilvNode* subject,
+           const LilvNode* predicate,
+           const LilvNode* object)
+{
+  (void)subject;
+  (void)predicate;
+
+  *(LilvNode**)data = lilv_node_duplicate(object);
+  return 1;
+}
+
+static int
+equals_duplicate(void*           data,
+                 const LilvNode* subject,
+                 const LilvNode* predicate,
+                 const LilvNode* object)
+{
+  (void)data;
+  (void)subject;
+  (void)predicate;
+
+  LilvNode* const copy = lilv_node_duplicate(object);
+  assert(lilv_node_equals(object, copy));
+  lilv_node_free(copy);
+  return 0;
+}
+
+static LilvQueryTerm
+node_term(const LilvNode* const value)
+{
+  const LilvQueryTerm term = {value, 0U};
+  return term;
+}
+
+static LilvQueryTerm
+var_term(const uint32_t index)
+{
+  const LilvQueryTerm term = {NULL, index};
+  return term;
+}
+
+int
+main(void)
+{
+  LilvTestEnv* const env   = lilv_test_env_new();
+  LilvWorld* const   world = env->world;
+
+  if (start_bundle(env, "query.lv2", SIMPLE_MANIFEST_TTL, plugin_ttl)) {
+    return 1;
+  }
+
+  assert(lilv_world_load_resource(world, env->plugin1_uri) == 1);
+
+  LilvNode* const rdf_type    = lilv_new_uri(world, NS_RDF "type");
+  LilvNode* const port        = lilv_new_uri(world, NS_LV2 "port");
+  LilvNode* const symbol      = lilv_new_uri(world, NS_LV2 "symbol");
+  LilvNode* const lv2_index   = lilv_new_uri(world, NS_LV2 "index");
+  LilvNode* const designation = lilv_new_uri(world, NS_LV2 "designation");
+  LilvNode* const latency     = lilv_new_uri(world, NS_LV2 "latency");
+  LilvNode* const input       = lilv_new_uri(world, NS_LV2 "InputPort");
+  LilvNode* const bar         = lilv_new_string(world, "bar");
+
+  // An empty query has no results
+  LilvQuery* query = lilv_query_new(world);
+  assert(!lilv_query_get_n_variables(query));
+  assert(!lilv_query_run(query, stop_after_first, NULL));
+  lilv_query_free(query);
+
+  // Symbols of every input port of every plugin
+  Results results = {2U, 0U, {0}};
+  query           = lilv_query_new(world);
+  assert(!lilv_query_add_pattern(
+    query, var_term(1), node_term(symbol), var_term(2)));
+  assert(!lilv_query_add_pattern(
+    query, var_term(0), node_term(port), var_term(1)));
+  assert(!lilv_query_add_pattern(
+    query, var_term(1), node_term(rdf_type), node_term(input)));
+  assert(lilv_query_get_n_variables(query) == 3U);
+  assert(lilv_query_run(query, append_column, &results) == 2U);
+  assert(results.n_rows == 2U);
+  assert(!strcmp(results.symbols, "foo bar ") ||
+         !strcmp(results.symbols, "bar foo "));
+
+  // Stopping early
+  results.n_rows = 0U;
+  assert(lilv_query_run(query, stop_after_first, &results) == 1U);
+  assert(results.n_rows == 1U);
+  lilv_query_free(query);
+
+  // Symbols of every latency port of every plugin
+  memset(&results, 0, sizeof(results));
+  results.column = 2U;
+  query = lilv_query_new(world);
+  assert(!lilv_query_add_pattern(
+    query, var_term(0), node_term(port), var_term(1)));
+  assert(!lilv_query_add_pattern(
+    query, var_term(1), node_term(symbol), var_term(2)));
+  assert(!lilv_query_add_pattern(
+    query, var_term(1), node_term(designation), node_term(latency)));
+  assert(lilv_query_run(query, append_column, &results) == 1U);
+  assert(!strcmp(results.symbols, "latency "));
+  lilv_query_free(query);
+
+  // A query with no matches
+  query = lilv_query_new(world);
+  assert(!lilv_query_add_pattern(
+    query, var_term(0), node_term(symbol), node_term(bar)));
+  assert(!lilv_query_add_pattern(
+    query, var_term(0), node_term(lv2_index), node_term(bar)));
+  assert(!lilv_query_run(query, stop_after_first, &results));
+  lilv_query_free(query);
+
+  // A variable used twice in one pattern must have the same value
+  query = lilv_query_new(world);
+  assert(!lilv_query_add_pattern(
+    query, var_term(0), node_term(port), var_term(0)));
+  assert(!lilv_query_run(query, stop_after_first, &results));
+  lilv_query_free(query);
+
+  // Predicates must be URIs
+  query = lilv_query_new(world);
+  assert(lilv_query_add_pattern(
+    query, var_term(0), node_term(bar), var_term(1)));
+  assert(!lilv_query_get_n_variables(query));
+  lilv_query_free(query);
+
+  // Variable indices must be small
+  query = lilv_query_new(world);
+  assert(lilv_query_add_pattern(
+    query, var_term(0), node_term(port), var_term(UINT32_MAX)));
+  assert(lilv_query_add_pattern(
+    query, var_term(LILV_MAX_QUERY_VARIABLES), node_term(port), var_term(0)));
+  assert(!lilv_query_get_n_variables(query));
+  assert(!lilv_query_add_pattern(query,
+                                 var_term(LILV_MAX_QUERY_VARIABLES - 1U),
+                                 node_term(port),
+                                 var_term(0)));
+  assert(lilv_query_get_n_variables(query) == LILV_MAX_QUERY_VARIABLES);
+  lilv_query_free(query);
+
+  // Prepared query for the symbol of every port
+  LilvPreparedQuery* const symbol_query =
+    lilv_prepared_query_new(world, symbol, NULL);
+  LilvPreparedQuery* const input_query =
+    lilv_prepared_query_new(world, rdf_type, input);
+  assert(symbol_query);
+  assert(input_query);
+
+  LilvNodes* const ports =
+    lilv_world_find_nodes(world, env->plugin1_uri, port, NULL);
+  assert(lilv_nodes_size(ports) == 3U);
+
+  unsigned n_inputs = 0U;
+  LILV_FOREACH (nodes, i, ports) {
+    const LilvNode* const p         = lilv_nodes_get(ports, i);
+    const LilvNode*       values[2] = {NULL, NULL};
+
+    assert(lilv_prepared_query_run(symbol_query, p, values, 2U) == 1U);
+    assert(lilv_node_is_string(values[0]));
+    assert(!values[1]);
+
+    // Running again returns the same value without making a new one
+    const LilvNode* const first = values[0];
+    assert(lilv_prepared_query_run(symbol_query, p, values, 2U) == 1U);
+    assert(values[0] == first);
+
+    // Borrowed values can be kept by duplicating them
+    LilvNode* const kept = lilv_node_duplicate(values[0]);
+    assert(lilv_node_equals(kept, values[0]));
+    lilv_node_free(kept);
+
+    n_inputs += lilv_prepared_query_run(input_query, p, values, 2U);
+  }
+  assert(n_inputs == 2U);
+  lilv_nodes_free(ports);
+
+  // Only the given number of values are written
+  LilvNode* const    name       = lilv_new_uri(world, NS_DOAP "name");
+  LilvPreparedQuery* name_query = lilv_prepared_query_new(world, name, NULL);
+  const LilvNode*    value      = NULL;
+  assert(lilv_prepared_query_run(name_query, env->plugin1_uri, &value, 0U) ==
+         1U);
+  assert(!value);
+  assert(lilv_prepared_query_run(name_query, env->plugin1_uri, &value, 1U) ==
+         1U);
+  assert(!strcmp(lilv_node_as_string(value), "Test plugin"));
+
+  // Values stay valid when an equal node is freed
+  LilvNode* const equal = lilv_new_string(world, "Test plugin");
+  assert(lilv_prepared_query_run(name_query, env->plugin1_uri, &value, 1U) ==
+         1U);
+  lilv_node_free(equal);
+  assert(!strcmp(lilv_node_as_string(value), "Test plugin"));
+  assert(lilv_node_is_string(value));
+  lilv_prepared_query_free(name_query);
+  lilv_node_free(name);
+
+  // Predicates must be URIs
+  assert(!lilv_prepared_query_new(world, bar, NULL));
+
+  // A subject is required
+  assert(!lilv_prepared_query_run(input_query, NULL, NULL, 0U));
+
+  lilv_prepared_query_free(input_query);
+  lilv_prepared_query_free(symbol_query);
+
+  // Streaming every port symbol
+  memset(&results, 0, sizeof(results));
+  assert(lilv_world_foreach_match(
+           world, NULL, symbol, NULL, append_object, &results) == 3U);
+  assert(strstr(results.symbols, "foo "));
+  assert(strstr(results.symbols, "bar "));
+  assert(strstr(results.symbols, "latency "));
+
+  // Stopping early and keeping a borrowed value
+  LilvNode* first = NULL;
+  assert(lilv_world_foreach_match(
+           world, NULL, symbol, NULL, keep_first, &first) == 1U);
+  assert(lilv_node_is_string(first));
+  lilv_node_free(first);
+
+  // Streaming plugin and port values, filtered by language
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  plugin =
+    lilv_plugins_get_by_uri(plugins, env->plugin1_uri);
+  assert(plugin);
+
+  LilvNode* const lv2_name  = lilv_new_uri(world, NS_LV2 "name");
+  LilvNode* const doap_name = lilv_new_uri(world, NS_DOAP "name");
+
+  memset(&results, 0, sizeof(results));
+  assert(lilv_plugin_foreach_value(
+           plugin, doap_name, append_object, &results) == 1U);
+  assert(!strcmp(results.symbols, "Test plugin "));
+
+  const LilvPort* const latency_port =
+    lilv_plugin_get_port_by_index(plugin, 2U);
+  assert(latency_port);
+
+  set_env("LANG", "C");
+  memset(&results, 0, sizeof(results));
+  assert(lilv_port_foreach_value(
+           plugin, latency_port, lv2_name, append_object, &results) == 1U);
+  assert(!strcmp(results.symbols, "Latency "));
+
+  set_env("LANG", "de_DE");
+  memset(&results, 0, sizeof(results));
+  assert(lilv_port_foreach_value(
+           plugin, latency_port, lv2_name, append_object, &results) == 1U);
+  assert(!strcmp(results.symbols, "Latenz "));
+
+  // A borrowed translated string equals its duplicate, which is a plain string
+  assert(lilv_port_foreach_value(
+           plugin, latency_port, lv2_name, equals_duplicate, NULL) == 1U);
+
+  lilv_node_free(doap_name);
+  lilv_node_free(lv2_name);
+
+  lilv_node_free(bar);
+  lilv_node_free(input);
+  lilv_node_free(latency);
+  lilv_node_free(designation);
+  lilv_node_free(lv2_index);
+  lilv_node_free(symbol);
+  lilv_node_free(port);
+  lilv_node_free(rdf_type);
+
+  delete_bundle(env);
+  lilv_test_env_free(env);
+
+  return 0;
+}
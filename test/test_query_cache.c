@@ -0,0 +1,130 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define NS_DOAP "http://usefulinc.com/ns/doap#"
+
+static const char* const plugin_ttl = "\
+:plug\n\
+	a lv2:Plugin ;\n\
+	doap:name \"Test plugin\" , \"Testeinstecker\"@de .\n";
+
+static void
+check_stats(const LilvWorld* world, const uint64_t hits, const uint64_t misses)
+{
+  uint64_t n_hits   = 0U;
+  uint64_t n_misses = 0U;
+  lilv_world_get_query_cache_stats(world, &n_hits, &n_misses);
+  assert(n_hits == hits);
+  assert(n_misses == misses);
+}
+
+int
+main(void)
+{
+  LilvTestEnv* const env   = lilv_test_env_new();
+  LilvWorld* const   world = env->world;
+
+  if (create_bundle(env, "query_cache.lv2", SIMPLE_MANIFEST_TTL, plugin_ttl)) {
+    return 1;
+  }
+
+  set_env("LANG", "C");
+  lilv_world_load_specifications(world);
+  lilv_world_load_bundle(world, env->test_bundle_uri);
+
+  LilvNode* const plug_uri = env->plugin1_uri;
+  LilvNode* const name     = lilv_new_uri(world, NS_DOAP "name");
+  LilvNode* const enabled  = lilv_new_bool(world, true);
+
+  // Queries aren't cached by default
+  assert(lilv_world_ask(world, plug_uri, NULL, NULL));
+  check_stats(world, 0U, 0U);
+
+  lilv_world_set_option(world, LILV_OPTION_QUERY_CACHE, enabled);
+
+  // The plugin data isn't loaded yet, so it has no name
+  assert(!lilv_world_ask(world, plug_uri, name, NULL));
+  check_stats(world, 0U, 1U);
+  assert(!lilv_world_ask(world, plug_uri, name, NULL));
+  check_stats(world, 1U, 1U);
+
+  // Loading the plugin data invalidates the cache
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const plug = lilv_plugins_get_by_uri(plugins, plug_uri);
+  assert(plug);
+
+  LilvNode* const plug_name = lilv_plugin_get_name(plug);
+  assert(plug_name);
+  lilv_node_free(plug_name);
+
+  assert(lilv_world_ask(world, plug_uri, name, NULL));
+  check_stats(world, 1U, 2U);
+
+  // Repeated queries return equal and independent results
+  LilvNodes* const names1 = lilv_world_find_nodes(world, plug_uri, name, NULL);
+  LilvNodes* const names2 = lilv_world_find_nodes(world, plug_uri, name, NULL);
+  check_stats(world, 2U, 3U);
+  assert(names1 != names2);
+  assert(lilv_nodes_size(names1) == 1U);
+  assert(lilv_nodes_size(names2) == 1U);
+  assert(lilv_nodes_contains(
+    names1, lilv_nodes_get(names2, lilv_nodes_begin(names2))));
+  lilv_nodes_free(names1);
+  lilv_nodes_free(names2);
+
+  LilvNode* const name1 = lilv_world_get(world, plug_uri, name, NULL);
+  LilvNode* const name2 = lilv_world_get(world, plug_uri, name, NULL);
+  check_stats(world, 3U, 4U);
+  assert(name1 != name2);
+  assert(!strcmp(lilv_node_as_string(name1), "Test plugin"));
+  assert(lilv_node_equals(name1, name2));
+  lilv_node_free(name1);
+  lilv_node_free(name2);
+
+  // Changing the language invalidates the cache
+  set_env("LANG", "de_DE");
+  LilvNode* const name3 = lilv_world_get(world, plug_uri, name, NULL);
+  check_stats(world, 3U, 5U);
+  assert(!strcmp(lilv_node_as_string(name3), "Testeinstecker"));
+  lilv_node_free(name3);
+
+  // Disabling the cache leaves the statistics as they are
+  LilvNode* const disabled = lilv_new_bool(world, false);
+  lilv_world_set_option(world, LILV_OPTION_QUERY_CACHE, disabled);
+  assert(lilv_world_ask(world, plug_uri, name, NULL));
+  check_stats(world, 3U, 5U);
+  lilv_node_free(disabled);
+
+  // A full cache is emptied before another result is added
+  LilvNode* const max_queries  = lilv_new_int(world, 2);
+  LilvNode* const doap_license = lilv_new_uri(world, NS_DOAP "license");
+  lilv_world_set_option(world, LILV_OPTION_QUERY_CACHE, max_queries);
+  lilv_world_ask(world, plug_uri, name, NULL);
+  lilv_world_ask(world, plug_uri, doap_license, NULL);
+  lilv_world_ask(world, plug_uri, name, NULL);
+  check_stats(world, 4U, 7U);
+  lilv_world_ask(world, plug_uri, NULL, NULL);
+  lilv_world_ask(world, plug_uri, name, NULL);
+  check_stats(world, 4U, 9U);
+  lilv_node_free(doap_license);
+  lilv_node_free(max_queries);
+
+  lilv_node_free(enabled);
+  lilv_node_free(name);
+
+  delete_bundle(env);
+  lilv_test_env_free(env);
+
+  return 0;
+}
@@ -5,7 +5,10 @@
 
 #include "lilv_test_utils.h"
 
+#include "../src/lilv_internal.h"
+
 #include "lilv/lilv.h"
+#include "serd/serd.h"
 
 #include <assert.h>
 #include <string.h>
@@ -73,6 +76,31 @@ main(void)
   // Load new bundle again (noop)
   lilv_world_load_bundle(world, env->test_bundle_uri);
 
+  // Unload and load the bundle again, which must reload its data files
+  lilv_world_unload_bundle(world, env->test_bundle_uri);
+  assert(lilv_plugins_size(plugins) == 0);
+  lilv_world_load_bundle(world, env->test_bundle_uri);
+  assert(lilv_plugins_get_by_uri(plugins, env->plugin1_uri) == plug);
+
+  LilvNode* name3 = lilv_plugin_get_name(plug);
+  assert(name3);
+  assert(!strcmp(lilv_node_as_string(name3), "Second name"));
+  lilv_node_free(name3);
+
+  // Load a file in the bundle while the bundle itself is not loaded
+  lilv_world_unload_bundle(world, env->test_bundle_uri);
+  LilvNode* const content_uri =
+    lilv_new_file_uri(world, NULL, env->test_content_path);
+  assert(!lilv_world_load_graph(world, content_uri->node, content_uri));
+  assert(lilv_world_load_graph(world, content_uri->node, content_uri) ==
+         SERD_FAILURE);
+
+  // Loading and unloading the bundle unloads the file as well
+  lilv_world_load_bundle(world, env->test_bundle_uri);
+  lilv_world_unload_bundle(world, env->test_bundle_uri);
+  assert(!lilv_world_load_graph(world, content_uri->node, content_uri));
+  lilv_node_free(content_uri);
+
   delete_bundle(env);
   lilv_test_env_free(env);
 
@@ -0,0 +1,90 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/allocator.h"
+#include "zix/filesystem.h"
+#include "zix/path.h"
+
+#include <assert.h>
+
+#define NS_EX "http://example.org/"
+
+static const char* const new_manifest =
+  MANIFEST_PREFIXES
+  "@prefix dcterms: <http://purl.org/dc/terms/> .\n"
+  ":new a lv2:Plugin ;\n"
+  "  lv2:binary <new" SHLIB_EXT "> ;\n"
+  "  dcterms:replaces :old , :gone .\n"
+  ":unknown dcterms:replaces :other .\n";
+
+static const char* const old_manifest =
+  MANIFEST_PREFIXES ":old a lv2:Plugin ;\n"
+                    "  lv2:binary <old" SHLIB_EXT "> .\n";
+
+int
+main(void)
+{
+  char* const temp_dir = lilv_create_temporary_directory("lilv_XXXXXX");
+  char* const lv2_dir  = zix_path_join(NULL, temp_dir, "lv2");
+
+  write_bundle_file(lv2_dir, "new.lv2", "manifest.ttl", new_manifest);
+  write_bundle_file(lv2_dir, "old.lv2", "manifest.ttl", old_manifest);
+
+  LilvWorld* const world    = lilv_world_new();
+  LilvNode* const  lv2_path = lilv_new_string(world, lv2_dir);
+  lilv_world_set_option(world, LILV_OPTION_LV2_PATH, lv2_path);
+  lilv_node_free(lv2_path);
+  lilv_world_load_all(world);
+
+  LilvNode* const new_uri     = lilv_new_uri(world, NS_EX "new");
+  LilvNode* const old_uri     = lilv_new_uri(world, NS_EX "old");
+  LilvNode* const gone_uri    = lilv_new_uri(world, NS_EX "gone");
+  LilvNode* const unknown_uri = lilv_new_uri(world, NS_EX "unknown");
+  LilvNode* const other_uri   = lilv_new_uri(world, NS_EX "other");
+
+  const LilvPlugins* const plugins  = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  new_plug = lilv_plugins_get_by_uri(plugins, new_uri);
+  const LilvPlugin* const  old_plug = lilv_plugins_get_by_uri(plugins, old_uri);
+  assert(new_plug);
+  assert(old_plug);
+
+  // The old plugin is replaced by the new one
+  assert(lilv_plugin_is_replaced(old_plug));
+  assert(!lilv_plugin_is_replaced(new_plug));
+  assert(lilv_node_equals(lilv_world_get_replacement(world, old_uri), new_uri));
+  assert(!lilv_world_get_replacement(world, new_uri));
+
+  // Replacements are known even for plugins that aren't installed
+  assert(
+    lilv_node_equals(lilv_world_get_replacement(world, gone_uri), new_uri));
+
+  // Replacements by things that aren't known plugins are ignored
+  assert(!lilv_world_get_replacement(world, other_uri));
+  assert(!lilv_world_get_replacement(world, unknown_uri));
+
+  // Removing the new plugin removes its replacements
+  remove_bundle_dir(lv2_dir, "new.lv2");
+  assert(lilv_world_rescan(world, NULL, NULL, NULL) == 1);
+  assert(!lilv_plugin_is_replaced(old_plug));
+  assert(!lilv_world_get_replacement(world, old_uri));
+  assert(!lilv_world_get_replacement(world, gone_uri));
+
+  lilv_node_free(other_uri);
+  lilv_node_free(unknown_uri);
+  lilv_node_free(gone_uri);
+  lilv_node_free(old_uri);
+  lilv_node_free(new_uri);
+  lilv_world_free(world);
+
+  remove_bundle_dir(lv2_dir, "old.lv2");
+  assert(!zix_remove(lv2_dir));
+  assert(!zix_remove(temp_dir));
+  zix_free(NULL, lv2_dir);
+  zix_free(NULL, temp_dir);
+  return 0;
+}
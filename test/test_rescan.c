@@ -0,0 +1,187 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/allocator.h"
+#include "zix/filesystem.h"
+#include "zix/path.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NS_EX "http://example.org/"
+
+static void
+write_plugin(const char* lv2_dir,
+             const char* bundle_name,
+             const char* plug_name,
+             const char* doap_name,
+             const int   minor_version)
+{
+  char text[1024];
+
+  snprintf(text,
+           sizeof(text),
+           "%s<" NS_EX "%s> a lv2:Plugin ;\n"
+           "  lv2:binary <plug" SHLIB_EXT "> ;\n"
+           "  rdfs:seeAlso <plug.ttl> .\n",
+           MANIFEST_PREFIXES,
+           plug_name);
+  write_bundle_file(lv2_dir, bundle_name, "manifest.ttl", text);
+
+  snprintf(text,
+           sizeof(text),
+           "%s<" NS_EX "%s> a lv2:Plugin ;\n"
+           "  doap:name \"%s\" ;\n"
+           "  lv2:minorVersion %d ;\n"
+           "  lv2:microVersion 0 .\n",
+           PLUGIN_PREFIXES,
+           plug_name,
+           doap_name,
+           minor_version);
+  write_bundle_file(lv2_dir, bundle_name, "plug.ttl", text);
+}
+
+static const LilvPlugin*
+get_plugin(LilvWorld* world, const char* plug_name)
+{
+  char uri_str[128];
+  snprintf(uri_str, sizeof(uri_str), NS_EX "%s", plug_name);
+
+  LilvNode* const          uri     = lilv_new_uri(world, uri_str);
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  plugin  = lilv_plugins_get_by_uri(plugins, uri);
+
+  lilv_node_free(uri);
+  return plugin;
+}
+
+static bool
+is_bundle(const LilvNode* uri_node, const char* bundle_name)
+{
+  const char* const uri = lilv_node_as_uri(uri_node);
+  const size_t      len = strlen(uri);
+  const size_t      n   = strlen(bundle_name);
+
+  // Bundle URIs end with the directory name and a trailing slash
+  return len > n + 1 && !strncmp(uri + len - n - 1, bundle_name, n);
+}
+
+static bool
+has_bundle(const LilvNodes* bundles, const char* bundle_name)
+{
+  LILV_FOREACH (nodes, i, bundles) {
+    if (is_bundle(lilv_nodes_get(bundles, i), bundle_name)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void
+check_name(const LilvPlugin* plugin, const char* expected)
+{
+  LilvNode* const name = lilv_plugin_get_name(plugin);
+  assert(name);
+  assert(!strcmp(lilv_node_as_string(name), expected));
+  lilv_node_free(name);
+}
+
+int
+main(void)
+{
+  char* const temp_dir = lilv_create_temporary_directory("lilv_XXXXXX");
+  char* const lv2_dir  = zix_path_join(NULL, temp_dir, "lv2");
+
+  assert(!zix_create_directories(NULL, lv2_dir));
+  write_plugin(lv2_dir, "a.lv2", "a", "Plugin A", 0);
+  write_plugin(lv2_dir, "b.lv2", "b", "Plugin B", 0);
+  write_plugin(lv2_dir, "old.lv2", "versioned", "Old", 2);
+
+  LilvWorld* const world    = lilv_world_new();
+  LilvNode* const  lv2_path = lilv_new_string(world, lv2_dir);
+  lilv_world_set_option(world, LILV_OPTION_LV2_PATH, lv2_path);
+  lilv_node_free(lv2_path);
+  lilv_world_load_all(world);
+
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  assert(lilv_plugins_size(plugins) == 3);
+
+  const LilvPlugin* const plug_b = get_plugin(world, "b");
+  assert(plug_b);
+  check_name(plug_b, "Plugin B");
+
+  LilvNodes* added   = NULL;
+  LilvNodes* removed = NULL;
+  LilvNodes* changed = NULL;
+
+  // Nothing has changed
+  assert(!lilv_world_rescan(world, &added, &removed, &changed));
+  assert(!added && !removed && !changed);
+
+  // Add a bundle
+  write_plugin(lv2_dir, "c.lv2", "c", "Plugin C", 0);
+  assert(lilv_world_rescan(world, &added, &removed, &changed) == 1);
+  assert(lilv_nodes_size(added) == 1 && has_bundle(added, "c.lv2"));
+  assert(!removed && !changed);
+  assert(lilv_plugins_size(plugins) == 4);
+  assert(get_plugin(world, "c"));
+  assert(get_plugin(world, "b") == plug_b);
+  lilv_nodes_free(added);
+
+  // Modify a data file, which reloads only that bundle
+  write_plugin(lv2_dir, "b.lv2", "b", "Renamed Plugin B", 0);
+  assert(lilv_world_rescan(world, &added, &removed, &changed) == 1);
+  assert(!added && !removed);
+  assert(lilv_nodes_size(changed) == 1 && has_bundle(changed, "b.lv2"));
+  assert(get_plugin(world, "b") == plug_b);
+  check_name(plug_b, "Renamed Plugin B");
+  lilv_nodes_free(changed);
+
+  // Remove a bundle
+  remove_bundle_dir(lv2_dir, "a.lv2");
+  assert(lilv_world_rescan(world, &added, &removed, &changed) == 1);
+  assert(!added && !changed);
+  assert(lilv_nodes_size(removed) == 1 && has_bundle(removed, "a.lv2"));
+  assert(lilv_plugins_size(plugins) == 3);
+  assert(!get_plugin(world, "a"));
+  lilv_nodes_free(removed);
+
+  // Add a newer version of a plugin, which replaces the old one
+  write_plugin(lv2_dir, "new.lv2", "versioned", "New", 4);
+  assert(lilv_world_rescan(world, NULL, NULL, NULL) == 1);
+  assert(lilv_plugins_size(plugins) == 3);
+  assert(is_bundle(
+    lilv_plugin_get_bundle_uri(get_plugin(world, "versioned")), "new.lv2"));
+  check_name(get_plugin(world, "versioned"), "New");
+
+  // Remove the newer version, so the old one is loaded again
+  remove_bundle_dir(lv2_dir, "new.lv2");
+  assert(lilv_world_rescan(world, &added, &removed, &changed) == 2);
+  assert(!added);
+  assert(lilv_nodes_size(removed) == 1 && has_bundle(removed, "new.lv2"));
+  assert(lilv_nodes_size(changed) == 1 && has_bundle(changed, "old.lv2"));
+  assert(is_bundle(
+    lilv_plugin_get_bundle_uri(get_plugin(world, "versioned")), "old.lv2"));
+  check_name(get_plugin(world, "versioned"), "Old");
+  lilv_nodes_free(changed);
+  lilv_nodes_free(removed);
+
+  lilv_world_free(world);
+
+  remove_bundle_dir(lv2_dir, "b.lv2");
+  remove_bundle_dir(lv2_dir, "c.lv2");
+  remove_bundle_dir(lv2_dir, "old.lv2");
+  assert(!zix_remove(lv2_dir));
+  assert(!zix_remove(temp_dir));
+  zix_free(NULL, lv2_dir);
+  zix_free(NULL, temp_dir);
+  return 0;
+}
@@ -0,0 +1,276 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+// Concurrent queries on lazily loaded, frozen, and frozen compact worlds
+
+#undef NDEBUG
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/sem.h"
+#include "zix/thread.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#define NS_DOAP "http://usefulinc.com/ns/doap#"
+#define NS_LV2 "http://lv2plug.in/ns/lv2core#"
+
+#define N_THREADS 4U
+#define N_ITERATIONS 64U
+
+static const char* const plugin_ttl = "\
+:plug\n\
+	a lv2:Plugin ;\n\
+	doap:name \"Test plugin\" ;\n\
+	lv2:optionalFeature lv2:hardRTCapable ;\n\
+	lv2:port [\n\
+		a lv2:ControlPort , lv2:InputPort ;\n\
+		lv2:index 0 ;\n\
+		lv2:symbol \"gain\" ;\n\
+		lv2:name \"Gain\" ;\n\
+		lv2:minimum 0.0 ;\n\
+		lv2:maximum 2.0 ;\n\
+		lv2:default 1.0\n\
+	] , [\n\
+		a lv2:ControlPort , lv2:OutputPort ;\n\
+		lv2:index 1 ;\n\
+		lv2:symbol \"latency\" ;\n\
+		lv2:name \"Latency\" ;\n\
+		lv2:designation lv2:latency\n\
+	] .\n";
+
+typedef enum {
+  TEST_LAZY,    ///< Plugin data is loaded by the readers on demand
+  TEST_FROZEN,  ///< Frozen world, where calls are serialized by the lock
+  TEST_COMPACT, ///< Frozen compact world, where calls aren't serialized
+} TestMode;
+
+typedef struct {
+  LilvWorld*        world;
+  const LilvPlugin* plugin;
+  const LilvNode*   doap_name;
+  const LilvNode*   rt_capable;
+} Reader;
+
+static ZIX_THREAD_FUNC ZixThreadResult
+read_plugin(void* const data)
+{
+  const Reader* const     reader = (const Reader*)data;
+  const LilvPlugin* const plugin = reader->plugin;
+
+  for (unsigned i = 0U; i < N_ITERATIONS; ++i) {
+    LilvNode* const name = lilv_plugin_get_name(plugin);
+    assert(!strcmp(lilv_node_as_string(name), "Test plugin"));
+    lilv_node_free(name);
+
+    assert(lilv_plugin_get_class(plugin));
+
+    assert(lilv_plugin_get_num_ports(plugin) == 2U);
+    assert(lilv_plugin_get_latency_port_index(plugin) == 1U);
+    assert(lilv_plugin_has_feature(plugin, reader->rt_capable));
+
+    const LilvPort* const gain      = lilv_plugin_get_port_by_index(plugin, 0U);
+    LilvNode* const       gain_name = lilv_port_get_name(plugin, gain);
+    assert(!strcmp(lilv_node_as_string(gain_name), "Gain"));
+    lilv_node_free(gain_name);
+
+    float max[2] = {0.0f, 0.0f};
+    lilv_plugin_get_port_ranges_float(plugin, NULL, max, NULL);
+    assert(max[0] == 2.0f);
+
+    LilvNodes* const names = lilv_world_find_nodes(
+      reader->world, lilv_plugin_get_uri(plugin), reader->doap_name, NULL);
+    assert(lilv_nodes_size(names) == 1U);
+    lilv_nodes_free(names);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static int
+check_name(void* const           data,
+           const LilvNode* const subject,
+           const LilvNode* const predicate,
+           const LilvNode* const object)
+{
+  (void)subject;
+  (void)predicate;
+
+  assert(!strcmp(lilv_node_as_string(object), "Test plugin"));
+  ++*(unsigned*)data;
+  return 0;
+}
+
+static ZIX_THREAD_FUNC ZixThreadResult
+match_name(void* const data)
+{
+  const Reader* const reader = (const Reader*)data;
+
+  for (unsigned i = 0U; i < N_ITERATIONS; ++i) {
+    unsigned n_matches = 0U;
+    lilv_world_foreach_match(reader->world,
+                             lilv_plugin_get_uri(reader->plugin),
+                             reader->doap_name,
+                             NULL,
+                             check_name,
+                             &n_matches);
+    assert(n_matches == 1U);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static ZIX_THREAD_FUNC ZixThreadResult
+churn_name(void* const data)
+{
+  const Reader* const reader = (const Reader*)data;
+
+  // Repeatedly intern and free a node equal to the matched name
+  for (unsigned i = 0U; i < N_ITERATIONS; ++i) {
+    LilvNode* const name = lilv_new_string(reader->world, "Test plugin");
+    assert(name);
+    lilv_node_free(name);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+typedef struct {
+  const Reader* reader;
+  ZixSem        entered; ///< Posted when the match callback is running
+  ZixSem        release; ///< Posted to let the match callback return
+} Blocker;
+
+static int
+block_in_match(void* const           data,
+               const LilvNode* const subject,
+               const LilvNode* const predicate,
+               const LilvNode* const object)
+{
+  (void)subject;
+  (void)predicate;
+  (void)object;
+
+  Blocker* const blocker = (Blocker*)data;
+  zix_sem_post(&blocker->entered);
+  zix_sem_wait(&blocker->release);
+  return 1;
+}
+
+static ZIX_THREAD_FUNC ZixThreadResult
+match_and_block(void* const data)
+{
+  Blocker* const      blocker = (Blocker*)data;
+  const Reader* const reader  = blocker->reader;
+
+  lilv_world_foreach_match(reader->world,
+                           lilv_plugin_get_uri(reader->plugin),
+                           reader->doap_name,
+                           NULL,
+                           block_in_match,
+                           blocker);
+
+  return ZIX_THREAD_RESULT;
+}
+
+/** Check that freezing fails while another thread holds the world lock. */
+static void
+test_busy_freeze(const Reader* const reader)
+{
+  // Load the plugin data so the name matches
+  LilvNode* const name = lilv_plugin_get_name(reader->plugin);
+  assert(name);
+  lilv_node_free(name);
+
+  Blocker blocker = {reader, {0}, {0}};
+  assert(!zix_sem_init(&blocker.entered, 0U));
+  assert(!zix_sem_init(&blocker.release, 0U));
+
+  ZixThread thread;
+  assert(!zix_thread_create(&thread, 0U, match_and_block, &blocker));
+  zix_sem_wait(&blocker.entered);
+  lilv_world_freeze(reader->world);
+  zix_sem_post(&blocker.release);
+  assert(!zix_thread_join(thread));
+
+  // The world is still not frozen, so loading doesn't fail
+  assert(!lilv_world_load_resource(reader->world, reader->doap_name));
+
+  zix_sem_destroy(&blocker.release);
+  zix_sem_destroy(&blocker.entered);
+}
+
+static int
+test_threads(const TestMode mode)
+{
+  LilvTestEnv* const env   = lilv_test_env_new();
+  LilvWorld* const   world = env->world;
+
+  if (start_bundle(env, "threads.lv2", SIMPLE_MANIFEST_TTL, plugin_ttl)) {
+    return 1;
+  }
+
+  const LilvPlugins* const plugins = lilv_world_get_all_plugins(world);
+  const LilvPlugin* const  plugin =
+    lilv_plugins_get_by_uri(plugins, env->plugin1_uri);
+  assert(plugin);
+
+  LilvNode* const doap_name  = lilv_new_uri(world, NS_DOAP "name");
+  LilvNode* const rt_capable = lilv_new_uri(world, NS_LV2 "hardRTCapable");
+  const Reader    reader     = {world, plugin, doap_name, rt_capable};
+
+  if (mode != TEST_LAZY) {
+    LilvNode* const compact = lilv_new_bool(world, mode == TEST_COMPACT);
+    lilv_world_set_option(world, LILV_OPTION_COMPACT, compact);
+    lilv_node_free(compact);
+
+    // A world can't be frozen while another thread is using it
+    test_busy_freeze(&reader);
+
+    // Nothing can be loaded or unloaded once the world is frozen
+    lilv_world_freeze(world);
+    assert(lilv_world_load_resource(world, env->plugin1_uri) == -1);
+    assert(lilv_world_unload_bundle(world, env->test_bundle_uri) == -1);
+    assert(!lilv_world_rescan(world, NULL, NULL, NULL));
+    assert(lilv_plugins_get_by_uri(plugins, env->plugin1_uri) == plugin);
+  }
+
+  // Query the same plugin from several threads at once, which loads its data,
+  // ports, and class concurrently if the world isn't frozen
+  ZixThread threads[N_THREADS];
+  for (unsigned i = 0U; i < N_THREADS; ++i) {
+    assert(!zix_thread_create(&threads[i], 0U, read_plugin, (void*)&reader));
+  }
+
+  for (unsigned i = 0U; i < N_THREADS; ++i) {
+    assert(!zix_thread_join(threads[i]));
+  }
+
+  // Match the name while other threads free the last reference to its node
+  for (unsigned i = 0U; i < N_THREADS; ++i) {
+    assert(!zix_thread_create(
+      &threads[i], 0U, (i % 2U) ? churn_name : match_name, (void*)&reader));
+  }
+
+  for (unsigned i = 0U; i < N_THREADS; ++i) {
+    assert(!zix_thread_join(threads[i]));
+  }
+
+  lilv_node_free(rt_capable);
+  lilv_node_free(doap_name);
+
+  delete_bundle(env);
+  lilv_test_env_free(env);
+
+  return 0;
+}
+
+int
+main(void)
+{
+  return test_threads(TEST_LAZY) || test_threads(TEST_FROZEN) ||
+         test_threads(TEST_COMPACT);
+}
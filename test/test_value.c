@@ -129,6 +129,14 @@ main(void)
   LilvNode* uval_dup = lilv_node_duplicate(uval);
   assert(lilv_node_equals(uval, uval_dup));
 
+  // Equal non-numeric nodes are shared, and stay valid until all are freed
+  assert(uval_e == uval);
+  assert(sval_e == sval);
+  assert(uval_dup == uval);
+  LilvNode* sval_dup = lilv_node_duplicate(sval);
+  lilv_node_free(sval_dup);
+  assert(!strcmp(lilv_node_as_string(sval), "Foo"));
+
   LilvNode* ifval = lilv_new_float(world, 42.0);
   assert(!lilv_node_equals(ival, ifval));
   lilv_node_free(ifval);
@@ -0,0 +1,157 @@
+// Copyright 2007-2023 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "../src/lilv_internal.h"
+
+#include "lilv_test_utils.h"
+
+#include "lilv/lilv.h"
+#include "zix/allocator.h"
+#include "zix/filesystem.h"
+#include "zix/path.h"
+
+#ifdef __linux__
+#  include <poll.h>
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PLUGIN_MANIFEST(name) \
+  MANIFEST_PREFIXES "<http://example.org/" name "> a lv2:Plugin .\n"
+
+#ifdef __linux__
+
+/** Wait for the next event, and check that it is the expected one. */
+static void
+expect_event(LilvWatcher*           watcher,
+             const LilvBundleChange expected_change,
+             const char*            bundle_name)
+{
+  struct pollfd pfd = {lilv_watcher_get_fd(watcher), POLLIN, 0};
+
+  for (unsigned i = 0U; i < 100U && !lilv_watcher_process(watcher); ++i) {
+    const int timeout = lilv_watcher_get_timeout(watcher);
+    poll(&pfd, 1, timeout >= 0 ? timeout : 100);
+  }
+
+  LilvBundleChange change     = LILV_BUNDLE_ADDED;
+  LilvNode*        bundle_uri = NULL;
+  assert(lilv_watcher_next_event(watcher, &change, &bundle_uri));
+  assert(change == expected_change);
+
+  const char* const uri = lilv_node_as_uri(bundle_uri);
+  const size_t      len = strlen(uri);
+  const size_t      n   = strlen(bundle_name);
+  assert(len > n + 1 && !strncmp(uri + len - n - 1, bundle_name, n));
+
+  lilv_node_free(bundle_uri);
+
+  // Notifications for a bundle are merged, so there should be only one event
+  assert(!lilv_watcher_next_event(watcher, &change, &bundle_uri));
+}
+
+#endif
+
+int
+main(void)
+{
+  char* const temp_dir = lilv_create_temporary_directory("lilv_XXXXXX");
+  char* const lv2_dir  = zix_path_join(NULL, temp_dir, "lv2");
+  char* const home_dir = zix_path_join(NULL, temp_dir, "home");
+  char* const late_dir = zix_path_join(NULL, home_dir, "lv2");
+
+  assert(!zix_create_directories(NULL, lv2_dir));
+  write_bundle_file(lv2_dir, "old.lv2", "manifest.ttl", PLUGIN_MANIFEST("old"));
+
+  LilvWorld* const world    = lilv_world_new();
+  char* const      path_str =
+    lilv_strjoin(lv2_dir, LILV_PATH_SEP, late_dir, NULL);
+  LilvNode* const  lv2_path = lilv_new_string(world, path_str);
+  lilv_world_set_option(world, LILV_OPTION_LV2_PATH, lv2_path);
+  lilv_node_free(lv2_path);
+  free(path_str);
+  lilv_world_load_all(world);
+
+  LilvWatcher* const watcher = lilv_watcher_new(world, 10U);
+
+#ifdef __linux__
+  assert(watcher);
+  assert(lilv_watcher_get_fd(watcher) >= 0);
+  assert(lilv_watcher_get_timeout(watcher) == -1);
+  assert(!lilv_watcher_process(watcher));
+
+  // Add a bundle, which takes several writes
+  write_bundle_file(lv2_dir, "new.lv2", "manifest.ttl", PLUGIN_MANIFEST("new"));
+  expect_event(watcher, LILV_BUNDLE_ADDED, "new.lv2");
+
+  // Modify a loaded bundle
+  write_bundle_file(
+    lv2_dir, "old.lv2", "manifest.ttl", PLUGIN_MANIFEST("renamed"));
+  expect_event(watcher, LILV_BUNDLE_CHANGED, "old.lv2");
+
+  // Add a directory within a bundle, and change a file in it
+  char* const sub_dir  = zix_path_join(NULL, lv2_dir, "old.lv2/modgui");
+  char* const sub_path = zix_path_join(NULL, sub_dir, "gui.ttl");
+  assert(!zix_create_directory(sub_dir));
+  expect_event(watcher, LILV_BUNDLE_CHANGED, "old.lv2");
+
+  write_file(sub_dir, "gui.ttl", MANIFEST_PREFIXES);
+  expect_event(watcher, LILV_BUNDLE_CHANGED, "old.lv2");
+
+  assert(!zix_remove(sub_path));
+  assert(!zix_remove(sub_dir));
+  expect_event(watcher, LILV_BUNDLE_CHANGED, "old.lv2");
+  zix_free(NULL, sub_path);
+  zix_free(NULL, sub_dir);
+
+  // Remove a loaded bundle
+  remove_bundle_dir(lv2_dir, "old.lv2");
+  expect_event(watcher, LILV_BUNDLE_REMOVED, "old.lv2");
+
+  // Add and remove a bundle before it settles, which is not reported
+  write_bundle_file(
+    lv2_dir, "temp.lv2", "manifest.ttl", PLUGIN_MANIFEST("temp"));
+  remove_bundle_dir(lv2_dir, "temp.lv2");
+  remove_bundle_dir(lv2_dir, "new.lv2");
+  assert(!lilv_watcher_process(watcher));
+  assert(lilv_watcher_get_timeout(watcher) >= 0);
+  poll(NULL, 0, 50);
+  assert(!lilv_watcher_process(watcher));
+  assert(lilv_watcher_get_timeout(watcher) == -1);
+
+  // Create a missing directory in the LV2 path, along with a bundle in it
+  write_bundle_file(
+    late_dir, "late.lv2", "manifest.ttl", PLUGIN_MANIFEST("late"));
+  expect_event(watcher, LILV_BUNDLE_ADDED, "late.lv2");
+
+  // Add another bundle to it, now that it's watched
+  write_bundle_file(
+    late_dir, "later.lv2", "manifest.ttl", PLUGIN_MANIFEST("later"));
+  expect_event(watcher, LILV_BUNDLE_ADDED, "later.lv2");
+
+  remove_bundle_dir(late_dir, "later.lv2");
+  remove_bundle_dir(late_dir, "late.lv2");
+  assert(!zix_remove(late_dir));
+  assert(!zix_remove(home_dir));
+
+#else
+  assert(!watcher);
+  remove_bundle_dir(lv2_dir, "old.lv2");
+#endif
+
+  lilv_watcher_free(watcher);
+  lilv_world_free(world);
+
+  assert(!zix_remove(lv2_dir));
+  assert(!zix_remove(temp_dir));
+  zix_free(NULL, late_dir);
+  zix_free(NULL, home_dir);
+  zix_free(NULL, lv2_dir);
+  zix_free(NULL, temp_dir);
+  return 0;
+}